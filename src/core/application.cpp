@@ -6,6 +6,7 @@
 #include "resource/font.hpp"
 #include "resource/image_texture.hpp"
 #include "resource/mesh.hpp"
+#include "resource/prefab.hpp"
 
 #include "visual/renderer.hpp"
 #include "visual/visual.hpp"
@@ -30,6 +31,12 @@
 
 static Application *s_app = nullptr;
 
+// Main thread time given to each background scene load per frame, mostly for GL/AL uploads
+static constexpr std::chrono::microseconds SceneLoadBudget{4000};
+
+// Scripts, shaders and scene files loaded again on play mode restarts are served from memory
+static constexpr size_t FileCacheBudget = 64 * 1024 * 1024;
+
 Application &App() {
 	return *s_app;
 }
@@ -39,13 +46,25 @@ Application::Application(int argc, char const *argv[]) {
 }
 
 Application::~Application() {
+	// Scenes hold resource references and are declared before the registry, so they would outlive it
+	_sceneLoads.clear();
+	_currentScene.reset();
+	_backgroundScene.reset();
 }
 
 std::unique_ptr<ImageTexture> texture;
 std::unique_ptr<Mesh> mesh;
 
 void Application::Init() {
-	_fs.RegisterFileServer("res", _fs.NewFolderFileServer("res", "res"));
+	// A packed build ships res.spak instead of the res folder
+	FileServer *resFS = nullptr;
+	if (std::filesystem::exists("res.spak"))
+		resFS = _fs.NewPackFileServer("res", "res.spak");
+	if (!resFS)
+		resFS = _fs.NewFolderFileServer("res", "res");
+	_fs.RegisterFileServer("res", resFS);
+	_fs.SetCacheBudget(FileCacheBudget);
+	_fs.SetThreadPool(&_threadPool);
 	RegisterBuiltinData();
 
 	_projectSettings.Load();
@@ -100,6 +119,7 @@ void Application::Init() {
 	GetResourceRegistry().AddResourceType<SpriteSheetAnimation>("SpriteSheetAnimation");
 	GetResourceRegistry().AddResourceType<Mesh>("Mesh");
 	GetResourceRegistry().AddResourceType<AudioStream>("AudioStream");
+	GetResourceRegistry().AddResourceType<Prefab>("Prefab");
 
 	_backgroundScene = NewScene();
 	_currentScene = NewScene();
@@ -142,6 +162,15 @@ void Application::Update() {
 		_window.SetShouldClose();
 	}
 
+	// Before scene loads and scripts, so both see files that finished loading, folders and assets as they are this frame
+	_fs.DispatchCompletions();
+	_fs.PollDirectoryChanges();
+	_hotReload.Update();
+	updateSceneLoads();
+	// After scene loads, which take over resources still in the release cache
+	_resourceRegistry.Update();
+	_audioServer.Update();
+
 	Visual::UseViewport(&_mainViewport);
 
 	if (IsRunning()) {
@@ -172,7 +201,7 @@ void Application::Update() {
 	if (!IsRunning()) {
 		if (_currentScene)
 			for (Node *node : _currentScene->_nodeIter) {
-				Camera2D *camera = dynamic_cast<Camera2D *>(node);
+				Camera2D *camera = node_cast<Camera2D>(node);
 				if (!camera)
 					continue;
 
@@ -223,6 +252,10 @@ void Application::Start() {
 	Scene::Copy(_currentScene.get(), _backgroundScene.get());
 	_copyGlobalStore = _globalStore;
 
+	// Every run starts the random streams from the same seed, so a run can be replayed
+	Utils::Seed(Utils::GetSeed());
+	Debug::Info("Random seed: {}", Utils::GetSeed());
+
 	_scriptServer.Init();
 	_currentScene->Start();
 	_scriptServer.CallStart();
@@ -261,4 +294,36 @@ void Application::SetCurrentScene(Ref<Scene> scene) {
 		_currentScene->Start();
 	}
 	_onSceneChanged();
+}
+
+Ref<Scene> Application::LoadSceneAsync(const char *path, std::function<void(Ref<Scene>)> onLoaded) {
+	Ref<Scene> scene = NewScene();
+	if (!scene->LoadFromFileAsync(path))
+		return nullptr;
+
+	_sceneLoads.push_back(SceneLoad{scene, onLoaded});
+	return scene;
+}
+
+void Application::updateSceneLoads() {
+	for (size_t i = 0; i < _sceneLoads.size();) {
+		bool loaded = false;
+		if (!_sceneLoads[i].scene->updateLoad(SceneLoadBudget, loaded)) {
+			i++;
+			continue;
+		}
+
+		SceneLoad load = std::move(_sceneLoads[i]);
+		_sceneLoads.erase(_sceneLoads.begin() + i);
+
+		if (!loaded) {
+			Debug::Error("Failed to load scene '{}'", load.scene->GetFilepath().string());
+			continue;
+		}
+
+		if (load.onLoaded)
+			load.onLoaded(load.scene);
+		else
+			SetCurrentScene(load.scene);
+	}
 }
\ No newline at end of file
@@ -15,6 +15,8 @@
 
 #include "filesystem/filesystem.hpp"
 
+#include "core/hot_reload.hpp"
+#include "core/thread_pool.hpp"
 #include "core/timer.hpp"
 #include "data/project_settings.hpp"
 #include "utils/store.hpp"
@@ -44,6 +46,8 @@ class Application {
 	inline bool IsRunning() { return _isRunning; }
 
 	inline FileSystem &FS() { return _fs; }
+	inline ThreadPool &GetThreadPool() { return _threadPool; }
+	inline HotReload &GetHotReload() { return _hotReload; }
 	inline NodeDB &GetNodeDB() { return _nodeDB; }
 	inline ResourceRegistry &GetResourceRegistry() { return _resourceRegistry; }
 	inline Font *GetDefaultFont() { return &_defaultFont; }
@@ -58,6 +62,9 @@ class Application {
 	Ref<Scene> NewScene();
 	Ref<Scene> GetCurrentScene();
 	void SetCurrentScene(Ref<Scene> scene);
+	// Loads path into a new scene in the background and finishes it over the following frames. Once loaded, the scene
+	// is passed to onLoaded, or made current if onLoaded is empty. The returned scene is only for tracking progress
+	Ref<Scene> LoadSceneAsync(const char *path, std::function<void(Ref<Scene>)> onLoaded = nullptr);
 
 	float Delta() { return _delta; }
 	inline StringStore &GetGlobalStore() { return _globalStore; }
@@ -75,16 +82,27 @@ class Application {
   private:
 	eventpp::CallbackList<void()> _onSceneChanged;
 
+	void updateSceneLoads();
+
   private:
 	bool _isRunning = false;
 
 	FileSystem _fs;
+	ThreadPool _threadPool;
+	// Before everything that watches files, so it is destroyed after them
+	HotReload _hotReload;
 
 	ProjectSettings _projectSettings;
 
 	NodeDB _nodeDB;
 	Ref<Scene> _currentScene;
 	Ref<Scene> _backgroundScene;
+
+	struct SceneLoad {
+		Ref<Scene> scene;
+		std::function<void(Ref<Scene>)> onLoaded;
+	};
+	std::vector<SceneLoad> _sceneLoads;
 	ScriptServer _scriptServer;
 	AudioServer _audioServer;
 
@@ -1,12 +1,16 @@
 #include "debug.hpp"
 
+#include <mutex>
 #include <string>
 
 #include "core/application.hpp"
 
 static std::deque<Debug::LogMessage> s_Lines;
+// Worker threads log too, e.g. resource decode jobs
+static std::mutex s_LinesMutex;
 
 void Debug::Internal::PushLine(const std::string &line, LogSeverity severity) {
+	std::lock_guard<std::mutex> lock(s_LinesMutex);
 	if (severity == LogSeverity::Log) {
 		std::cout << "\033[0;32m";
 	} else if (severity == LogSeverity::Info) {
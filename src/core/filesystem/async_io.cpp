@@ -0,0 +1,346 @@
+#include "async_io.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#ifdef SW_LINUX
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#endif
+
+#include "core/thread_pool.hpp"
+#include "filesystem.hpp"
+
+ThreadPoolFileBackend::ThreadPoolFileBackend(FileServer *server, ThreadPool &pool, IOCompletion complete)
+	: _server(server), _pool(pool), _complete(complete), _queue(std::make_shared<Queue>()) {}
+
+void ThreadPoolFileBackend::Submit(Ref<IORequest> request) {
+	{
+		std::lock_guard<std::mutex> lock(_queue->mutex);
+		_queue->pending.push(request);
+	}
+
+	// One job per request, the server outlives the file system and so every job
+	_pool.Submit([server = _server, complete = _complete, queue = _queue]() {
+		Ref<IORequest> next;
+		{
+			std::lock_guard<std::mutex> lock(queue->mutex);
+			next = queue->pending.top();
+			queue->pending.pop();
+		}
+
+		complete(next, next->IsCancelled() ? nullptr : server->Load(next->path));
+	});
+}
+
+#ifdef SW_LINUX
+
+// liburing is not a dependency, the ring is driven through the raw syscalls and its shared memory
+struct IOUringFileBackend::Ring {
+	int fd = -1;
+	u32 entries = 0;
+
+	void *sqMap = MAP_FAILED;
+	size_t sqMapSize = 0;
+	void *cqMap = MAP_FAILED;
+	size_t cqMapSize = 0;
+	io_uring_sqe *sqes = static_cast<io_uring_sqe *>(MAP_FAILED);
+	size_t sqesSize = 0;
+
+	u32 *sqHead = nullptr;
+	u32 *sqTail = nullptr;
+	u32 *sqMask = nullptr;
+	u32 *sqArray = nullptr;
+	u32 *cqHead = nullptr;
+	u32 *cqTail = nullptr;
+	u32 *cqMask = nullptr;
+	io_uring_cqe *cqes = nullptr;
+
+	// Queued but not yet passed to io_uring_enter
+	u32 unsubmitted = 0;
+
+	bool Init(u32 depth) {
+		io_uring_params params{};
+		fd = static_cast<int>(syscall(__NR_io_uring_setup, depth, &params));
+		if (fd < 0)
+			return false;
+
+		entries = params.sq_entries;
+		sqMapSize = params.sq_off.array + params.sq_entries * sizeof(u32);
+		cqMapSize = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+		bool single = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+		if (single)
+			sqMapSize = cqMapSize = std::max(sqMapSize, cqMapSize);
+
+		sqMap = mmap(nullptr, sqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+		if (sqMap == MAP_FAILED)
+			return false;
+		if (single) {
+			cqMap = sqMap;
+		} else {
+			cqMap = mmap(nullptr, cqMapSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+			if (cqMap == MAP_FAILED)
+				return false;
+		}
+
+		sqesSize = params.sq_entries * sizeof(io_uring_sqe);
+		sqes = static_cast<io_uring_sqe *>(mmap(nullptr, sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES));
+		if (sqes == MAP_FAILED)
+			return false;
+
+		std::byte *sq = static_cast<std::byte *>(sqMap);
+		sqHead = reinterpret_cast<u32 *>(sq + params.sq_off.head);
+		sqTail = reinterpret_cast<u32 *>(sq + params.sq_off.tail);
+		sqMask = reinterpret_cast<u32 *>(sq + params.sq_off.ring_mask);
+		sqArray = reinterpret_cast<u32 *>(sq + params.sq_off.array);
+
+		std::byte *cq = static_cast<std::byte *>(cqMap);
+		cqHead = reinterpret_cast<u32 *>(cq + params.cq_off.head);
+		cqTail = reinterpret_cast<u32 *>(cq + params.cq_off.tail);
+		cqMask = reinterpret_cast<u32 *>(cq + params.cq_off.ring_mask);
+		cqes = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+		return true;
+	}
+
+	~Ring() {
+		if (sqes != MAP_FAILED)
+			munmap(sqes, sqesSize);
+		if (cqMap != MAP_FAILED && cqMap != sqMap)
+			munmap(cqMap, cqMapSize);
+		if (sqMap != MAP_FAILED)
+			munmap(sqMap, sqMapSize);
+		if (fd >= 0)
+			close(fd);
+	}
+
+	// Only this thread writes the tail, the kernel advances the head as it consumes entries
+	io_uring_sqe *NextSqe() {
+		u32 tail = *sqTail;
+		if (tail - __atomic_load_n(sqHead, __ATOMIC_ACQUIRE) >= entries)
+			return nullptr;
+
+		u32 index = tail & *sqMask;
+		io_uring_sqe *sqe = &sqes[index];
+		std::memset(sqe, 0, sizeof(*sqe));
+		sqArray[index] = index;
+		__atomic_store_n(sqTail, tail + 1, __ATOMIC_RELEASE);
+		unsubmitted++;
+		return sqe;
+	}
+
+	// Submits queued entries and blocks until at least one completes
+	bool SubmitAndWait() {
+		while (true) {
+			int result = static_cast<int>(syscall(__NR_io_uring_enter, fd, unsubmitted, 1, IORING_ENTER_GETEVENTS, nullptr, 0));
+			if (result >= 0) {
+				unsubmitted -= std::min(unsubmitted, static_cast<u32>(result));
+				return true;
+			}
+			if (errno != EINTR && errno != EAGAIN && errno != EBUSY)
+				return false;
+		}
+	}
+
+	template <typename F>
+	void Reap(F &&handle) {
+		u32 head = *cqHead;
+		u32 tail = __atomic_load_n(cqTail, __ATOMIC_ACQUIRE);
+		for (; head != tail; head++) {
+			const io_uring_cqe &cqe = cqes[head & *cqMask];
+			handle(cqe.user_data, cqe.res);
+		}
+		__atomic_store_n(cqHead, head, __ATOMIC_RELEASE);
+	}
+};
+
+struct IOUringFileBackend::Read {
+	Ref<IORequest> request;
+	Ref<FileData> data;
+	int fd = -1;
+	size_t offset = 0;
+	iovec vec{};
+};
+
+// Marks the poll on the wake eventfd, reads use their Read pointer
+static constexpr u64 WakeTag = 0;
+// Linux transfers at most this much in one read
+static constexpr size_t MaxReadSize = 0x7ffff000;
+
+IOUringFileBackend::IOUringFileBackend(const std::filesystem::path &basePath, IOCompletion complete)
+	: _basePath(basePath), _complete(complete) {}
+
+IOUringFileBackend::~IOUringFileBackend() {
+	if (_thread.joinable()) {
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stop = true;
+		}
+		u64 one = 1;
+		(void)!write(_wakeFd, &one, sizeof(one));
+		_thread.join();
+	}
+
+	if (_wakeFd >= 0)
+		close(_wakeFd);
+}
+
+bool IOUringFileBackend::Start(u32 depth) {
+	// One entry stays reserved for the wake poll
+	_ring = std::make_unique<Ring>();
+	if (!_ring->Init(std::max<u32>(depth, 2))) {
+		_ring = nullptr;
+		return false;
+	}
+
+	_wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+	if (_wakeFd < 0) {
+		_ring = nullptr;
+		return false;
+	}
+
+	_thread = std::thread(&IOUringFileBackend::run, this);
+	return true;
+}
+
+void IOUringFileBackend::Submit(Ref<IORequest> request) {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_pending.push(request);
+	}
+
+	u64 one = 1;
+	(void)!write(_wakeFd, &one, sizeof(one));
+}
+
+void IOUringFileBackend::run() {
+	queueWake();
+
+	while (true) {
+		std::vector<Ref<IORequest>> starting;
+		bool stop = false;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			stop = _stop;
+			while (!stop && _inFlight + starting.size() + 1 < _ring->entries && !_pending.empty()) {
+				starting.push_back(_pending.top());
+				_pending.pop();
+			}
+		}
+
+		// In flight reads write into buffers owned here, so they are drained before the thread exits
+		if (stop && _inFlight == 0)
+			break;
+
+		for (Ref<IORequest> &request : starting)
+			startRead(request);
+
+		if (!_ring->SubmitAndWait())
+			break;
+
+		_ring->Reap([this, stop](u64 tag, i32 result) {
+			if (tag == WakeTag) {
+				u64 count = 0;
+				(void)!read(_wakeFd, &count, sizeof(count));
+				if (!stop)
+					queueWake();
+				return;
+			}
+
+			Read *file = reinterpret_cast<Read *>(tag);
+			if (result < 0 || file->request->IsCancelled() || stop) {
+				finishRead(file, false);
+				return;
+			}
+
+			file->offset += static_cast<size_t>(result);
+			// The file shrank since it was opened
+			if (result == 0)
+				file->data->Buffer().resize(file->offset);
+
+			if (file->offset < file->data->Size())
+				queueRead(file);
+			else
+				finishRead(file, true);
+		});
+	}
+
+	// Requests still waiting never started
+	std::lock_guard<std::mutex> lock(_mutex);
+	while (!_pending.empty()) {
+		_complete(_pending.top(), nullptr);
+		_pending.pop();
+	}
+}
+
+void IOUringFileBackend::startRead(Ref<IORequest> request) {
+	if (request->IsCancelled()) {
+		_complete(request, nullptr);
+		return;
+	}
+
+	std::filesystem::path path = _basePath / request->path;
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		_complete(request, nullptr);
+		return;
+	}
+
+	struct stat info {};
+	if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+		close(fd);
+		_complete(request, nullptr);
+		return;
+	}
+
+	Ref<FileData> data = FileData::New();
+	data->Buffer().resize(static_cast<size_t>(info.st_size));
+	if (data->Size() == 0) {
+		close(fd);
+		_complete(request, data);
+		return;
+	}
+
+	Read *read = new Read{request, data, fd};
+	_inFlight++;
+	queueRead(read);
+}
+
+void IOUringFileBackend::queueRead(Read *read) {
+	size_t remaining = read->data->Size() - read->offset;
+	read->vec.iov_base = read->data->Data() + read->offset;
+	read->vec.iov_len = std::min(remaining, MaxReadSize);
+
+	// Reads never exceed the free entries, run keeps one per read in flight plus the wake poll
+	io_uring_sqe *sqe = _ring->NextSqe();
+	sqe->opcode = IORING_OP_READV;
+	sqe->fd = read->fd;
+	sqe->addr = reinterpret_cast<u64>(&read->vec);
+	sqe->len = 1;
+	sqe->off = read->offset;
+	sqe->user_data = reinterpret_cast<u64>(read);
+}
+
+void IOUringFileBackend::queueWake() {
+	io_uring_sqe *sqe = _ring->NextSqe();
+	sqe->opcode = IORING_OP_POLL_ADD;
+	sqe->fd = _wakeFd;
+	sqe->poll_events = POLLIN;
+	sqe->user_data = WakeTag;
+}
+
+void IOUringFileBackend::finishRead(Read *read, bool ok) {
+	close(read->fd);
+	_inFlight--;
+	_complete(read->request, ok ? read->data : nullptr);
+	delete read;
+}
+
+#endif
\ No newline at end of file
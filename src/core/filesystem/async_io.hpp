@@ -0,0 +1,139 @@
+#ifndef ASYNC_IO_HPP
+#define ASYNC_IO_HPP
+#pragma once
+
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "sowa.hpp"
+
+struct FileData;
+class FileServer;
+class ThreadPool;
+
+enum class IOPriority : u8 {
+	Low = 0,
+	Normal,
+	High,
+};
+
+// One LoadAsync call, shared by the caller's handle and the backend loading it
+struct IORequest {
+	virtual ~IORequest() = default;
+
+	// Relative to the file server
+	std::filesystem::path path;
+	IOPriority priority = IOPriority::Normal;
+	// Keeps requests of the same priority in submission order
+	u64 sequence = 0;
+	std::atomic<bool> cancelled{false};
+
+	inline bool IsCancelled() const { return cancelled.load(std::memory_order_relaxed); }
+};
+
+// Highest priority first, then oldest first
+struct IORequestOrder {
+	inline bool operator()(const Ref<IORequest> &a, const Ref<IORequest> &b) const {
+		if (a->priority != b->priority)
+			return a->priority < b->priority;
+		return a->sequence > b->sequence;
+	}
+};
+
+using IORequestQueue = std::priority_queue<Ref<IORequest>, std::vector<Ref<IORequest>>, IORequestOrder>;
+
+// Called by backends exactly once per request, on any thread. data is nullptr if the file could not be loaded or the
+// request was cancelled before it was
+using IOCompletion = std::function<void(Ref<IORequest> request, Ref<FileData> data)>;
+
+class IOHandle {
+  public:
+	IOHandle() = default;
+	IOHandle(Ref<IORequest> request) : _request(request) {}
+
+	// Requests that have not started are dropped, loads already running finish but their callback is not called
+	inline void Cancel() {
+		if (_request)
+			_request->cancelled = true;
+	}
+	inline bool IsValid() const { return _request != nullptr; }
+
+  private:
+	Ref<IORequest> _request;
+};
+
+// Loads the requests of one file server off the calling thread
+class AsyncFileBackend {
+  public:
+	virtual ~AsyncFileBackend() = default;
+
+	virtual void Submit(Ref<IORequest> request) = 0;
+};
+
+// Loads through FileServer::Load on the thread pool. Each job takes the most urgent pending request rather than the
+// one it was submitted for, so priorities hold while the pool is busy
+class ThreadPoolFileBackend : public AsyncFileBackend {
+  public:
+	ThreadPoolFileBackend(FileServer *server, ThreadPool &pool, IOCompletion complete);
+
+	void Submit(Ref<IORequest> request) override;
+
+  private:
+	struct Queue {
+		std::mutex mutex;
+		IORequestQueue pending;
+	};
+
+	FileServer *_server = nullptr;
+	ThreadPool &_pool;
+	IOCompletion _complete;
+	// Shared with queued jobs, which may outlive the backend
+	Ref<Queue> _queue;
+};
+
+#ifdef SW_LINUX
+// Reads whole files under a folder through an io_uring ring, serviced by one thread that opens files and keeps up to
+// depth reads in flight
+class IOUringFileBackend : public AsyncFileBackend {
+  public:
+	IOUringFileBackend(const std::filesystem::path &basePath, IOCompletion complete);
+	~IOUringFileBackend() override;
+
+	// Sets up the ring and starts its thread. Returns false if the kernel lacks io_uring or does not allow it
+	bool Start(u32 depth = 32);
+
+	void Submit(Ref<IORequest> request) override;
+
+  private:
+	struct Ring;
+	struct Read;
+
+	void run();
+	// Opens the file and queues its first read, completes the request on failure
+	void startRead(Ref<IORequest> request);
+	void queueRead(Read *read);
+	void queueWake();
+	void finishRead(Read *read, bool ok);
+
+	std::filesystem::path _basePath;
+	IOCompletion _complete;
+
+	std::unique_ptr<Ring> _ring;
+	// Written by Submit to wake the thread out of io_uring_enter
+	int _wakeFd = -1;
+	u32 _inFlight = 0;
+	std::thread _thread;
+
+	std::mutex _mutex;
+	IORequestQueue _pending;
+	bool _stop = false;
+};
+#endif
+
+#endif // ASYNC_IO_HPP
\ No newline at end of file
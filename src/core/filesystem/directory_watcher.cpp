@@ -0,0 +1,79 @@
+#include "directory_watcher.hpp"
+
+#include <cerrno>
+#include <cstring>
+
+#ifdef SW_LINUX
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+#ifdef SW_LINUX
+static constexpr u32 EntriesMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF;
+// Saves that replace the file through a rename only show up as a move
+static constexpr u32 WritesMask = IN_CLOSE_WRITE | IN_MOVED_TO;
+#endif
+
+DirectoryWatcher::DirectoryWatcher() {
+#ifdef SW_LINUX
+	_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+
+DirectoryWatcher::~DirectoryWatcher() {
+#ifdef SW_LINUX
+	if (_fd >= 0)
+		close(_fd);
+#endif
+}
+
+i32 DirectoryWatcher::Watch(const std::filesystem::path &dir, u32 events) {
+#ifdef SW_LINUX
+	if (_fd < 0)
+		return -1;
+
+	u32 mask = IN_ONLYDIR;
+	if (events & WatchEvents_Entries)
+		mask |= EntriesMask;
+	if (events & WatchEvents_Writes)
+		mask |= WritesMask;
+	return inotify_add_watch(_fd, dir.c_str(), mask);
+#else
+	return -1;
+#endif
+}
+
+void DirectoryWatcher::Unwatch(i32 watch) {
+#ifdef SW_LINUX
+	if (_fd >= 0 && watch >= 0)
+		inotify_rm_watch(_fd, watch);
+#endif
+}
+
+bool DirectoryWatcher::Poll(std::vector<DirectoryEvent> &events) {
+#ifdef SW_LINUX
+	if (_fd < 0)
+		return true;
+
+	alignas(inotify_event) char buffer[4096];
+	bool complete = true;
+	while (true) {
+		ssize_t size = read(_fd, buffer, sizeof(buffer));
+		if (size <= 0)
+			break;
+
+		for (ssize_t pos = 0; pos < size;) {
+			const inotify_event *event = reinterpret_cast<const inotify_event *>(buffer + pos);
+			pos += sizeof(inotify_event) + event->len;
+
+			if (event->mask & IN_Q_OVERFLOW)
+				complete = false;
+			else if (event->wd >= 0)
+				events.push_back(DirectoryEvent{event->wd, event->len > 0 ? std::string(event->name) : std::string()});
+		}
+	}
+	return complete;
+#else
+	return true;
+#endif
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef DIRECTORY_WATCHER_HPP
+#define DIRECTORY_WATCHER_HPP
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "sowa.hpp"
+
+enum WatchEvents : u32 {
+	// An entry was added, removed or renamed, or the directory itself was removed
+	WatchEvents_Entries = 1 << 0,
+	// A file finished being written or was moved into the directory
+	WatchEvents_Writes = 1 << 1,
+};
+
+struct DirectoryEvent {
+	i32 watch = -1;
+	// Entry the event is about, empty for events about the directory itself
+	std::string name;
+};
+
+// Reports changes inside directories on disk, through inotify on Linux. Elsewhere, or when inotify can not be
+// initialized, Watch always fails and callers have to poll
+class DirectoryWatcher {
+  public:
+	DirectoryWatcher();
+	~DirectoryWatcher();
+	DirectoryWatcher(const DirectoryWatcher &) = delete;
+	DirectoryWatcher &operator=(const DirectoryWatcher &) = delete;
+
+	inline bool IsAvailable() const { return _fd >= 0; }
+
+	// Returns the id events report the directory with, or -1. The same directory always gets the same id, watching it
+	// again replaces its events
+	i32 Watch(const std::filesystem::path &dir, u32 events = WatchEvents_Entries);
+	void Unwatch(i32 watch);
+
+	// Appends the events since the last call. Returns false if events were lost and every watched directory has to be
+	// assumed changed. Never blocks
+	bool Poll(std::vector<DirectoryEvent> &events);
+
+  private:
+	int _fd = -1;
+};
+
+#endif // DIRECTORY_WATCHER_HPP
\ No newline at end of file
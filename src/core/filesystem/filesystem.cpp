@@ -1,10 +1,31 @@
 #include "filesystem.hpp"
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 
+#ifdef SW_LINUX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 #include "core/debug.hpp"
 
+// How often directories that can not be watched are checked for changes
+static constexpr std::chrono::milliseconds DirectoryPollInterval{1000};
+
+// Smaller files are read into a buffer, mapping them costs more than the copy it saves
+static constexpr size_t MinMappedSize = 64 * 1024;
+
+FileData::~FileData() {
+#ifdef SW_LINUX
+	if (mapped)
+		munmap(data, size);
+#endif
+}
+
 Ref<FileData> FileData::New() {
 	return std::make_shared<FileData>();
 }
@@ -17,56 +38,385 @@ Ref<FileData> FileData::NewStatic(std::byte *data, size_t size) {
 	return filedata;
 }
 
+Ref<FileData> FileData::NewView(Ref<FileData> owner, std::byte *data, size_t size) {
+	Ref<FileData> filedata = FileData::NewStatic(data, size);
+	filedata->owner = owner;
+	return filedata;
+}
+
+Ref<FileData> FileData::NewDetached(Ref<FileData> data) {
+	if (!data || !data->IsMapped())
+		return data;
+
+	Ref<FileData> copy = FileData::New();
+	copy->buffer.assign(data->Data(), data->Data() + data->Size());
+	return copy;
+}
+
+Ref<FileData> FileData::NewMapped(const std::filesystem::path &path) {
+#ifdef SW_LINUX
+	int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return nullptr;
+
+	struct stat info {};
+	if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0) {
+		close(fd);
+		return nullptr;
+	}
+
+	size_t size = static_cast<size_t>(info.st_size);
+	void *map = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+	// The mapping keeps its own reference to the file
+	close(fd);
+	if (map == MAP_FAILED)
+		return nullptr;
+
+	Ref<FileData> filedata = FileData::New();
+	filedata->dynamic = false;
+	filedata->mapped = true;
+	filedata->data = static_cast<std::byte *>(map);
+	filedata->size = size;
+	return filedata;
+#else
+	return nullptr;
+#endif
+}
+
+namespace {
+// Reads from a FileData it keeps alive
+class FileDataStreamBuf : public std::streambuf {
+  public:
+	FileDataStreamBuf(Ref<FileData> data) : _data(data) {
+		char *begin = reinterpret_cast<char *>(_data->Data());
+		setg(begin, begin, begin + _data->Size());
+	}
+
+  protected:
+	pos_type seekoff(off_type off, std::ios_base::seekdir dir, std::ios_base::openmode which) override {
+		off_type pos = off;
+		if (dir == std::ios_base::cur)
+			pos += gptr() - eback();
+		else if (dir == std::ios_base::end)
+			pos += egptr() - eback();
+
+		if (pos < 0 || pos > egptr() - eback())
+			return pos_type(off_type(-1));
+		setg(eback(), eback() + pos, egptr());
+		return pos_type(pos);
+	}
+
+	pos_type seekpos(pos_type pos, std::ios_base::openmode which) override {
+		return seekoff(off_type(pos), std::ios_base::beg, which);
+	}
+
+  private:
+	Ref<FileData> _data;
+};
+
+class FileDataStream : public std::istream {
+  public:
+	FileDataStream(Ref<FileData> data) : std::istream(nullptr), _buf(data) {
+		rdbuf(&_buf);
+	}
+
+  private:
+	FileDataStreamBuf _buf;
+};
+} // namespace
+
+std::unique_ptr<std::istream> FileData::OpenStream(Ref<FileData> data) {
+	return std::make_unique<FileDataStream>(data);
+}
+
+std::unique_ptr<std::istream> FileServer::LoadStream(const std::filesystem::path &path) {
+	Ref<FileData> data = Load(path);
+	if (!data)
+		return nullptr;
+
+	return FileData::OpenStream(data);
+}
+
+std::unique_ptr<AsyncFileBackend> FileServer::NewAsyncBackend(ThreadPool &pool, IOCompletion complete) {
+	return std::make_unique<ThreadPoolFileBackend>(this, pool, complete);
+}
+
 void FileSystem::RegisterFileServer(const char *scheme, FileServer *server) {
-	_fileServers[scheme] = server;
+	for (auto &[name, registered] : _fileServers) {
+		if (name == scheme) {
+			registered = server;
+			return;
+		}
+	}
+	_fileServers.emplace_back(scheme, server);
 }
 
 FileServer *FileSystem::GetFileServer(const char *scheme) {
-	return _fileServers[scheme];
+	return findServer(scheme);
 }
 
 bool FileSystem::HasFileServer(const char *scheme) {
-	return _fileServers.find(std::string(scheme)) != _fileServers.end();
+	for (auto &[name, server] : _fileServers) {
+		if (name == scheme)
+			return true;
+	}
+	return false;
+}
+
+// There are only a handful of servers, comparing schemes beats hashing them
+FileServer *FileSystem::findServer(std::string_view scheme) {
+	for (auto &[name, server] : _fileServers) {
+		if (name == scheme)
+			return server;
+	}
+	return nullptr;
 }
 
 PathData FileSystem::ResolvePath(const std::string &path) {
-	PathData pathData;
+	PathView view = SplitPath(path);
+	return PathData{std::string(view.scheme), std::string(view.path)};
+}
+
+std::filesystem::path FileSystem::GetDiskPath(const ResPath &path) {
+	FileServer *server = findServer(path.Scheme());
+	if (server == nullptr)
+		return std::filesystem::path();
+
+	return server->GetDiskPath(path.Path());
+}
 
-	auto data = Utils::Split(path, "://");
-	if (data.size() == 2) {
-		pathData.scheme = data[0];
-		pathData.path = data[1];
-	} else if (data.size() == 1) {
-		// starts with ://
-		if (path[0] == ':' && path[1] == '/' && path[2] == '/') {
-			pathData.scheme = "";
-			pathData.path = data[0];
-		} else {
-			pathData.scheme = data[0];
-			pathData.path = "";
+// Called from resource decode jobs, servers are only registered during startup
+Ref<FileData> FileSystem::Load(const ResPath &path) {
+	FileServer *server = findServer(path.Scheme());
+	if (server == nullptr)
+		return nullptr;
+
+	if (_cacheBudget == 0 || !server->UseCache())
+		return server->Load(std::filesystem::path(path.Path()));
+
+	// Stat and Load touch the disk, the lock is only held around the cache itself
+	FileStamp stamp;
+	bool found = server->Stat(path.Path(), stamp);
+	{
+		std::lock_guard<std::mutex> lock(_cacheMutex);
+		auto it = _cache.find(path);
+		if (it != _cache.end() && found && it->second.stamp == stamp) {
+			_cacheStats.hits++;
+			_cacheUse.splice(_cacheUse.begin(), _cacheUse, it->second.use);
+			return it->second.data;
 		}
+
+		if (it != _cache.end())
+			eraseCacheEntry(it);
+		_cacheStats.misses++;
 	}
 
-	auto index = pathData.path.find_first_not_of('/');
-	if (index != std::string::npos)
-		pathData.path = pathData.path.substr(index);
-	return pathData;
+	Ref<FileData> file = server->Load(std::filesystem::path(path.Path()));
+	if (!file || !found)
+		return file;
+
+	std::lock_guard<std::mutex> lock(_cacheMutex);
+	if (file->Size() > _cacheBudget)
+		return file;
+
+	auto it = _cache.find(path);
+	if (it != _cache.end())
+		eraseCacheEntry(it);
+
+	_cacheUse.push_front(path);
+	_cache.emplace(path, CacheEntry{file, stamp, _cacheUse.begin()});
+	_cacheStats.bytes += file->Size();
+	trimCache();
+	return file;
 }
 
-Ref<FileData> FileSystem::Load(const std::filesystem::path &path) {
-	PathData data = ResolvePath(path);
-	if (!HasFileServer(data.scheme.c_str()) || _fileServers[data.scheme] == nullptr)
+void FileSystem::SetCacheBudget(size_t bytes) {
+	std::lock_guard<std::mutex> lock(_cacheMutex);
+	_cacheBudget = bytes;
+	trimCache();
+}
+
+void FileSystem::InvalidateCache(const ResPath &path) {
+	std::lock_guard<std::mutex> lock(_cacheMutex);
+	auto it = _cache.find(path);
+	if (it != _cache.end())
+		eraseCacheEntry(it);
+}
+
+void FileSystem::ClearCache() {
+	std::lock_guard<std::mutex> lock(_cacheMutex);
+	_cache.clear();
+	_cacheUse.clear();
+	_cacheStats.bytes = 0;
+}
+
+FileCacheStats FileSystem::GetCacheStats() {
+	std::lock_guard<std::mutex> lock(_cacheMutex);
+	FileCacheStats stats = _cacheStats;
+	stats.entries = _cache.size();
+	return stats;
+}
+
+void FileSystem::trimCache() {
+	while (_cacheStats.bytes > _cacheBudget && !_cacheUse.empty()) {
+		eraseCacheEntry(_cache.find(_cacheUse.back()));
+		_cacheStats.evictions++;
+	}
+}
+
+void FileSystem::eraseCacheEntry(std::unordered_map<ResPath, CacheEntry>::iterator it) {
+	_cacheStats.bytes -= it->second.data->Size();
+	_cacheUse.erase(it->second.use);
+	_cache.erase(it);
+}
+
+std::unique_ptr<std::istream> FileSystem::LoadStream(const ResPath &path) {
+	FileServer *server = findServer(path.Scheme());
+	if (server == nullptr)
 		return nullptr;
 
-	return _fileServers[data.scheme]->Load(data.path);
+	return server->LoadStream(path.Path());
 }
 
-std::vector<FileEntry> FileSystem::ReadDirectory(const std::filesystem::path &path) {
-	PathData data = ResolvePath(path);
-	if (!HasFileServer(data.scheme.c_str()) || _fileServers[data.scheme] == nullptr)
-		return std::vector<FileEntry>();
+std::vector<FileEntry> FileSystem::ReadDirectory(const ResPath &path) {
+	return ListDirectory(path);
+}
+
+const std::vector<FileEntry> &FileSystem::ListDirectory(const ResPath &path) {
+	static const std::vector<FileEntry> empty;
+
+	auto it = _listings.find(path);
+	if (it != _listings.end())
+		return it->second.entries;
+
+	FileServer *server = findServer(path.Scheme());
+	if (server == nullptr)
+		return empty;
+
+	// Watched before reading, so a change made while reading is not missed
+	DirectoryListing listing;
+	std::filesystem::path serverPath = path.Path();
+	std::filesystem::path diskPath = server->GetDiskPath(serverPath);
+	if (!diskPath.empty()) {
+		i32 watch = _watcher.Watch(diskPath);
+		// Another key already holds the watch when two paths lead to the same directory, this one is polled
+		if (watch >= 0 && _listingWatches.emplace(watch, path).second)
+			listing.watch = watch;
+	}
+	if (!server->Stat(path.Path(), listing.stamp))
+		listing.stamp = FileStamp{};
+	listing.entries = server->ReadDirectory(serverPath);
 
-	return _fileServers[data.scheme]->ReadDirectory(data.path);
+	return _listings.emplace(path, std::move(listing)).first->second.entries;
+}
+
+void FileSystem::PollDirectoryChanges() {
+	std::vector<DirectoryEvent> events;
+	if (!_watcher.Poll(events)) {
+		while (!_listings.empty())
+			eraseListing(_listings.begin());
+		return;
+	}
+
+	for (const DirectoryEvent &event : events) {
+		auto it = _listingWatches.find(event.watch);
+		if (it != _listingWatches.end())
+			eraseListing(_listings.find(it->second));
+	}
+
+	auto now = std::chrono::steady_clock::now();
+	if (now - _lastDirectoryPoll < DirectoryPollInterval)
+		return;
+	_lastDirectoryPoll = now;
+
+	for (auto it = _listings.begin(); it != _listings.end();) {
+		auto current = it++;
+		if (current->second.watch >= 0)
+			continue;
+
+		FileServer *server = findServer(current->first.Scheme());
+		FileStamp stamp;
+		if (server == nullptr || !server->Stat(current->first.Path(), stamp) || !(stamp == current->second.stamp))
+			eraseListing(current);
+	}
+}
+
+void FileSystem::eraseListing(std::unordered_map<ResPath, DirectoryListing>::iterator it) {
+	if (it->second.watch >= 0) {
+		_watcher.Unwatch(it->second.watch);
+		_listingWatches.erase(it->second.watch);
+	}
+	_listings.erase(it);
+}
+
+IOHandle FileSystem::LoadAsync(const ResPath &path, std::function<void(Ref<FileData>)> callback, IOPriority priority) {
+	Ref<AsyncRequest> request = std::make_shared<AsyncRequest>();
+	request->path = path.Path();
+	request->priority = priority;
+	request->callback = callback;
+	submitAsync(request, path.Scheme());
+	return IOHandle(request);
+}
+
+FileFuture FileSystem::LoadAsync(const ResPath &path, IOPriority priority) {
+	Ref<AsyncRequest> request = std::make_shared<AsyncRequest>();
+	request->path = path.Path();
+	request->priority = priority;
+
+	FileFuture future;
+	future.data = request->promise.get_future();
+	future.handle = IOHandle(request);
+	submitAsync(request, path.Scheme());
+	return future;
+}
+
+void FileSystem::DispatchCompletions() {
+	std::vector<Ref<AsyncRequest>> completed;
+	{
+		std::lock_guard<std::mutex> lock(_completedMutex);
+		completed.swap(_completed);
+	}
+
+	// Callbacks may start new loads, those land in _completed for the next frame
+	for (Ref<AsyncRequest> &request : completed) {
+		if (!request->IsCancelled())
+			request->callback(request->result);
+	}
+}
+
+void FileSystem::submitAsync(Ref<AsyncRequest> request, std::string_view scheme) {
+	request->sequence = _asyncSequence++;
+
+	AsyncFileBackend *backend = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(_asyncMutex);
+		FileServer *server = findServer(scheme);
+		if (server != nullptr && _threadPool != nullptr) {
+			std::unique_ptr<AsyncFileBackend> &slot = _asyncBackends[server];
+			if (!slot)
+				slot = server->NewAsyncBackend(*_threadPool, [this](Ref<IORequest> request, Ref<FileData> data) { completeAsync(request, data); });
+			backend = slot.get();
+		}
+	}
+
+	if (backend == nullptr) {
+		completeAsync(request, nullptr);
+		return;
+	}
+	backend->Submit(request);
+}
+
+void FileSystem::completeAsync(Ref<IORequest> request, Ref<FileData> data) {
+	Ref<AsyncRequest> async = std::static_pointer_cast<AsyncRequest>(request);
+	// Backends complete every request exactly once, cancelled ones included, so the future is always resolved
+	if (!async->callback) {
+		async->promise.set_value(async->IsCancelled() ? nullptr : data);
+		return;
+	}
+
+	async->result = data;
+	std::lock_guard<std::mutex> lock(_completedMutex);
+	_completed.push_back(async);
 }
 
 FileServer *FileSystem::NewFolderFileServer(const char *scheme, const std::filesystem::path &path) {
@@ -79,22 +429,73 @@ FileServer *FileSystem::NewFolderFileServer(const char *scheme, const std::files
 		}
 
 		Ref<FileData> Load(const std::filesystem::path &path) {
-			Ref<FileData> data = FileData::New();
+			std::filesystem::path filePath = GetPath(path);
+
+			std::error_code ec;
+			std::uintmax_t fileSize = std::filesystem::file_size(filePath, ec);
+			if (!ec && fileSize >= MinMappedSize) {
+				if (Ref<FileData> mapped = FileData::NewMapped(filePath))
+					return mapped;
+			}
 
-			std::ifstream file{GetPath(path), std::ios::binary};
+			std::ifstream file{filePath, std::ios::binary};
 			if (!file.good())
 				return nullptr;
 
 			file.seekg(0, std::ios::end);
-			int size = static_cast<int>(file.tellg());
+			std::streamoff size = file.tellg();
 			file.seekg(0, std::ios::beg);
+			if (size < 0)
+				return nullptr;
 
-			data->Buffer().resize(size);
-			file.read(reinterpret_cast<char *>(data->Buffer().data()), static_cast<long>(size));
+			Ref<FileData> data = FileData::New();
+			data->Buffer().resize(static_cast<size_t>(size));
+			file.read(reinterpret_cast<char *>(data->Buffer().data()), static_cast<std::streamsize>(size));
 
 			return data;
 		}
 
+		bool Stat(std::string_view path, FileStamp &out) {
+			std::filesystem::path filePath = _basePath / path;
+			std::error_code ec;
+			std::filesystem::file_time_type modified = std::filesystem::last_write_time(filePath, ec);
+			if (ec)
+				return false;
+			// Directories are stamped by their modification time alone, which changes with their entries
+			std::uintmax_t size = 0;
+			if (!std::filesystem::is_directory(filePath, ec)) {
+				size = std::filesystem::file_size(filePath, ec);
+				if (ec)
+					return false;
+			}
+
+			out.modified = static_cast<i64>(modified.time_since_epoch().count());
+			out.size = static_cast<u64>(size);
+			return true;
+		}
+
+		std::filesystem::path GetDiskPath(const std::filesystem::path &path) {
+			return GetPath(path);
+		}
+
+		std::unique_ptr<AsyncFileBackend> NewAsyncBackend(ThreadPool &pool, IOCompletion complete) {
+#ifdef SW_LINUX
+			auto uring = std::make_unique<IOUringFileBackend>(_basePath, complete);
+			if (uring->Start())
+				return uring;
+			Debug::Warn("io_uring is not available, '{}://' loads asynchronously on the thread pool", _scheme);
+#endif
+			return FileServer::NewAsyncBackend(pool, complete);
+		}
+
+		std::unique_ptr<std::istream> LoadStream(const std::filesystem::path &path) {
+			auto file = std::make_unique<std::ifstream>(GetPath(path), std::ios::binary);
+			if (!file->good())
+				return nullptr;
+
+			return file;
+		}
+
 		std::vector<FileEntry> ReadDirectory(const std::filesystem::path &path) {
 			std::vector<FileEntry> entries;
 			std::filesystem::path dir = GetPath(path);
@@ -115,10 +516,62 @@ FileServer *FileSystem::NewFolderFileServer(const char *scheme, const std::files
 		}
 
 		void GetSaveStream(const std::filesystem::path &path, std::ofstream &out) {
-			out = std::ofstream(GetPath(_fs->ResolvePath(path).path));
+			out = std::ofstream(GetPath(ResPath(path).Path()), std::ios::binary);
+		}
+
+		bool SaveAtomic(const std::filesystem::path &path, const std::function<bool(std::ostream &)> &write) {
+			std::filesystem::path target = GetPath(ResPath(path).Path());
+			std::filesystem::path temp = target;
+			temp += ".tmp";
+
+			std::error_code ec;
+			{
+				std::ofstream out(temp, std::ios::binary);
+				if (!out.good()) {
+					Debug::Error("Failed to open file on '{}'", temp.string());
+					return false;
+				}
+
+				bool written = write(out);
+				out.flush();
+				if (!written || !out.good()) {
+					out.close();
+					std::filesystem::remove(temp, ec);
+					return false;
+				}
+			}
+
+#ifdef SW_LINUX
+			// Without this a crash after the rename can leave the target empty, the rename may reach the disk before the data
+			if (!syncFile(temp)) {
+				Debug::Error("Failed to sync '{}'", temp.string());
+				std::filesystem::remove(temp, ec);
+				return false;
+			}
+#endif
+
+			// rename replaces the target in one step on both POSIX and Windows
+			std::filesystem::rename(temp, target, ec);
+			if (ec) {
+				Debug::Error("Failed to replace '{}': {}", target.string(), ec.message());
+				std::filesystem::remove(temp, ec);
+				return false;
+			}
+			return true;
 		}
 
 	  private:
+#ifdef SW_LINUX
+		static bool syncFile(const std::filesystem::path &path) {
+			int fd = open(path.c_str(), O_RDONLY);
+			if (fd == -1)
+				return false;
+			bool synced = fsync(fd) == 0;
+			close(fd);
+			return synced;
+		}
+#endif
+
 		FileSystem *_fs = nullptr;
 		std::string _scheme = "";
 		std::filesystem::path _basePath = "";
@@ -141,4 +594,99 @@ Ref<FileData> DataFileServer::Load(const std::filesystem::path &path) {
 		return nullptr;
 
 	return _files[path.string()];
+}
+
+PackFileServer *FileSystem::NewPackFileServer(const char *scheme, const std::filesystem::path &path) {
+	PackFileServer *server = new PackFileServer(scheme);
+	if (!server->Open(path)) {
+		delete server;
+		return nullptr;
+	}
+	return server;
+}
+
+PackFileServer::PackFileServer(const char *scheme) : _scheme(scheme) {}
+
+bool PackFileServer::Open(const std::filesystem::path &path) {
+	_pack = FileData::NewMapped(path);
+	if (!_pack) {
+		// Platforms without mmap read the whole pack instead
+		std::ifstream file{path, std::ios::binary};
+		if (!file.good()) {
+			Debug::Error("Failed to open pack '{}'", path.string());
+			return false;
+		}
+
+		file.seekg(0, std::ios::end);
+		std::streamoff size = file.tellg();
+		file.seekg(0, std::ios::beg);
+		if (size < 0)
+			return false;
+
+		_pack = FileData::New();
+		_pack->Buffer().resize(static_cast<size_t>(size));
+		file.read(reinterpret_cast<char *>(_pack->Buffer().data()), static_cast<std::streamsize>(size));
+	}
+
+	if (!_reader.Open(_pack->Data(), _pack->Size())) {
+		Debug::Error("Failed to open pack '{}': {}", path.string(), _reader.GetError());
+		_pack = nullptr;
+		return false;
+	}
+	return true;
+}
+
+Ref<FileData> PackFileServer::Load(const std::filesystem::path &path) {
+	const Pack::Entry *entry = _reader.Find(path.generic_string());
+	if (!entry)
+		return nullptr;
+
+	if (entry->compression == Pack::Compression::None)
+		return FileData::NewView(_pack, _pack->Data() + entry->offset, entry->size);
+
+	Ref<FileData> data = FileData::New();
+	data->Buffer().resize(entry->size);
+	if (!_reader.Extract(*entry, data->Buffer().data())) {
+		Debug::Error("Failed to decompress '{}://{}'", _scheme, path.generic_string());
+		return nullptr;
+	}
+	return data;
+}
+
+std::vector<FileEntry> PackFileServer::ReadDirectory(const std::filesystem::path &path) {
+	std::string prefix = path.generic_string();
+	while (!prefix.empty() && prefix.back() == '/')
+		prefix.pop_back();
+	if (!prefix.empty())
+		prefix += '/';
+
+	// Entries under prefix are contiguous in the sorted table, as are the entries of each subfolder
+	std::vector<FileEntry> entries;
+	std::string_view lastFolder;
+	const std::vector<Pack::Entry> &table = _reader.GetEntries();
+	for (size_t i = _reader.LowerBound(prefix); i < table.size(); i++) {
+		std::string_view entryPath = table[i].path;
+		if (entryPath.compare(0, prefix.size(), prefix) != 0)
+			break;
+
+		std::string_view rest = entryPath.substr(prefix.size());
+		size_t slash = rest.find('/');
+		if (slash == std::string_view::npos) {
+			entries.push_back(FileEntry{
+				.path = Utils::Format("{}://{}", _scheme, entryPath),
+				.is_directory = false});
+			continue;
+		}
+
+		std::string_view folder = rest.substr(0, slash);
+		if (folder == lastFolder)
+			continue;
+		lastFolder = folder;
+		entries.push_back(FileEntry{
+			.path = Utils::Format("{}://{}{}", _scheme, prefix, folder),
+			.is_directory = true});
+	}
+
+	std::sort(entries.begin(), entries.end());
+	return entries;
 }
\ No newline at end of file
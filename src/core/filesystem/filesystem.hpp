@@ -2,45 +2,89 @@
 #define FILESYSTEM_HPP
 #pragma once
 
+#include <atomic>
+#include <chrono>
 #include <cstddef>
 #include <filesystem>
+#include <functional>
+#include <future>
+#include <istream>
+#include <list>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "sowa.hpp"
 
+#include "async_io.hpp"
+#include "directory_watcher.hpp"
+#include "pack.hpp"
+#include "res_path.hpp"
+
 struct FileData {
   public:
 	FileData() = default;
-	~FileData() = default;
+	~FileData();
+	FileData(const FileData &) = delete;
+	FileData &operator=(const FileData &) = delete;
 
 	static Ref<FileData> New();
 	// Returns a FileData that contains static data. Dynamic buffer can still be accessed. but .Data() and .Size() functions will return static data
 	static Ref<FileData> NewStatic(std::byte *data, size_t size);
+	// Maps the file into memory, it stays mapped until the FileData is destroyed. Pages are private, writes through
+	// Data() never reach the file. Returns nullptr if the file can not be mapped
+	static Ref<FileData> NewMapped(const std::filesystem::path &path);
+	// Returns a FileData over size bytes at data inside owner, which is kept alive with it
+	static Ref<FileData> NewView(Ref<FileData> owner, std::byte *data, size_t size);
+	// Seekable stream over the contents, it keeps data alive
+	static std::unique_ptr<std::istream> OpenStream(Ref<FileData> data);
+	// Returns data itself, or a copy of it in memory when it is mapped. Holders that read the contents long after the
+	// load call it, the file may be rewritten by then
+	static Ref<FileData> NewDetached(Ref<FileData> data);
 
 	std::byte *Data() {
 		if (dynamic)
 			return buffer.data();
 		return data;
 	}
+	const std::byte *Data() const {
+		if (dynamic)
+			return buffer.data();
+		return data;
+	}
 
-	size_t Size() {
+	size_t Size() const {
 		if (dynamic)
 			return buffer.size();
 		return size;
 	}
 
+	// Contents as text, valid while the FileData is alive. Not null terminated
+	std::string_view View() const {
+		return std::string_view(reinterpret_cast<const char *>(Data()), Size());
+	}
+
+	// Whether the contents are pages of a mapped file, directly or through the owner of a view. Reading them faults if
+	// the file is truncated meanwhile
+	inline bool IsMapped() const { return mapped || (owner && owner->IsMapped()); }
+
+	// Only holds the contents of dynamic FileData, use Data() and Size() to read any kind
 	std::vector<std::byte> &Buffer() {
 		return buffer;
 	}
 
   private:
-	std::byte *data;
-	size_t size;
+	std::byte *data = nullptr;
+	size_t size = 0;
 
 	bool dynamic = true;
+	bool mapped = false;
 	std::vector<std::byte> buffer;
+	Ref<FileData> owner;
 };
 
 struct FileEntry {
@@ -52,6 +96,29 @@ struct FileEntry {
 	}
 };
 
+// What a cached file was loaded from. Files with an unchanged stamp are assumed unchanged
+struct FileStamp {
+	i64 modified = 0;
+	u64 size = 0;
+
+	bool operator==(const FileStamp &other) const { return modified == other.modified && size == other.size; }
+};
+
+struct FileCacheStats {
+	u64 hits = 0;
+	u64 misses = 0;
+	u64 evictions = 0;
+	size_t bytes = 0;
+	size_t entries = 0;
+};
+
+// Result of a LoadAsync without callback. data holds nullptr if the file could not be loaded or the load was
+// cancelled before it finished
+struct FileFuture {
+	std::future<Ref<FileData>> data;
+	IOHandle handle;
+};
+
 struct PathData {
 	std::string scheme;
 	std::string path;
@@ -59,13 +126,35 @@ struct PathData {
 
 class FileServer {
   public:
+	virtual ~FileServer() = default;
+
 	virtual Ref<FileData> Load(const std::filesystem::path &path) = 0;
+	// Opens the file for sequential reading. Default implementation reads it through Load
+	virtual std::unique_ptr<std::istream> LoadStream(const std::filesystem::path &path);
 	virtual std::vector<FileEntry> ReadDirectory(const std::filesystem::path &path) { return std::vector<FileEntry>{}; };
+
+	// Fills the stamp FileSystem validates cached files with, returns false if the file can not be found. The default
+	// is for servers whose files never change. Called on every cache hit, so path is passed as the ResPath holds it
+	virtual bool Stat(std::string_view path, FileStamp &out) {
+		out = FileStamp{};
+		return true;
+	}
+	// Servers that already keep their files in memory skip the FileSystem cache
+	virtual bool UseCache() const { return true; }
+	// Where path lives on disk, empty for servers that do not read from a folder. Directories with a disk path are
+	// watched for changes instead of polled
+	virtual std::filesystem::path GetDiskPath(const std::filesystem::path &path) { return std::filesystem::path(); }
+
+	// Backend that runs this server's LoadAsync requests. The default calls Load on the thread pool
+	virtual std::unique_ptr<AsyncFileBackend> NewAsyncBackend(ThreadPool &pool, IOCompletion complete);
 };
 
 class SaveableFileServer {
   public:
 	virtual void GetSaveStream(const std::filesystem::path &path, std::ofstream &out) = 0;
+	// Writes to a temporary file next to path and renames it over path once write returns true, so a failed or
+	// interrupted save leaves the previous file intact
+	virtual bool SaveAtomic(const std::filesystem::path &path, const std::function<bool(std::ostream &)> &write) = 0;
 };
 
 class DataFileServer : public FileServer {
@@ -73,26 +162,128 @@ class DataFileServer : public FileServer {
 	DataFileServer &AddFile(const char *path, Ref<FileData> data);
 
 	Ref<FileData> Load(const std::filesystem::path &path) override;
+	bool UseCache() const override { return false; }
 
   private:
 	std::unordered_map<std::string, Ref<FileData>> _files;
 };
 
+// Serves the files of a pack built by sowa-packer. The pack is mapped once, uncompressed entries are returned as views
+// into it and compressed ones are decompressed on load
+class PackFileServer : public FileServer {
+  public:
+	PackFileServer(const char *scheme);
+
+	bool Open(const std::filesystem::path &path);
+
+	Ref<FileData> Load(const std::filesystem::path &path) override;
+	std::vector<FileEntry> ReadDirectory(const std::filesystem::path &path) override;
+
+  private:
+	std::string _scheme = "";
+	Ref<FileData> _pack;
+	Pack::Reader _reader;
+};
+
 class FileSystem {
   public:
 	void RegisterFileServer(const char *scheme, FileServer *server);
 	FileServer *GetFileServer(const char *scheme);
 	bool HasFileServer(const char *scheme);
+	// Prefer ResPath, which parses a path once rather than on every call
 	PathData ResolvePath(const std::string &path);
+	// Where the file lives on disk, empty if its server does not read from a folder
+	std::filesystem::path GetDiskPath(const ResPath &path);
+
+	// Returns the cached data when the file is cached and unchanged, the data is shared with every caller
+	Ref<FileData> Load(const ResPath &path);
+	std::unique_ptr<std::istream> LoadStream(const ResPath &path);
+	std::vector<FileEntry> ReadDirectory(const ResPath &path);
+	// Cached listing of the directory, sorted like ReadDirectory. The reference stays valid until the next
+	// PollDirectoryChanges. Main thread only
+	const std::vector<FileEntry> &ListDirectory(const ResPath &path);
+	// Drops listings of directories that changed. Watched directories are checked every call, the rest are compared
+	// against their Stat stamp once per DirectoryPollInterval. Application::Update calls it once a frame
+	void PollDirectoryChanges();
 
-	Ref<FileData> Load(const std::filesystem::path &path);
-	std::vector<FileEntry> ReadDirectory(const std::filesystem::path &path);
+	// Loads on the file server's async backend, bypassing the cache. callback runs on the main thread in
+	// DispatchCompletions, with nullptr if the file could not be loaded. Cancelling the handle from the main thread
+	// guarantees callback is not called, so it may capture objects that cancel in their destructor
+	IOHandle LoadAsync(const ResPath &path, std::function<void(Ref<FileData>)> callback, IOPriority priority = IOPriority::Normal);
+	// The future is ready as soon as the load finishes, without waiting for DispatchCompletions
+	FileFuture LoadAsync(const ResPath &path, IOPriority priority = IOPriority::Normal);
+	// Runs the callbacks of finished loads, Application::Update calls it once a frame
+	void DispatchCompletions();
+	// Fallback backends run on pool, it has to be set before the first LoadAsync
+	inline void SetThreadPool(ThreadPool *pool) { _threadPool = pool; }
+
+	// Files loaded through Load are kept until they no longer fit in bytes, least recently used first. 0 disables the
+	// cache
+	void SetCacheBudget(size_t bytes);
+	inline size_t GetCacheBudget() const { return _cacheBudget; }
+	void InvalidateCache(const ResPath &path);
+	void ClearCache();
+	FileCacheStats GetCacheStats();
 
 	FileServer *NewFolderFileServer(const char *scheme, const std::filesystem::path &path);
 	DataFileServer *NewDataFileServer();
+	// Returns nullptr if the pack can not be opened
+	PackFileServer *NewPackFileServer(const char *scheme, const std::filesystem::path &path);
 
   private:
-	std::unordered_map<std::string, FileServer *> _fileServers;
+	struct AsyncRequest : IORequest {
+		std::function<void(Ref<FileData>)> callback;
+		std::promise<Ref<FileData>> promise;
+		Ref<FileData> result;
+	};
+
+	struct DirectoryListing {
+		std::vector<FileEntry> entries;
+		FileStamp stamp;
+		// -1 if the directory is polled
+		i32 watch = -1;
+	};
+
+	struct CacheEntry {
+		Ref<FileData> data;
+		FileStamp stamp;
+		std::list<ResPath>::iterator use;
+	};
+
+	// Drops least recently used entries until the cache fits in its budget. Expects _cacheMutex to be held
+	void trimCache();
+	void eraseCacheEntry(std::unordered_map<ResPath, CacheEntry>::iterator it);
+
+	void eraseListing(std::unordered_map<ResPath, DirectoryListing>::iterator it);
+	FileServer *findServer(std::string_view scheme);
+
+	// Hands request to its server's backend, completing it right away if the scheme has no server
+	void submitAsync(Ref<AsyncRequest> request, std::string_view scheme);
+	void completeAsync(Ref<IORequest> request, Ref<FileData> data);
+
+  private:
+	std::vector<std::pair<std::string, FileServer *>> _fileServers;
+
+	// Load runs on resource decode jobs too
+	std::mutex _cacheMutex;
+	std::unordered_map<ResPath, CacheEntry> _cache;
+	// Most recently used first
+	std::list<ResPath> _cacheUse;
+	size_t _cacheBudget = 0;
+	FileCacheStats _cacheStats;
+
+	std::unordered_map<ResPath, DirectoryListing> _listings;
+	std::unordered_map<i32, ResPath> _listingWatches;
+	DirectoryWatcher _watcher;
+	std::chrono::steady_clock::time_point _lastDirectoryPoll;
+
+	ThreadPool *_threadPool = nullptr;
+	std::atomic<u64> _asyncSequence{0};
+	std::mutex _completedMutex;
+	std::vector<Ref<AsyncRequest>> _completed;
+	// Declared last so backend threads stop before the queue they complete into goes away
+	std::mutex _asyncMutex;
+	std::unordered_map<FileServer *, std::unique_ptr<AsyncFileBackend>> _asyncBackends;
 };
 
 #endif // FILESYSTEM_HPP
\ No newline at end of file
@@ -0,0 +1,176 @@
+#include "lz4.hpp"
+
+#include <cstring>
+#include <vector>
+
+namespace LZ4 {
+
+namespace {
+
+constexpr size_t MinMatch = 4;
+// The last match starts at least this far from the end and the last bytes are always literals
+constexpr size_t MatchFindLimit = 12;
+constexpr size_t LastLiterals = 5;
+constexpr size_t MaxOffset = 65535;
+constexpr u32 HashLog = 16;
+
+u32 Read32(const std::byte *p) {
+	u32 value = 0;
+	std::memcpy(&value, p, sizeof(value));
+	return value;
+}
+
+u32 Hash(u32 sequence) {
+	return (sequence * 2654435761u) >> (32 - HashLog);
+}
+
+// Writes the 255 continuation bytes of a length that did not fit in its token nibble
+bool PutLength(std::byte *dst, size_t capacity, size_t &op, size_t length) {
+	for (; length >= 255; length -= 255) {
+		if (op >= capacity)
+			return false;
+		dst[op++] = std::byte{255};
+	}
+	if (op >= capacity)
+		return false;
+	dst[op++] = static_cast<std::byte>(length);
+	return true;
+}
+
+bool PutSequence(std::byte *dst, size_t capacity, size_t &op, const std::byte *literals, size_t literalCount, size_t offset, size_t matchLength) {
+	if (op >= capacity)
+		return false;
+
+	size_t token = op++;
+	u8 tokenValue = static_cast<u8>((literalCount >= 15 ? 15 : literalCount) << 4);
+	if (literalCount >= 15 && !PutLength(dst, capacity, op, literalCount - 15))
+		return false;
+
+	if (capacity - op < literalCount)
+		return false;
+	std::memcpy(dst + op, literals, literalCount);
+	op += literalCount;
+
+	// The last sequence has literals only
+	if (matchLength > 0) {
+		if (capacity - op < 2)
+			return false;
+		dst[op++] = static_cast<std::byte>(offset & 0xFF);
+		dst[op++] = static_cast<std::byte>(offset >> 8);
+
+		size_t extra = matchLength - MinMatch;
+		tokenValue |= static_cast<u8>(extra >= 15 ? 15 : extra);
+		if (extra >= 15 && !PutLength(dst, capacity, op, extra - 15))
+			return false;
+	}
+
+	dst[token] = static_cast<std::byte>(tokenValue);
+	return true;
+}
+
+// Reads a length continued in 255 bytes, returns false if src ends first
+bool GetLength(const std::byte *src, size_t srcSize, size_t &ip, size_t &length) {
+	u8 byte = 255;
+	while (byte == 255) {
+		if (ip >= srcSize)
+			return false;
+		byte = static_cast<u8>(src[ip++]);
+		length += byte;
+	}
+	return true;
+}
+
+} // namespace
+
+size_t CompressBound(size_t size) {
+	return size + size / 255 + 16;
+}
+
+size_t Compress(const std::byte *src, size_t size, std::byte *dst, size_t capacity) {
+	size_t op = 0;
+	size_t anchor = 0;
+
+	if (size > MatchFindLimit) {
+		// Positions are stored plus one, zero marks an empty slot
+		std::vector<u32> table(size_t(1) << HashLog, 0);
+		size_t limit = size - MatchFindLimit;
+		size_t matchLimit = size - LastLiterals;
+
+		size_t ip = 0;
+		while (ip < limit) {
+			u32 sequence = Read32(src + ip);
+			u32 &slot = table[Hash(sequence)];
+			size_t candidate = slot;
+			slot = static_cast<u32>(ip + 1);
+
+			if (candidate == 0 || ip - (candidate - 1) > MaxOffset || Read32(src + candidate - 1) != sequence) {
+				ip++;
+				continue;
+			}
+
+			size_t ref = candidate - 1;
+			size_t length = MinMatch;
+			while (ip + length < matchLimit && src[ref + length] == src[ip + length])
+				length++;
+
+			if (!PutSequence(dst, capacity, op, src + anchor, ip - anchor, ip - ref, length))
+				return 0;
+
+			ip += length;
+			anchor = ip;
+		}
+	}
+
+	if (!PutSequence(dst, capacity, op, src + anchor, size - anchor, 0, 0))
+		return 0;
+	return op;
+}
+
+bool Decompress(const std::byte *src, size_t srcSize, std::byte *dst, size_t size) {
+	size_t ip = 0;
+	size_t op = 0;
+
+	while (ip < srcSize) {
+		u8 token = static_cast<u8>(src[ip++]);
+
+		size_t literals = token >> 4;
+		if (literals == 15 && !GetLength(src, srcSize, ip, literals))
+			return false;
+		if (literals > srcSize - ip || literals > size - op)
+			return false;
+		std::memcpy(dst + op, src + ip, literals);
+		ip += literals;
+		op += literals;
+
+		if (ip == srcSize)
+			break;
+
+		if (srcSize - ip < 2)
+			return false;
+		size_t offset = static_cast<size_t>(src[ip]) | static_cast<size_t>(src[ip + 1]) << 8;
+		ip += 2;
+		if (offset == 0 || offset > op)
+			return false;
+
+		size_t length = token & 15;
+		if (length == 15 && !GetLength(src, srcSize, ip, length))
+			return false;
+		length += MinMatch;
+		if (length > size - op)
+			return false;
+
+		// A match closer than its length overlaps the bytes it produces and is copied forward one byte at a time
+		const std::byte *from = dst + op - offset;
+		if (offset >= length) {
+			std::memcpy(dst + op, from, length);
+		} else {
+			for (size_t i = 0; i < length; i++)
+				dst[op + i] = from[i];
+		}
+		op += length;
+	}
+
+	return op == size;
+}
+
+} // namespace LZ4
\ No newline at end of file
@@ -0,0 +1,24 @@
+#ifndef LZ4_HPP
+#define LZ4_HPP
+#pragma once
+
+#include <cstddef>
+
+#include "sowa.hpp"
+
+// LZ4 block format, compatible with LZ4_compress_default and LZ4_decompress_safe. Used for packed assets, no frame
+// format or checksums
+namespace LZ4 {
+
+// Largest compressed size of size bytes
+size_t CompressBound(size_t size);
+
+// Returns the compressed size, or 0 if it does not fit in capacity
+size_t Compress(const std::byte *src, size_t size, std::byte *dst, size_t capacity);
+
+// Decompresses a whole block, returns false unless it decodes to exactly size bytes
+bool Decompress(const std::byte *src, size_t srcSize, std::byte *dst, size_t size);
+
+} // namespace LZ4
+
+#endif // LZ4_HPP
\ No newline at end of file
@@ -0,0 +1,199 @@
+#include "pack.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+#include "lz4.hpp"
+
+namespace Pack {
+
+namespace {
+
+void PutU32(std::vector<std::byte> &buf, u32 value) {
+	for (int i = 0; i < 4; i++)
+		buf.push_back(static_cast<std::byte>((value >> (i * 8)) & 0xFF));
+}
+
+void PutU64(std::vector<std::byte> &buf, u64 value) {
+	for (int i = 0; i < 8; i++)
+		buf.push_back(static_cast<std::byte>((value >> (i * 8)) & 0xFF));
+}
+
+void SetU64(std::vector<std::byte> &buf, size_t pos, u64 value) {
+	for (int i = 0; i < 8; i++)
+		buf[pos + i] = static_cast<std::byte>((value >> (i * 8)) & 0xFF);
+}
+
+u32 GetU32(const std::byte *p) {
+	u32 value = 0;
+	for (int i = 0; i < 4; i++)
+		value |= static_cast<u32>(p[i]) << (i * 8);
+	return value;
+}
+
+u64 GetU64(const std::byte *p) {
+	u64 value = 0;
+	for (int i = 0; i < 8; i++)
+		value |= static_cast<u64>(p[i]) << (i * 8);
+	return value;
+}
+
+void Align(std::vector<std::byte> &buf, u32 alignment) {
+	size_t padding = (alignment - buf.size() % alignment) % alignment;
+	buf.insert(buf.end(), padding, std::byte{0});
+}
+
+} // namespace
+
+bool Build(std::vector<Input> &inputs, std::vector<std::byte> &out, std::string &error, u32 alignment) {
+	if (alignment == 0 || (alignment & (alignment - 1)) != 0) {
+		error = "alignment must be a power of two";
+		return false;
+	}
+
+	std::sort(inputs.begin(), inputs.end(), [](const Input &a, const Input &b) { return a.path < b.path; });
+	for (size_t i = 1; i < inputs.size(); i++) {
+		if (inputs[i].path == inputs[i - 1].path) {
+			error = "duplicate path '" + inputs[i].path + "'";
+			return false;
+		}
+	}
+
+	// Compressed entries that do not shrink are stored as they are
+	std::vector<std::vector<std::byte>> compressed(inputs.size());
+	for (size_t i = 0; i < inputs.size(); i++) {
+		Input &input = inputs[i];
+		if (input.compression != Compression::LZ4)
+			continue;
+
+		std::vector<std::byte> &block = compressed[i];
+		block.resize(LZ4::CompressBound(input.data.size()));
+		size_t size = LZ4::Compress(input.data.data(), input.data.size(), block.data(), block.size());
+		if (size == 0 || size >= input.data.size()) {
+			input.compression = Compression::None;
+			block.clear();
+			continue;
+		}
+		block.resize(size);
+	}
+
+	std::string strings;
+	for (const Input &input : inputs)
+		strings += input.path;
+
+	out.clear();
+	out.insert(out.end(), reinterpret_cast<const std::byte *>(Magic), reinterpret_cast<const std::byte *>(Magic) + sizeof(Magic));
+	PutU32(out, Version);
+	PutU32(out, static_cast<u32>(inputs.size()));
+	PutU32(out, alignment);
+	PutU32(out, static_cast<u32>(strings.size()));
+	PutU32(out, 0);
+
+	// Offsets are patched once the data is placed
+	u32 nameOffset = 0;
+	std::vector<size_t> offsetFields(inputs.size());
+	for (size_t i = 0; i < inputs.size(); i++) {
+		const Input &input = inputs[i];
+		bool isCompressed = input.compression != Compression::None;
+
+		PutU32(out, nameOffset);
+		PutU32(out, static_cast<u32>(input.path.size()));
+		offsetFields[i] = out.size();
+		PutU64(out, 0);
+		PutU64(out, isCompressed ? compressed[i].size() : input.data.size());
+		PutU64(out, input.data.size());
+		PutU32(out, static_cast<u32>(input.compression));
+		PutU32(out, 0);
+		nameOffset += static_cast<u32>(input.path.size());
+	}
+	out.insert(out.end(), reinterpret_cast<const std::byte *>(strings.data()), reinterpret_cast<const std::byte *>(strings.data()) + strings.size());
+
+	for (size_t i = 0; i < inputs.size(); i++) {
+		const std::vector<std::byte> &data = inputs[i].compression != Compression::None ? compressed[i] : inputs[i].data;
+		Align(out, alignment);
+		SetU64(out, offsetFields[i], out.size());
+		out.insert(out.end(), data.begin(), data.end());
+	}
+	return true;
+}
+
+bool Reader::Open(const std::byte *data, size_t size) {
+	_data = data;
+	_size = size;
+	_error = "";
+	_entries.clear();
+
+	if (size < HeaderSize || std::memcmp(data, Magic, sizeof(Magic)) != 0)
+		return fail("not a pack file");
+	if (GetU32(data + 4) != Version)
+		return fail("unsupported pack version");
+
+	u32 count = GetU32(data + 8);
+	u32 stringsSize = GetU32(data + 16);
+	if ((size - HeaderSize) / EntrySize < count)
+		return fail("entry table out of bounds");
+
+	size_t strings = HeaderSize + static_cast<size_t>(count) * EntrySize;
+	if (size - strings < stringsSize)
+		return fail("string table out of bounds");
+
+	_entries.reserve(count);
+	for (u32 i = 0; i < count; i++) {
+		const std::byte *record = data + HeaderSize + static_cast<size_t>(i) * EntrySize;
+		u32 nameOffset = GetU32(record);
+		u32 nameLength = GetU32(record + 4);
+		if (nameOffset > stringsSize || stringsSize - nameOffset < nameLength)
+			return fail("entry path out of bounds");
+
+		Entry entry;
+		entry.path = std::string_view(reinterpret_cast<const char *>(data + strings + nameOffset), nameLength);
+		entry.offset = GetU64(record + 8);
+		entry.storedSize = GetU64(record + 16);
+		entry.size = GetU64(record + 24);
+		entry.compression = static_cast<Compression>(GetU32(record + 32));
+
+		if (entry.offset > size || size - entry.offset < entry.storedSize)
+			return fail("entry data out of bounds");
+		if (entry.compression == Compression::None && entry.storedSize != entry.size)
+			return fail("uncompressed entry size mismatch");
+		if (entry.compression != Compression::None && entry.compression != Compression::LZ4)
+			return fail("unknown entry compression");
+		// Lookups binary search the table
+		if (!_entries.empty() && !(_entries.back().path < entry.path))
+			return fail("entry table is not sorted");
+
+		_entries.push_back(entry);
+	}
+	return true;
+}
+
+size_t Reader::LowerBound(std::string_view path) const {
+	auto it = std::lower_bound(_entries.begin(), _entries.end(), path, [](const Entry &entry, std::string_view value) { return entry.path < value; });
+	return static_cast<size_t>(it - _entries.begin());
+}
+
+const Entry *Reader::Find(std::string_view path) const {
+	size_t index = LowerBound(path);
+	if (index < _entries.size() && _entries[index].path == path)
+		return &_entries[index];
+	return nullptr;
+}
+
+bool Reader::Extract(const Entry &entry, std::byte *out) const {
+	switch (entry.compression) {
+	case Compression::None:
+		std::memcpy(out, GetData(entry), entry.size);
+		return true;
+	case Compression::LZ4:
+		return LZ4::Decompress(GetData(entry), entry.storedSize, out, entry.size);
+	}
+	return false;
+}
+
+bool Reader::fail(const char *message) {
+	_error = message;
+	_entries.clear();
+	return false;
+}
+
+} // namespace Pack
\ No newline at end of file
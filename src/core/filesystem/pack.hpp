@@ -0,0 +1,78 @@
+#ifndef PACK_HPP
+#define PACK_HPP
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "sowa.hpp"
+
+// Packed asset archive (.spak). Layout, all integers little endian:
+//   Header        magic, version, entry count, data alignment, string table size
+//   Entry table   EntrySize bytes per entry, sorted by path
+//   String table  entry paths, '/' separated and relative to the packed folder
+//   Data          one block per entry, each starting on a multiple of the alignment
+namespace Pack {
+
+constexpr u8 Magic[4] = {'S', 'P', 'A', 'K'};
+constexpr u32 Version = 1;
+
+constexpr size_t HeaderSize = 24;
+constexpr size_t EntrySize = 40;
+constexpr u32 DefaultAlignment = 64;
+
+enum class Compression : u32 {
+	None = 0,
+	// LZ4 block, see core/filesystem/lz4.hpp
+	LZ4,
+};
+
+struct Entry {
+	std::string_view path;
+	u64 offset = 0;
+	// Size in the pack, equal to size when uncompressed
+	u64 storedSize = 0;
+	u64 size = 0;
+	Compression compression = Compression::None;
+};
+
+struct Input {
+	std::string path = "";
+	std::vector<std::byte> data;
+	Compression compression = Compression::None;
+};
+
+// Builds a pack from inputs. Entries whose compressed form is not smaller are stored uncompressed
+bool Build(std::vector<Input> &inputs, std::vector<std::byte> &out, std::string &error, u32 alignment = DefaultAlignment);
+
+// Reads the entry table in place, data must outlive the reader
+class Reader {
+  public:
+	bool Open(const std::byte *data, size_t size);
+	inline const std::string &GetError() const { return _error; }
+
+	inline const std::vector<Entry> &GetEntries() const { return _entries; }
+	const Entry *Find(std::string_view path) const;
+	// Index of the first entry whose path is not less than path
+	size_t LowerBound(std::string_view path) const;
+
+	// Stored bytes of the entry, compressed or not
+	inline const std::byte *GetData(const Entry &entry) const { return _data + entry.offset; }
+	// Decompresses the entry into out, which must hold entry.size bytes
+	bool Extract(const Entry &entry, std::byte *out) const;
+
+  private:
+	bool fail(const char *message);
+
+  private:
+	const std::byte *_data = nullptr;
+	size_t _size = 0;
+	std::string _error = "";
+	std::vector<Entry> _entries;
+};
+
+} // namespace Pack
+
+#endif // PACK_HPP
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "res_path.hpp"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+PathView SplitPath(std::string_view path) {
+	PathView view;
+	size_t separator = path.find("://");
+	if (separator == std::string_view::npos) {
+		view.scheme = path;
+		return view;
+	}
+
+	view.scheme = path.substr(0, separator);
+	view.path = path.substr(separator + 3);
+	size_t start = view.path.find_first_not_of('/');
+	view.path = start == std::string_view::npos ? std::string_view() : view.path.substr(start);
+	return view;
+}
+
+namespace {
+// Entries never move, the lookup keys point into them. The mutex guards entries and lookup, threads read through their
+// own copy of the lookup first and only take it for paths they have not seen yet
+struct PathTable {
+	std::mutex mutex;
+	std::deque<ResPathEntry> entries;
+	std::unordered_map<std::string_view, const ResPathEntry *> lookup;
+};
+
+PathTable &GetPathTable() {
+	static PathTable table;
+	return table;
+}
+
+// FNV-1a
+u64 HashPath(std::string_view path) {
+	u64 hash = 0xcbf29ce484222325ull;
+	for (char c : path) {
+		hash ^= static_cast<u8>(c);
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+} // namespace
+
+ResPath::ResPath(std::string_view path) {
+	PathView view = SplitPath(path);
+	while (!view.path.empty() && view.path.back() == '/')
+		view.path.remove_suffix(1);
+	if (view.scheme.empty() && view.path.empty())
+		return;
+
+	// A path already in normal form is its own key, others are rebuilt in a reused buffer
+	std::string_view key;
+	if (view.scheme.data() == path.data() && view.path.data() == path.data() + view.scheme.size() + 3 && view.path.size() == path.size() - view.scheme.size() - 3) {
+		key = path;
+	} else {
+		thread_local std::string buffer;
+		buffer.assign(view.scheme);
+		buffer += "://";
+		buffer += view.path;
+		key = buffer;
+	}
+
+	// Entries live until exit, so a thread can keep pointers to them without the lock
+	thread_local std::unordered_map<std::string_view, const ResPathEntry *> seen;
+	if (auto it = seen.find(key); it != seen.end()) {
+		_entry = it->second;
+		return;
+	}
+
+	PathTable &table = GetPathTable();
+	{
+		std::lock_guard<std::mutex> lock(table.mutex);
+		auto it = table.lookup.find(key);
+		if (it != table.lookup.end()) {
+			_entry = it->second;
+		} else {
+			ResPathEntry &entry = table.entries.emplace_back();
+			entry.full.assign(key);
+			entry.schemeSize = static_cast<u32>(view.scheme.size());
+			entry.id = static_cast<u32>(table.entries.size());
+			entry.hash = HashPath(key);
+			table.lookup.emplace(entry.full, &entry);
+			_entry = &entry;
+		}
+	}
+	seen.emplace(_entry->full, _entry);
+}
+
+const std::string &ResPath::String() const {
+	static const std::string empty;
+	return _entry ? _entry->full : empty;
+}
\ No newline at end of file
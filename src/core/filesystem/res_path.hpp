@@ -0,0 +1,61 @@
+#ifndef RES_PATH_HPP
+#define RES_PATH_HPP
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "sowa.hpp"
+
+// scheme://path split in place. A string without :// is all scheme, leading slashes of the path are skipped
+struct PathView {
+	std::string_view scheme;
+	std::string_view path;
+};
+
+PathView SplitPath(std::string_view path);
+
+struct ResPathEntry {
+	// scheme://path, without trailing slashes
+	std::string full;
+	u32 schemeSize = 0;
+	u32 id = 0;
+	u64 hash = 0;
+};
+
+// Interned scheme://path. Parsed and hashed once when first seen, after that a copy or comparison is a pointer and
+// looking up a path in normal form allocates nothing. Interned paths live until exit. Constructing one only locks the
+// shared table the first time a thread sees the path
+class ResPath {
+  public:
+	ResPath() = default;
+	ResPath(std::string_view path);
+	ResPath(const char *path) : ResPath(std::string_view(path)) {}
+	ResPath(const std::string &path) : ResPath(std::string_view(path)) {}
+	ResPath(const std::filesystem::path &path) : ResPath(std::string_view(path.native())) {}
+
+	inline bool Empty() const { return _entry == nullptr; }
+	inline std::string_view Scheme() const { return _entry ? std::string_view(_entry->full).substr(0, _entry->schemeSize) : std::string_view(); }
+	inline std::string_view Path() const { return _entry ? std::string_view(_entry->full).substr(_entry->schemeSize + 3) : std::string_view(); }
+	const std::string &String() const;
+	// Unique per path, 0 for the empty path
+	inline u32 ID() const { return _entry ? _entry->id : 0; }
+	inline u64 Hash() const { return _entry ? _entry->hash : 0; }
+
+	inline bool operator==(const ResPath &other) const { return _entry == other._entry; }
+	inline bool operator!=(const ResPath &other) const { return _entry != other._entry; }
+
+  private:
+	const ResPathEntry *_entry = nullptr;
+};
+
+namespace std {
+template <>
+struct hash<ResPath> {
+	inline size_t operator()(const ResPath &path) const { return static_cast<size_t>(path.Hash()); }
+};
+} // namespace std
+
+#endif // RES_PATH_HPP
\ No newline at end of file
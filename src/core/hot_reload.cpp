@@ -0,0 +1,107 @@
+#include "hot_reload.hpp"
+
+#include <algorithm>
+#include <chrono>
+
+#include "core/application.hpp"
+#include "core/debug.hpp"
+
+u32 HotReload::Watch(const ResPath &key, const std::string &kind, std::function<bool()> reload) {
+	std::filesystem::path diskPath = App().FS().GetDiskPath(key);
+	if (diskPath.empty() || !reload)
+		return 0;
+
+	i32 watch = _watcher.Watch(diskPath.parent_path(), WatchEvents_Writes);
+	if (watch < 0)
+		return 0;
+
+	std::string name = diskPath.filename().string();
+	_folders[watch].files[name] = key;
+
+	u32 id = _nextId++;
+	_handlers[key].push_back(Handler{id, kind, reload});
+	_paths[id] = WatchedPath{key, watch, name};
+	return id;
+}
+
+void HotReload::Unwatch(u32 id) {
+	auto path = _paths.find(id);
+	if (path == _paths.end())
+		return;
+
+	auto handlers = _handlers.find(path->second.key);
+	if (handlers != _handlers.end()) {
+		std::vector<Handler> &list = handlers->second;
+		list.erase(std::remove_if(list.begin(), list.end(), [id](const Handler &handler) { return handler.id == id; }), list.end());
+
+		if (list.empty()) {
+			_handlers.erase(handlers);
+
+			auto folder = _folders.find(path->second.watch);
+			if (folder != _folders.end()) {
+				folder->second.files.erase(path->second.name);
+				if (folder->second.files.empty()) {
+					_watcher.Unwatch(folder->first);
+					_folders.erase(folder);
+				}
+			}
+		}
+	}
+	_paths.erase(path);
+}
+
+void HotReload::Update() {
+	std::vector<DirectoryEvent> events;
+	bool complete = _watcher.Poll(events);
+
+	// Editors often write a file in several steps, each file is reloaded once per call
+	std::vector<ResPath> changed;
+	if (!complete) {
+		for (auto &[key, handlers] : _handlers)
+			changed.push_back(key);
+	}
+	for (const DirectoryEvent &event : events) {
+		auto folder = _folders.find(event.watch);
+		if (folder == _folders.end())
+			continue;
+
+		auto file = folder->second.files.find(event.name);
+		if (file != folder->second.files.end() && std::find(changed.begin(), changed.end(), file->second) == changed.end())
+			changed.push_back(file->second);
+	}
+
+	for (const ResPath &key : changed)
+		reload(key);
+}
+
+void HotReload::reload(const ResPath &key) {
+	auto it = _handlers.find(key);
+	if (it == _handlers.end())
+		return;
+
+	App().FS().InvalidateCache(key);
+
+	// Reloads may watch or unwatch paths, handlers removed by an earlier one are skipped
+	std::vector<Handler> handlers = it->second;
+	for (const Handler &handler : handlers) {
+		if (_paths.find(handler.id) == _paths.end())
+			continue;
+
+		auto start = std::chrono::steady_clock::now();
+		bool reloaded = handler.reload();
+		f64 ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+		HotReloadStats &stats = _stats[handler.kind];
+		if (!reloaded) {
+			stats.failures++;
+			Debug::Warn("Failed to reload {} '{}'", handler.kind, key.String());
+			continue;
+		}
+
+		stats.reloads++;
+		stats.lastMs = ms;
+		stats.maxMs = std::max(stats.maxMs, ms);
+		stats.totalMs += ms;
+		Debug::Info("Reloaded {} '{}' in {:.2f} ms", handler.kind, key.String(), ms);
+	}
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#ifndef HOT_RELOAD_HPP
+#define HOT_RELOAD_HPP
+#pragma once
+
+#include <filesystem>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sowa.hpp"
+
+#include "core/filesystem/directory_watcher.hpp"
+#include "core/filesystem/res_path.hpp"
+
+// Time from noticing a change to the end of its reload
+struct HotReloadStats {
+	u64 reloads = 0;
+	u64 failures = 0;
+	f64 lastMs = 0.0;
+	f64 maxMs = 0.0;
+	f64 totalMs = 0.0;
+
+	inline f64 AverageMs() const { return reloads > 0 ? totalMs / static_cast<f64>(reloads) : 0.0; }
+};
+
+// Reloads assets in place when their files change on disk. Paths are resolved through the file system and the folders
+// holding them watched with inotify. Files of servers without a folder on disk, such as packs, are never reported
+class HotReload {
+  public:
+	// reload runs on the main thread after the file changed and returns false if it could not be reloaded. kind groups
+	// reloads in GetStats. Returns an id for Unwatch, or 0 if the path can not be watched
+	u32 Watch(const ResPath &path, const std::string &kind, std::function<bool()> reload);
+	void Unwatch(u32 id);
+
+	// Reloads each file that changed since the last call once. Application::Update calls it once a frame
+	void Update();
+
+	inline const std::unordered_map<std::string, HotReloadStats> &GetStats() const { return _stats; }
+
+  private:
+	struct Handler {
+		u32 id = 0;
+		std::string kind;
+		std::function<bool()> reload;
+	};
+
+	struct WatchedFolder {
+		// File name to the path handlers are keyed by
+		std::unordered_map<std::string, ResPath> files;
+	};
+
+	struct WatchedPath {
+		ResPath key;
+		i32 watch = -1;
+		std::string name;
+	};
+
+	void reload(const ResPath &key);
+
+	DirectoryWatcher _watcher;
+	std::unordered_map<i32, WatchedFolder> _folders;
+	std::unordered_map<ResPath, std::vector<Handler>> _handlers;
+	std::unordered_map<u32, WatchedPath> _paths;
+	std::unordered_map<std::string, HotReloadStats> _stats;
+	u32 _nextId = 1;
+};
+
+#endif // HOT_RELOAD_HPP
\ No newline at end of file
@@ -5,8 +5,15 @@
 #include "sowa.hpp"
 #include <string>
 
+#include "filesystem/res_path.hpp"
 #include "serialize/document.hpp"
 
+// Bytes held by a resource. gpu counts memory owned by GL and AL objects, estimated from their formats and sizes
+struct ResourceMemory {
+	u64 cpu = 0;
+	u64 gpu = 0;
+};
+
 class Resource {
   public:
 	Resource();
@@ -15,18 +22,30 @@ class Resource {
 
 	inline RID GetRID() const { return _rid; }
 	inline std::size_t ResourceType() { return _resourceType; }
-	inline const std::string &Filepath() { return _filepath; }
+	inline const ResPath &Filepath() const { return _filepath; }
 
 	virtual void LoadResource(const Document &doc) {}
 	virtual void SaveResource(Document &doc) {}
 
+	// Resources with a decode phase load in two steps. DecodeResource reads and decodes files without touching GL or AL and
+	// may run on a worker thread, UploadResource then creates the GL/AL objects on the main thread
+	virtual bool HasDecodePhase() { return false; }
+	virtual void DecodeResource(const Document &doc) {}
+	virtual void UploadResource() {}
+
+	// Loads Filepath() again after it changed on disk, keeping the RID and, where possible, the GL/AL objects. Returns
+	// false if the resource can not be reloaded
+	virtual bool ReloadResource() { return false; }
+
+	virtual ResourceMemory GetMemoryUsage() const { return {}; }
+
   private:
 	friend class ResourceRegistry;
 	RID _rid = 0;
 
   protected:
 	std::size_t _resourceType = 0;
-	std::string _filepath = "";
+	ResPath _filepath;
 };
 
 #endif // RESOURCE_HPP
\ No newline at end of file
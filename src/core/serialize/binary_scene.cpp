@@ -0,0 +1,373 @@
+#include "binary_scene.hpp"
+
+#include <cstring>
+
+#include "core/serialize/document.hpp"
+
+namespace BinaryScene {
+
+namespace {
+
+void PutU8(std::vector<std::byte> &buf, u8 value) {
+	buf.push_back(static_cast<std::byte>(value));
+}
+
+void PutU32(std::vector<std::byte> &buf, u32 value) {
+	for (int i = 0; i < 4; i++)
+		buf.push_back(static_cast<std::byte>((value >> (i * 8)) & 0xFF));
+}
+
+void PutU64(std::vector<std::byte> &buf, u64 value) {
+	for (int i = 0; i < 8; i++)
+		buf.push_back(static_cast<std::byte>((value >> (i * 8)) & 0xFF));
+}
+
+void SetU32(std::vector<std::byte> &buf, size_t pos, u32 value) {
+	for (int i = 0; i < 4; i++)
+		buf[pos + i] = static_cast<std::byte>((value >> (i * 8)) & 0xFF);
+}
+
+u32 GetU32(const std::byte *p) {
+	u32 value = 0;
+	for (int i = 0; i < 4; i++)
+		value |= static_cast<u32>(p[i]) << (i * 8);
+	return value;
+}
+
+u64 GetU64(const std::byte *p) {
+	u64 value = 0;
+	for (int i = 0; i < 8; i++)
+		value |= static_cast<u64>(p[i]) << (i * 8);
+	return value;
+}
+
+// Binary Document of a map's entries, leaving out the skip key. Scalars keep their text, the typed getters read it
+// as the type asked for
+std::vector<std::byte> EncodeMap(const YAML::Node &node, const char *skip) {
+	YAML::Node props(YAML::NodeType::Map);
+	if (node && node.IsMap()) {
+		for (YAML::const_iterator it = node.begin(); it != node.end(); ++it) {
+			if (!skip || it->first.Scalar() != skip)
+				props[it->first] = it->second;
+		}
+	}
+	return Document(props).ToBinary();
+}
+
+} // namespace
+
+bool IsBinaryScene(const std::byte *data, size_t size) {
+	return data && size >= HeaderSize && std::memcmp(data, Magic, sizeof(Magic)) == 0;
+}
+
+bool Encode(const YAML::Node &doc, std::vector<std::byte> &out, std::string &error) {
+	Writer writer;
+
+	// Flatten the node tree in preorder so every parent precedes its children
+	std::vector<std::pair<YAML::Node, u32>> stack;
+	if (doc["Root"] && doc["Root"].IsMap())
+		stack.emplace_back(doc["Root"], NoParent);
+
+	while (!stack.empty()) {
+		auto [node, parent] = stack.back();
+		stack.pop_back();
+
+		u32 index = writer.AddNode(node["ID"].as<NodeID>(0), node["Type"].as<std::string>("Node"), node["Name"].as<std::string>("New Node"),
+								   parent, EncodeMap(node, "Children"));
+
+		YAML::Node children = node["Children"];
+		if (children && children.IsSequence()) {
+			for (size_t i = children.size(); i > 0; i--) {
+				if (children[i - 1].IsMap())
+					stack.emplace_back(children[i - 1], index);
+			}
+		}
+	}
+
+	YAML::Node resources = doc["Resources"];
+	if (resources.IsMap()) {
+		for (YAML::const_iterator it = resources.begin(); it != resources.end(); ++it) {
+			writer.AddResource(it->first.as<RID>(0), it->second["Type"].as<std::string>(""), EncodeMap(it->second, nullptr));
+		}
+	}
+
+	writer.SetSceneProperties(EncodeMap(doc["Scene"], nullptr));
+	return writer.Finish(out, error);
+}
+
+bool Decode(const std::byte *data, size_t size, YAML::Node &out, std::string &error) {
+	Reader reader;
+	if (!reader.Open(data, size)) {
+		error = reader.GetError();
+		return false;
+	}
+
+	out = YAML::Node(YAML::NodeType::Map);
+
+	Document props;
+	if (!reader.ReadProperties(reader.GetSceneProperties(), props)) {
+		error = reader.GetError();
+		return false;
+	}
+	out["Scene"] = props.ToYAML();
+
+	YAML::Node resources(YAML::NodeType::Map);
+	for (u32 i = 0; i < reader.GetResourceCount(); i++) {
+		ResourceRecord record = reader.GetResource(i);
+		if (!reader.ReadProperties(record.properties, props)) {
+			error = reader.GetError();
+			return false;
+		}
+
+		YAML::Node res = props.ToYAML();
+		res["Type"] = std::string(reader.GetString(record.type));
+		resources[record.rid] = res;
+	}
+	out["Resources"] = resources;
+
+	// yaml-cpp nodes are references, so children appended later still show up under the root
+	std::vector<YAML::Node> nodes(reader.GetNodeCount());
+	for (u32 i = 0; i < reader.GetNodeCount(); i++) {
+		NodeRecord record = reader.GetNode(i);
+		if (!reader.ReadProperties(record.properties, props)) {
+			error = reader.GetError();
+			return false;
+		}
+
+		YAML::Node &node = nodes[i];
+		node = props.ToYAML();
+		node["Type"] = std::string(reader.GetTypeName(record.type));
+		node["Name"] = std::string(reader.GetString(record.name));
+		node["ID"] = record.id;
+
+		if (record.parent != NoParent)
+			nodes[record.parent]["Children"].push_back(node);
+	}
+	if (!nodes.empty())
+		out["Root"] = nodes[0];
+
+	return true;
+}
+
+u32 Writer::intern(const std::string &str) {
+	auto [it, inserted] = _stringIndex.try_emplace(str, static_cast<u32>(_strings.size()));
+	if (inserted)
+		_strings.push_back(&it->first);
+	return it->second;
+}
+
+u32 Writer::addBlock(const std::vector<std::byte> &properties) {
+	u32 offset = static_cast<u32>(_blob.size());
+	PutU32(_blob, static_cast<u32>(properties.size()));
+	_blob.insert(_blob.end(), properties.begin(), properties.end());
+	return offset;
+}
+
+u32 Writer::AddNode(NodeID id, const std::string &type, const std::string &name, u32 parent, const std::vector<std::byte> &properties) {
+	auto [it, inserted] = _typeIndex.try_emplace(type, static_cast<u32>(_types.size()));
+	if (inserted)
+		_types.push_back(intern(type));
+
+	NodeRecord record;
+	record.id = id;
+	record.type = it->second;
+	record.name = intern(name);
+	record.parent = parent;
+	record.properties = addBlock(properties);
+	_nodes.push_back(record);
+	return static_cast<u32>(_nodes.size() - 1);
+}
+
+void Writer::AddResource(RID rid, const std::string &type, const std::vector<std::byte> &properties) {
+	ResourceRecord record;
+	record.rid = rid;
+	record.type = intern(type);
+	record.properties = addBlock(properties);
+	_resources.push_back(record);
+}
+
+void Writer::SetSceneProperties(const std::vector<std::byte> &properties) {
+	_sceneProperties = addBlock(properties);
+	_hasSceneProperties = true;
+}
+
+bool Writer::Finish(std::vector<std::byte> &out, std::string &error) {
+	if (!_hasSceneProperties)
+		SetSceneProperties({});
+
+	out.clear();
+	out.reserve(HeaderSize + _strings.size() * 16 + _nodes.size() * NodeRecordSize + _blob.size());
+	out.resize(HeaderSize);
+	std::memcpy(out.data(), Magic, sizeof(Magic));
+	SetU32(out, 4, Version);
+
+	SetU32(out, 8, static_cast<u32>(_strings.size()));
+	SetU32(out, 12, static_cast<u32>(out.size()));
+	u32 stringOffset = 0;
+	for (const std::string *str : _strings) {
+		PutU32(out, stringOffset);
+		PutU32(out, static_cast<u32>(str->size()));
+		stringOffset += static_cast<u32>(str->size());
+	}
+	for (const std::string *str : _strings) {
+		const std::byte *chars = reinterpret_cast<const std::byte *>(str->data());
+		out.insert(out.end(), chars, chars + str->size());
+	}
+
+	while (out.size() % 8 != 0)
+		PutU8(out, 0);
+
+	SetU32(out, 16, static_cast<u32>(_types.size()));
+	SetU32(out, 20, static_cast<u32>(out.size()));
+	for (u32 type : _types)
+		PutU32(out, type);
+
+	while (out.size() % 8 != 0)
+		PutU8(out, 0);
+
+	SetU32(out, 24, static_cast<u32>(_nodes.size()));
+	SetU32(out, 28, static_cast<u32>(out.size()));
+	for (const NodeRecord &node : _nodes) {
+		PutU64(out, node.id);
+		PutU32(out, node.type);
+		PutU32(out, node.name);
+		PutU32(out, node.parent);
+		PutU32(out, node.properties);
+	}
+
+	SetU32(out, 32, static_cast<u32>(_resources.size()));
+	SetU32(out, 36, static_cast<u32>(out.size()));
+	for (const ResourceRecord &res : _resources) {
+		PutU32(out, static_cast<u32>(res.rid));
+		PutU32(out, res.type);
+		PutU32(out, res.properties);
+	}
+
+	SetU32(out, 40, static_cast<u32>(out.size()));
+	SetU32(out, 44, static_cast<u32>(_blob.size()));
+	SetU32(out, 48, _sceneProperties);
+	out.insert(out.end(), _blob.begin(), _blob.end());
+
+	if (out.size() > 0xFFFFFFFF) {
+		error = "scene is too large";
+		return false;
+	}
+	return true;
+}
+
+bool Reader::fail(const char *message) {
+	_error = message;
+	return false;
+}
+
+bool Reader::Open(const std::byte *data, size_t size) {
+	_data = data;
+	_size = size;
+	_error = "";
+
+	if (!IsBinaryScene(data, size))
+		return fail("not a binary scene");
+	if (GetU32(data + 4) != Version)
+		return fail("unsupported binary scene version");
+
+	_stringCount = GetU32(data + 8);
+	_strings = GetU32(data + 12);
+	_typeCount = GetU32(data + 16);
+	_types = GetU32(data + 20);
+	_nodeCount = GetU32(data + 24);
+	_nodes = GetU32(data + 28);
+	_resourceCount = GetU32(data + 32);
+	_resources = GetU32(data + 36);
+	_properties = GetU32(data + 40);
+	_propertiesSize = GetU32(data + 44);
+	_sceneProperties = GetU32(data + 48);
+
+	auto fits = [size](size_t offset, size_t count, size_t stride) {
+		return offset <= size && count <= (size - offset) / stride;
+	};
+	if (!fits(_strings, _stringCount, 8) || !fits(_types, _typeCount, 4) || !fits(_nodes, _nodeCount, NodeRecordSize) ||
+		!fits(_resources, _resourceCount, ResourceRecordSize) || !fits(_properties, _propertiesSize, 1))
+		return fail("binary scene table out of bounds");
+
+	// Validate the tables once so lookups can skip bounds checks afterwards
+	_stringData = _strings + static_cast<size_t>(_stringCount) * 8;
+	for (u32 i = 0; i < _stringCount; i++) {
+		const std::byte *entry = _data + _strings + i * 8;
+		size_t offset = _stringData + GetU32(entry);
+		if (!fits(offset, GetU32(entry + 4), 1))
+			return fail("binary scene string out of bounds");
+	}
+
+	for (u32 i = 0; i < _typeCount; i++) {
+		if (GetU32(_data + _types + i * 4) >= _stringCount)
+			return fail("binary scene type name out of bounds");
+	}
+
+	for (u32 i = 0; i < _nodeCount; i++) {
+		NodeRecord node = GetNode(i);
+		if (node.type >= _typeCount || node.name >= _stringCount)
+			return fail("binary scene node references missing type or name");
+		if ((i == 0) != (node.parent == NoParent) || (node.parent != NoParent && node.parent >= i))
+			return fail("binary scene node has invalid parent");
+	}
+
+	for (u32 i = 0; i < _resourceCount; i++) {
+		if (GetResource(i).type >= _stringCount)
+			return fail("binary scene resource references missing type");
+	}
+
+	return true;
+}
+
+std::string_view Reader::GetString(u32 index) const {
+	if (index >= _stringCount)
+		return std::string_view();
+
+	const std::byte *entry = _data + _strings + static_cast<size_t>(index) * 8;
+	const char *chars = reinterpret_cast<const char *>(_data + _stringData + GetU32(entry));
+	return std::string_view(chars, GetU32(entry + 4));
+}
+
+std::string_view Reader::GetTypeName(u32 index) const {
+	if (index >= _typeCount)
+		return std::string_view();
+	return GetString(GetU32(_data + _types + static_cast<size_t>(index) * 4));
+}
+
+NodeRecord Reader::GetNode(u32 index) const {
+	const std::byte *p = _data + _nodes + static_cast<size_t>(index) * NodeRecordSize;
+
+	NodeRecord record;
+	record.id = GetU64(p);
+	record.type = GetU32(p + 8);
+	record.name = GetU32(p + 12);
+	record.parent = GetU32(p + 16);
+	record.properties = GetU32(p + 20);
+	return record;
+}
+
+ResourceRecord Reader::GetResource(u32 index) const {
+	const std::byte *p = _data + _resources + static_cast<size_t>(index) * ResourceRecordSize;
+
+	ResourceRecord record;
+	record.rid = static_cast<RID>(GetU32(p));
+	record.type = GetU32(p + 4);
+	record.properties = GetU32(p + 8);
+	return record;
+}
+
+bool Reader::ReadProperties(u32 offset, Document &out) {
+	if (offset > _propertiesSize || 4 > _propertiesSize - offset)
+		return fail("binary scene property out of bounds");
+
+	const std::byte *block = _data + _properties + offset;
+	u32 size = GetU32(block);
+	if (size > _propertiesSize - offset - 4)
+		return fail("binary scene property out of bounds");
+
+	if (!out.LoadBinary(block + 4, size))
+		return fail("binary scene property is malformed");
+	return true;
+}
+
+} // namespace BinaryScene
\ No newline at end of file
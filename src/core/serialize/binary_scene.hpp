@@ -0,0 +1,141 @@
+#ifndef BINARY_SCENE_HPP
+#define BINARY_SCENE_HPP
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "yaml-cpp/yaml.h"
+
+#include "sowa.hpp"
+
+class Document;
+
+// Binary scene format (.sscnb). Layout, all integers little endian:
+//   Header
+//   String table   u32 offset, u32 length per string, then the characters
+//   Type table     u32 string index per node type
+//   Node array     NodeRecord per node, parents always come before their children
+//   Resource array ResourceRecord per resource
+//   Property blob  u32 size then a binary Document (see Document::ToBinary) per block, NodeRecord/ResourceRecord/Header
+//                  point into it
+namespace BinaryScene {
+
+constexpr u8 Magic[4] = {'S', 'S', 'C', 'B'};
+constexpr u32 Version = 2;
+
+constexpr size_t HeaderSize = 52;
+constexpr size_t NodeRecordSize = 24;
+constexpr size_t ResourceRecordSize = 12;
+
+constexpr u32 NoParent = 0xFFFFFFFF;
+
+struct NodeRecord {
+	NodeID id = 0;
+	u32 type = 0;
+	u32 name = 0;
+	u32 parent = NoParent;
+	u32 properties = 0;
+};
+
+struct ResourceRecord {
+	RID rid = 0;
+	u32 type = 0;
+	u32 properties = 0;
+};
+
+// Returns true if data starts with the binary scene magic
+bool IsBinaryScene(const std::byte *data, size_t size);
+
+// Encodes a scene document in the layout Scene::SaveToFile writes (Scene, Resources and Root keys). Values keep their
+// YAML form, see Document::Convert
+bool Encode(const YAML::Node &doc, std::vector<std::byte> &out, std::string &error);
+
+// Decodes a binary scene back into the document layout Encode takes
+bool Decode(const std::byte *data, size_t size, YAML::Node &out, std::string &error);
+
+// Lays out a scene from encoded binary Documents, Scene::SaveToFile passes the ones it cached
+class Writer {
+  public:
+	// Adds a node and returns its index. parent is the index of an earlier node, NoParent for the root
+	u32 AddNode(NodeID id, const std::string &type, const std::string &name, u32 parent, const std::vector<std::byte> &properties);
+	void AddResource(RID rid, const std::string &type, const std::vector<std::byte> &properties);
+	void SetSceneProperties(const std::vector<std::byte> &properties);
+
+	bool Finish(std::vector<std::byte> &out, std::string &error);
+
+  private:
+	u32 intern(const std::string &str);
+	// Appends a property block, returns its offset in the blob
+	u32 addBlock(const std::vector<std::byte> &properties);
+
+  private:
+	std::unordered_map<std::string, u32> _stringIndex;
+	std::vector<const std::string *> _strings;
+
+	std::unordered_map<std::string, u32> _typeIndex;
+	std::vector<u32> _types;
+
+	std::vector<NodeRecord> _nodes;
+	std::vector<ResourceRecord> _resources;
+
+	std::vector<std::byte> _blob;
+	u32 _sceneProperties = 0;
+	bool _hasSceneProperties = false;
+};
+
+// Reads tables in place, data must outlive the reader
+class Reader {
+  public:
+	bool Open(const std::byte *data, size_t size);
+	inline const std::string &GetError() const { return _error; }
+
+	inline u32 GetStringCount() const { return _stringCount; }
+	std::string_view GetString(u32 index) const;
+
+	inline u32 GetTypeCount() const { return _typeCount; }
+	std::string_view GetTypeName(u32 index) const;
+
+	inline u32 GetNodeCount() const { return _nodeCount; }
+	NodeRecord GetNode(u32 index) const;
+
+	inline u32 GetResourceCount() const { return _resourceCount; }
+	ResourceRecord GetResource(u32 index) const;
+
+	inline u32 GetSceneProperties() const { return _sceneProperties; }
+
+	// Loads the property block at offset into out as a binary Document
+	bool ReadProperties(u32 offset, Document &out);
+
+  private:
+	bool fail(const char *message);
+
+  private:
+	const std::byte *_data = nullptr;
+	size_t _size = 0;
+	std::string _error = "";
+
+	u32 _stringCount = 0;
+	size_t _strings = 0;
+	size_t _stringData = 0;
+
+	u32 _typeCount = 0;
+	size_t _types = 0;
+
+	u32 _nodeCount = 0;
+	size_t _nodes = 0;
+
+	u32 _resourceCount = 0;
+	size_t _resources = 0;
+
+	size_t _properties = 0;
+	size_t _propertiesSize = 0;
+	u32 _sceneProperties = 0;
+};
+
+} // namespace BinaryScene
+
+#endif // BINARY_SCENE_HPP
\ No newline at end of file
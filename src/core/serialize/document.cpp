@@ -0,0 +1,872 @@
+#include "document.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+// Deeper values are rejected instead of risking the stack on malformed input
+constexpr u32 MaxDepth = 64;
+
+template <typename T>
+bool DecodeYAML(const YAML::Node &value, T &out) {
+	if (!value.IsDefined())
+		return false;
+
+	T decoded;
+	if (!YAML::convert<T>::decode(value, decoded))
+		return false;
+	out = std::move(decoded);
+	return true;
+}
+
+// Scalar holding str that stays a string when emitted, whatever the text looks like
+YAML::Node StringNode(std::string str) {
+	YAML::Node node(std::move(str));
+	node.SetTag("!");
+	return node;
+}
+
+// True if the plain form of str reads back as a bool or a number
+bool ReadsAsOtherType(const std::string &str) {
+	YAML::Node plain(str);
+	bool boolean = false;
+	double number = 0.0;
+	return YAML::convert<bool>::decode(plain, boolean) || YAML::convert<double>::decode(plain, number);
+}
+
+bool DecodeVec2(const YAML::Node &value, Vector2 &out) {
+	if (!value.IsMap())
+		return false;
+
+	out.x = value["x"].as<f32>(out.x);
+	out.y = value["y"].as<f32>(out.y);
+	return true;
+}
+
+bool DecodeColor(const YAML::Node &value, Color &out) {
+	if (!value.IsMap())
+		return false;
+
+	out.r = value["r"].as<f32>(out.r);
+	out.g = value["g"].as<f32>(out.g);
+	out.b = value["b"].as<f32>(out.b);
+	out.a = value["a"].as<f32>(out.a);
+	return true;
+}
+
+class YAMLValue : public DocumentValue {
+  public:
+	YAMLValue(YAML::Node node) : _node(node) {}
+
+	bool GetBool(bool &out) const override { return DecodeYAML(_node, out); }
+	bool GetInt(i64 &out) const override { return DecodeYAML(_node, out); }
+	bool GetU64(u64 &out) const override { return DecodeYAML(_node, out); }
+	bool GetFloat(f32 &out) const override { return DecodeYAML(_node, out); }
+	bool GetString(std::string &out) const override { return DecodeYAML(_node, out); }
+	bool GetVec2(Vector2 &out) const override { return DecodeVec2(_node, out); }
+	bool GetColor(Color &out) const override { return DecodeColor(_node, out); }
+	bool GetStringList(std::vector<std::string> &out) const override { return DecodeYAML(_node, out); }
+
+  private:
+	YAML::Node _node;
+};
+
+class YAMLBackend : public DocumentBackend {
+  public:
+	YAMLBackend() = default;
+	YAMLBackend(YAML::Node node) : _node(node) {}
+
+	DocumentFormat Format() const override { return DocumentFormat::YAML; }
+	std::unique_ptr<DocumentBackend> Clone() const override { return std::make_unique<YAMLBackend>(_node); }
+
+	void SetBool(const char *name, bool value) override { _node[name] = value; }
+	void SetInt(const char *name, i64 value) override { _node[name] = value; }
+	void SetU64(const char *name, u64 value) override { _node[name] = value; }
+	void SetFloat(const char *name, f32 value) override { _node[name] = value; }
+	void SetString(const char *name, std::string_view value) override { _node[name] = StringNode(std::string(value)); }
+	void SetVec2(const char *name, const Vector2 &value) override {
+		_node[name]["x"] = value.x;
+		_node[name]["y"] = value.y;
+	}
+	void SetColor(const char *name, const Color &value) override {
+		_node[name]["r"] = value.r;
+		_node[name]["g"] = value.g;
+		_node[name]["b"] = value.b;
+		_node[name]["a"] = value.a;
+	}
+	void SetStringList(const char *name, const std::vector<std::string> &value) override {
+		YAML::Node list(YAML::NodeType::Sequence);
+		for (const std::string &str : value) {
+			list.push_back(StringNode(str));
+		}
+		_node[name] = list;
+	}
+	void SetDocument(const char *name, const Document &doc) override { _node[name] = doc.ToYAML(); }
+	void SetValue(const char *name, const YAML::Node &value) override { _node[name] = value; }
+
+	bool Has(const char *name) const override { return get(name).IsDefined(); }
+	bool GetBool(const char *name, bool &out) const override { return DecodeYAML(get(name), out); }
+	bool GetInt(const char *name, i64 &out) const override { return DecodeYAML(get(name), out); }
+	bool GetU64(const char *name, u64 &out) const override { return DecodeYAML(get(name), out); }
+	bool GetFloat(const char *name, f32 &out) const override { return DecodeYAML(get(name), out); }
+	bool GetString(const char *name, std::string &out) const override { return DecodeYAML(get(name), out); }
+	bool GetVec2(const char *name, Vector2 &out) const override { return DecodeVec2(get(name), out); }
+	bool GetColor(const char *name, Color &out) const override { return DecodeColor(get(name), out); }
+	bool GetStringList(const char *name, std::vector<std::string> &out) const override { return DecodeYAML(get(name), out); }
+	bool GetDocument(const char *name, Document &out) const override {
+		YAML::Node value = get(name);
+		if (!value.IsDefined())
+			return false;
+		out = Document(value);
+		return true;
+	}
+	bool GetValue(const char *name, YAML::Node &out) const override {
+		YAML::Node value = get(name);
+		if (!value.IsDefined())
+			return false;
+		out.reset(value);
+		return true;
+	}
+
+	void ForEachKey(const std::function<void(std::string_view name)> &visit) const override {
+		if (!_node.IsMap())
+			return;
+
+		for (YAML::const_iterator it = _node.begin(); it != _node.end(); ++it) {
+			visit(it->first.Scalar());
+		}
+	}
+
+	void ForEachValue(const std::function<void(std::string_view name, const DocumentValue &value)> &visit) const override {
+		if (!_node.IsMap())
+			return;
+
+		for (YAML::const_iterator it = _node.begin(); it != _node.end(); ++it) {
+			YAMLValue value(it->second);
+			visit(it->first.Scalar(), value);
+		}
+	}
+
+	YAML::Node ToYAML() const override { return _node; }
+
+  private:
+	// Const lookups so a missing key is not added to the map
+	YAML::Node get(const char *name) const {
+		const YAML::Node &node = _node;
+		return node[name];
+	}
+
+  private:
+	YAML::Node _node;
+};
+
+// Entries follow each other in one buffer: u8 tag, u16 key length, the key, then the payload. Numbers are little
+// endian. Variable sized payloads start with their u32 size
+enum class EntryTag : u8 {
+	Bool = 0,
+	Int,
+	U64,
+	Float,
+	String,
+	Vec2,
+	Color,
+	StringList,
+	Document,
+	// A YAML value tree, see PutValue
+	Value,
+};
+
+enum class ValueKind : u8 {
+	Null = 0,
+	Scalar,
+	Sequence,
+	Map,
+	// Scalar tagged "!", it stays a string whatever its text looks like
+	String,
+};
+
+void PutU8(std::vector<std::byte> &buf, u8 value) {
+	buf.push_back(static_cast<std::byte>(value));
+}
+
+void PutU16(std::vector<std::byte> &buf, u16 value) {
+	for (int i = 0; i < 2; i++)
+		buf.push_back(static_cast<std::byte>((value >> (i * 8)) & 0xFF));
+}
+
+void PutU32(std::vector<std::byte> &buf, u32 value) {
+	for (int i = 0; i < 4; i++)
+		buf.push_back(static_cast<std::byte>((value >> (i * 8)) & 0xFF));
+}
+
+void PutU64(std::vector<std::byte> &buf, u64 value) {
+	for (int i = 0; i < 8; i++)
+		buf.push_back(static_cast<std::byte>((value >> (i * 8)) & 0xFF));
+}
+
+void PutF32(std::vector<std::byte> &buf, f32 value) {
+	u32 bits = 0;
+	std::memcpy(&bits, &value, sizeof(bits));
+	PutU32(buf, bits);
+}
+
+void PutBytes(std::vector<std::byte> &buf, const void *data, size_t size) {
+	const std::byte *bytes = static_cast<const std::byte *>(data);
+	buf.insert(buf.end(), bytes, bytes + size);
+}
+
+void SetU32(std::vector<std::byte> &buf, size_t pos, u32 value) {
+	for (int i = 0; i < 4; i++)
+		buf[pos + i] = static_cast<std::byte>((value >> (i * 8)) & 0xFF);
+}
+
+u16 GetU16(const std::byte *p) {
+	return static_cast<u16>(static_cast<u16>(p[0]) | static_cast<u16>(p[1]) << 8);
+}
+
+u32 GetU32(const std::byte *p) {
+	u32 value = 0;
+	for (int i = 0; i < 4; i++)
+		value |= static_cast<u32>(p[i]) << (i * 8);
+	return value;
+}
+
+u64 GetU64(const std::byte *p) {
+	u64 value = 0;
+	for (int i = 0; i < 8; i++)
+		value |= static_cast<u64>(p[i]) << (i * 8);
+	return value;
+}
+
+f32 GetF32(const std::byte *p) {
+	u32 bits = GetU32(p);
+	f32 value = 0.f;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+void PutValue(std::vector<std::byte> &buf, const YAML::Node &value) {
+	switch (value.Type()) {
+	case YAML::NodeType::Scalar:
+		PutU8(buf, static_cast<u8>(value.Tag() == "!" ? ValueKind::String : ValueKind::Scalar));
+		PutU32(buf, static_cast<u32>(value.Scalar().size()));
+		PutBytes(buf, value.Scalar().data(), value.Scalar().size());
+		break;
+	case YAML::NodeType::Sequence:
+		PutU8(buf, static_cast<u8>(ValueKind::Sequence));
+		PutU32(buf, static_cast<u32>(value.size()));
+		for (YAML::const_iterator it = value.begin(); it != value.end(); ++it) {
+			PutValue(buf, *it);
+		}
+		break;
+	case YAML::NodeType::Map:
+		PutU8(buf, static_cast<u8>(ValueKind::Map));
+		PutU32(buf, static_cast<u32>(value.size()));
+		for (YAML::const_iterator it = value.begin(); it != value.end(); ++it) {
+			PutValue(buf, it->first);
+			PutValue(buf, it->second);
+		}
+		break;
+	default:
+		PutU8(buf, static_cast<u8>(ValueKind::Null));
+		break;
+	}
+}
+
+// Reads a value tree written by PutValue, returns false if it runs past end
+bool ReadValue(const std::byte *&p, const std::byte *end, YAML::Node &out, u32 depth) {
+	if (depth > MaxDepth || p >= end)
+		return false;
+
+	ValueKind kind = static_cast<ValueKind>(*p++);
+	switch (kind) {
+	case ValueKind::Null:
+		out.reset(YAML::Node(YAML::NodeType::Null));
+		return true;
+
+	case ValueKind::Scalar:
+	case ValueKind::String: {
+		if (end - p < 4)
+			return false;
+		u32 size = GetU32(p);
+		p += 4;
+		if (static_cast<size_t>(end - p) < size)
+			return false;
+		std::string str(reinterpret_cast<const char *>(p), size);
+		out.reset(kind == ValueKind::String ? StringNode(std::move(str)) : YAML::Node(std::move(str)));
+		p += size;
+		return true;
+	}
+
+	case ValueKind::Sequence:
+	case ValueKind::Map: {
+		if (end - p < 4)
+			return false;
+		u32 count = GetU32(p);
+		p += 4;
+
+		out.reset(YAML::Node(kind == ValueKind::Map ? YAML::NodeType::Map : YAML::NodeType::Sequence));
+		for (u32 i = 0; i < count; i++) {
+			YAML::Node item;
+			if (!ReadValue(p, end, item, depth + 1))
+				return false;
+
+			if (kind == ValueKind::Sequence) {
+				out.push_back(item);
+				continue;
+			}
+
+			YAML::Node value;
+			if (!ReadValue(p, end, value, depth + 1))
+				return false;
+			out[item] = value;
+		}
+		return true;
+	}
+	}
+	return false;
+}
+
+class BinaryBackend : public DocumentBackend {
+  public:
+	DocumentFormat Format() const override { return DocumentFormat::Binary; }
+	std::unique_ptr<DocumentBackend> Clone() const override { return std::make_unique<BinaryBackend>(*this); }
+
+	void SetBool(const char *name, bool value) override {
+		begin(name, EntryTag::Bool);
+		PutU8(_data, value ? 1 : 0);
+		end();
+	}
+	void SetInt(const char *name, i64 value) override {
+		begin(name, EntryTag::Int);
+		PutU64(_data, static_cast<u64>(value));
+		end();
+	}
+	void SetU64(const char *name, u64 value) override {
+		begin(name, EntryTag::U64);
+		PutU64(_data, value);
+		end();
+	}
+	void SetFloat(const char *name, f32 value) override {
+		begin(name, EntryTag::Float);
+		PutF32(_data, value);
+		end();
+	}
+	void SetString(const char *name, std::string_view value) override {
+		begin(name, EntryTag::String);
+		PutBytes(_data, value.data(), value.size());
+		end();
+	}
+	void SetVec2(const char *name, const Vector2 &value) override {
+		begin(name, EntryTag::Vec2);
+		PutF32(_data, value.x);
+		PutF32(_data, value.y);
+		end();
+	}
+	void SetColor(const char *name, const Color &value) override {
+		begin(name, EntryTag::Color);
+		PutF32(_data, value.r);
+		PutF32(_data, value.g);
+		PutF32(_data, value.b);
+		PutF32(_data, value.a);
+		end();
+	}
+	void SetStringList(const char *name, const std::vector<std::string> &value) override {
+		begin(name, EntryTag::StringList);
+		PutU32(_data, static_cast<u32>(value.size()));
+		for (const std::string &str : value) {
+			PutU32(_data, static_cast<u32>(str.size()));
+			PutBytes(_data, str.data(), str.size());
+		}
+		end();
+	}
+	void SetDocument(const char *name, const Document &doc) override {
+		std::vector<std::byte> bytes = doc.ToBinary();
+		begin(name, EntryTag::Document);
+		PutBytes(_data, bytes.data(), bytes.size());
+		end();
+	}
+	void SetValue(const char *name, const YAML::Node &value) override {
+		begin(name, EntryTag::Value);
+		PutValue(_data, value);
+		end();
+	}
+
+	bool Has(const char *name) const override { return find(name) != nullptr; }
+
+	bool GetBool(const char *name, bool &out) const override { return getBool(find(name), out); }
+	bool GetInt(const char *name, i64 &out) const override { return getInt(find(name), out); }
+	bool GetU64(const char *name, u64 &out) const override { return getU64(find(name), out); }
+	bool GetFloat(const char *name, f32 &out) const override { return getFloat(find(name), out); }
+	bool GetString(const char *name, std::string &out) const override { return getString(find(name), out); }
+	bool GetVec2(const char *name, Vector2 &out) const override { return getVec2(find(name), out); }
+	bool GetColor(const char *name, Color &out) const override { return getColor(find(name), out); }
+	bool GetStringList(const char *name, std::vector<std::string> &out) const override { return getStringList(find(name), out); }
+	bool GetDocument(const char *name, Document &out) const override {
+		const Entry *entry = find(name);
+		if (entry && entry->tag == EntryTag::Document)
+			return out.LoadBinary(&_data[entry->value], entry->size);
+		if (entry && entry->tag == EntryTag::Value) {
+			out = Document(toYAML(*entry));
+			return true;
+		}
+		return false;
+	}
+	bool GetValue(const char *name, YAML::Node &out) const override {
+		const Entry *entry = find(name);
+		if (!entry)
+			return false;
+		out.reset(toYAML(*entry));
+		return true;
+	}
+
+	void ForEachKey(const std::function<void(std::string_view name)> &visit) const override {
+		for (const Entry &entry : _entries) {
+			visit(key(entry));
+		}
+	}
+
+	void ForEachValue(const std::function<void(std::string_view name, const DocumentValue &value)> &visit) const override {
+		for (const Entry &entry : _entries) {
+			Value value(*this, entry);
+			visit(key(entry), value);
+		}
+	}
+
+	YAML::Node ToYAML() const override {
+		YAML::Node node(YAML::NodeType::Map);
+		for (const Entry &entry : _entries) {
+			node[std::string(key(entry))] = toYAML(entry);
+		}
+		return node;
+	}
+
+	inline const std::vector<std::byte> &GetData() const { return _data; }
+
+	// Indexes data, checking every entry and nested size stays inside it
+	bool Load(const std::byte *data, size_t size) {
+		_data.assign(data, data + size);
+		_entries.clear();
+
+		size_t pos = 0;
+		while (pos < size) {
+			if (size - pos < 3)
+				return fail();
+
+			Entry entry;
+			entry.tag = static_cast<EntryTag>(_data[pos]);
+			entry.keySize = GetU16(&_data[pos + 1]);
+			entry.start = static_cast<u32>(pos);
+			entry.key = static_cast<u32>(pos + 3);
+			pos += 3;
+			if (size - pos < entry.keySize)
+				return fail();
+			pos += entry.keySize;
+
+			if (entry.tag > EntryTag::Value)
+				return fail();
+			u32 fixed = fixedSize(entry.tag);
+
+			if (fixed == 0) {
+				if (size - pos < 4)
+					return fail();
+				entry.size = GetU32(&_data[pos]);
+				pos += 4;
+			} else {
+				entry.size = fixed;
+			}
+
+			if (size - pos < entry.size)
+				return fail();
+			entry.value = static_cast<u32>(pos);
+			pos += entry.size;
+
+			// Two entries with one key keep the later one, as setting it again would
+			if (Entry *existing = findKey(key(entry)))
+				*existing = entry;
+			else
+				_entries.push_back(entry);
+		}
+		return true;
+	}
+
+  private:
+	struct Entry {
+		EntryTag tag = EntryTag::Bool;
+		u16 keySize = 0;
+		u32 start = 0;
+		u32 key = 0;
+		u32 value = 0;
+		u32 size = 0;
+	};
+
+	class Value : public DocumentValue {
+	  public:
+		Value(const BinaryBackend &backend, const Entry &entry) : _backend(backend), _entry(entry) {}
+
+		bool GetBool(bool &out) const override { return _backend.getBool(&_entry, out); }
+		bool GetInt(i64 &out) const override { return _backend.getInt(&_entry, out); }
+		bool GetU64(u64 &out) const override { return _backend.getU64(&_entry, out); }
+		bool GetFloat(f32 &out) const override { return _backend.getFloat(&_entry, out); }
+		bool GetString(std::string &out) const override { return _backend.getString(&_entry, out); }
+		bool GetVec2(Vector2 &out) const override { return _backend.getVec2(&_entry, out); }
+		bool GetColor(Color &out) const override { return _backend.getColor(&_entry, out); }
+		bool GetStringList(std::vector<std::string> &out) const override { return _backend.getStringList(&_entry, out); }
+
+	  private:
+		const BinaryBackend &_backend;
+		const Entry &_entry;
+	};
+
+	// Typed reads of one entry, shared by the named getters and Value
+	bool getBool(const Entry *entry, bool &out) const {
+		if (entry && entry->tag == EntryTag::Bool) {
+			out = _data[entry->value] != std::byte{0};
+			return true;
+		}
+		return entry && entry->tag == EntryTag::Value && DecodeYAML(toYAML(*entry), out);
+	}
+	bool getInt(const Entry *entry, i64 &out) const {
+		if (entry && (entry->tag == EntryTag::Int || entry->tag == EntryTag::U64)) {
+			out = static_cast<i64>(::GetU64(&_data[entry->value]));
+			return true;
+		}
+		return entry && entry->tag == EntryTag::Value && DecodeYAML(toYAML(*entry), out);
+	}
+	bool getU64(const Entry *entry, u64 &out) const {
+		if (entry && (entry->tag == EntryTag::Int || entry->tag == EntryTag::U64)) {
+			out = ::GetU64(&_data[entry->value]);
+			return true;
+		}
+		return entry && entry->tag == EntryTag::Value && DecodeYAML(toYAML(*entry), out);
+	}
+	bool getFloat(const Entry *entry, f32 &out) const {
+		if (!entry)
+			return false;
+
+		switch (entry->tag) {
+		case EntryTag::Float:
+			out = GetF32(&_data[entry->value]);
+			return true;
+		case EntryTag::Int:
+			out = static_cast<f32>(static_cast<i64>(::GetU64(&_data[entry->value])));
+			return true;
+		case EntryTag::U64:
+			out = static_cast<f32>(::GetU64(&_data[entry->value]));
+			return true;
+		case EntryTag::Value:
+			return DecodeYAML(toYAML(*entry), out);
+		default:
+			return false;
+		}
+	}
+	bool getString(const Entry *entry, std::string &out) const {
+		if (entry && entry->tag == EntryTag::String) {
+			out.assign(reinterpret_cast<const char *>(&_data[entry->value]), entry->size);
+			return true;
+		}
+		return entry && entry->tag == EntryTag::Value && DecodeYAML(toYAML(*entry), out);
+	}
+	bool getVec2(const Entry *entry, Vector2 &out) const {
+		if (entry && entry->tag == EntryTag::Vec2) {
+			out.x = GetF32(&_data[entry->value]);
+			out.y = GetF32(&_data[entry->value + 4]);
+			return true;
+		}
+		return entry && entry->tag == EntryTag::Value && DecodeVec2(toYAML(*entry), out);
+	}
+	bool getColor(const Entry *entry, Color &out) const {
+		if (entry && entry->tag == EntryTag::Color) {
+			out.r = GetF32(&_data[entry->value]);
+			out.g = GetF32(&_data[entry->value + 4]);
+			out.b = GetF32(&_data[entry->value + 8]);
+			out.a = GetF32(&_data[entry->value + 12]);
+			return true;
+		}
+		return entry && entry->tag == EntryTag::Value && DecodeColor(toYAML(*entry), out);
+	}
+	bool getStringList(const Entry *entry, std::vector<std::string> &out) const {
+		if (entry && entry->tag == EntryTag::StringList)
+			return readStringList(*entry, out);
+		return entry && entry->tag == EntryTag::Value && DecodeYAML(toYAML(*entry), out);
+	}
+
+	static u32 fixedSize(EntryTag tag) {
+		switch (tag) {
+		case EntryTag::Bool:
+			return 1;
+		case EntryTag::Int:
+		case EntryTag::U64:
+		case EntryTag::Vec2:
+			return 8;
+		case EntryTag::Float:
+			return 4;
+		case EntryTag::Color:
+			return 16;
+		default:
+			return 0;
+		}
+	}
+
+	bool fail() {
+		_data.clear();
+		_entries.clear();
+		return false;
+	}
+
+	std::string_view key(const Entry &entry) const {
+		return std::string_view(reinterpret_cast<const char *>(&_data[entry.key]), entry.keySize);
+	}
+
+	const Entry *find(const char *name) const {
+		std::string_view wanted(name);
+		for (const Entry &entry : _entries) {
+			if (key(entry) == wanted)
+				return &entry;
+		}
+		return nullptr;
+	}
+
+	Entry *findKey(std::string_view wanted) {
+		for (Entry &entry : _entries) {
+			if (key(entry) == wanted)
+				return &entry;
+		}
+		return nullptr;
+	}
+
+	// Starts an entry, replacing any entry with the same name. The payload is appended by the caller and closed by end
+	void begin(const char *name, EntryTag tag) {
+		std::string_view nameView(name);
+		if (nameView.size() > 0xFFFF)
+			nameView = nameView.substr(0, 0xFFFF);
+		erase(nameView);
+
+		Entry &entry = _entries.emplace_back();
+		entry.tag = tag;
+		entry.keySize = static_cast<u16>(nameView.size());
+		entry.start = static_cast<u32>(_data.size());
+		PutU8(_data, static_cast<u8>(tag));
+		PutU16(_data, entry.keySize);
+		entry.key = static_cast<u32>(_data.size());
+		PutBytes(_data, nameView.data(), nameView.size());
+
+		if (fixedSize(tag) == 0)
+			PutU32(_data, 0);
+		entry.value = static_cast<u32>(_data.size());
+	}
+
+	void end() {
+		Entry &entry = _entries.back();
+		entry.size = static_cast<u32>(_data.size() - entry.value);
+		if (fixedSize(entry.tag) == 0)
+			SetU32(_data, entry.value - 4, entry.size);
+	}
+
+	void erase(std::string_view name) {
+		Entry *entry = findKey(name);
+		if (!entry)
+			return;
+
+		u32 start = entry->start;
+		u32 removed = entry->value + entry->size - start;
+		_data.erase(_data.begin() + start, _data.begin() + start + removed);
+		_entries.erase(_entries.begin() + (entry - _entries.data()));
+
+		for (Entry &other : _entries) {
+			if (other.start > start) {
+				other.start -= removed;
+				other.key -= removed;
+				other.value -= removed;
+			}
+		}
+	}
+
+	bool readStringList(const Entry &entry, std::vector<std::string> &out) const {
+		const std::byte *p = &_data[entry.value];
+		const std::byte *end = p + entry.size;
+		if (end - p < 4)
+			return false;
+
+		u32 count = GetU32(p);
+		p += 4;
+		std::vector<std::string> list;
+		list.reserve(std::min<size_t>(count, entry.size / 4));
+		for (u32 i = 0; i < count; i++) {
+			if (end - p < 4)
+				return false;
+			u32 size = GetU32(p);
+			p += 4;
+			if (static_cast<size_t>(end - p) < size)
+				return false;
+			list.emplace_back(reinterpret_cast<const char *>(p), size);
+			p += size;
+		}
+		out = std::move(list);
+		return true;
+	}
+
+	YAML::Node toYAML(const Entry &entry) const {
+		const std::byte *p = &_data[entry.value];
+		switch (entry.tag) {
+		case EntryTag::Bool:
+			return YAML::Node(*p != std::byte{0});
+		case EntryTag::Int:
+			return YAML::Node(static_cast<i64>(::GetU64(p)));
+		case EntryTag::U64:
+			return YAML::Node(::GetU64(p));
+		case EntryTag::Float:
+			return YAML::Node(GetF32(p));
+		case EntryTag::String:
+			return StringNode(std::string(reinterpret_cast<const char *>(p), entry.size));
+		case EntryTag::Vec2: {
+			YAML::Node node;
+			node["x"] = GetF32(p);
+			node["y"] = GetF32(p + 4);
+			return node;
+		}
+		case EntryTag::Color: {
+			YAML::Node node;
+			node["r"] = GetF32(p);
+			node["g"] = GetF32(p + 4);
+			node["b"] = GetF32(p + 8);
+			node["a"] = GetF32(p + 12);
+			return node;
+		}
+		case EntryTag::StringList: {
+			std::vector<std::string> list;
+			readStringList(entry, list);
+			YAML::Node node(YAML::NodeType::Sequence);
+			for (std::string &str : list) {
+				node.push_back(StringNode(std::move(str)));
+			}
+			return node;
+		}
+		case EntryTag::Document: {
+			Document doc(DocumentFormat::Binary);
+			doc.LoadBinary(p, entry.size);
+			return doc.ToYAML();
+		}
+		case EntryTag::Value: {
+			YAML::Node node;
+			if (!ReadValue(p, p + entry.size, node, 0))
+				return YAML::Node();
+			return node;
+		}
+		}
+		return YAML::Node();
+	}
+
+  private:
+	std::vector<std::byte> _data;
+	std::vector<Entry> _entries;
+};
+
+std::unique_ptr<DocumentBackend> CreateBackend(DocumentFormat format) {
+	if (format == DocumentFormat::Binary)
+		return std::make_unique<BinaryBackend>();
+	return std::make_unique<YAMLBackend>();
+}
+
+} // namespace
+
+Document::Document() : _backend(CreateBackend(DocumentFormat::YAML)) {}
+
+Document::Document(DocumentFormat format) : _backend(CreateBackend(format)) {}
+
+Document::Document(YAML::Node node) : _backend(std::make_unique<YAMLBackend>(node)) {}
+
+Document &Document::operator=(const Document &other) {
+	if (this != &other)
+		_backend = other._backend->Clone();
+	return *this;
+}
+
+Document::Document(Document &&other) : _backend(std::move(other._backend)) {
+	other._backend = CreateBackend(_backend->Format());
+}
+
+Document &Document::operator=(Document &&other) {
+	if (this != &other) {
+		_backend = std::move(other._backend);
+		other._backend = CreateBackend(_backend->Format());
+	}
+	return *this;
+}
+
+Document Document::Convert(DocumentFormat format) const {
+	if (format == Format())
+		return *this;
+
+	if (format == DocumentFormat::YAML)
+		return Document(YAML::Clone(ToYAML()));
+
+	// Values keep their YAML form, typed getters still read them
+	std::unique_ptr<BinaryBackend> backend = std::make_unique<BinaryBackend>();
+	YAML::Node node = ToYAML();
+	if (node.IsMap()) {
+		for (YAML::const_iterator it = node.begin(); it != node.end(); ++it) {
+			backend->SetValue(it->first.Scalar().c_str(), it->second);
+		}
+	}
+
+	Document doc(DocumentFormat::Binary);
+	doc._backend = std::move(backend);
+	return doc;
+}
+
+std::vector<std::byte> Document::ToBinary() const {
+	const DocumentBackend *backend = _backend.get();
+	Document converted;
+	if (Format() != DocumentFormat::Binary) {
+		converted = Convert(DocumentFormat::Binary);
+		backend = converted._backend.get();
+	}
+	return static_cast<const BinaryBackend *>(backend)->GetData();
+}
+
+bool Document::LoadBinary(const std::byte *data, size_t size) {
+	std::unique_ptr<BinaryBackend> backend = std::make_unique<BinaryBackend>();
+	bool loaded = backend->Load(data, size);
+	_backend = std::move(backend);
+	return loaded;
+}
+
+void EmitYAML(YAML::Emitter &emitter, const YAML::Node &node) {
+	switch (node.Type()) {
+	case YAML::NodeType::Scalar:
+		if (node.Tag() == "!" && ReadsAsOtherType(node.Scalar()))
+			emitter << YAML::DoubleQuoted << node.Scalar();
+		else
+			emitter << node;
+		break;
+
+	case YAML::NodeType::Sequence:
+		if (node.Style() == YAML::EmitterStyle::Flow)
+			emitter << YAML::Flow;
+		emitter << YAML::BeginSeq;
+		for (YAML::const_iterator it = node.begin(); it != node.end(); ++it) {
+			EmitYAML(emitter, *it);
+		}
+		emitter << YAML::EndSeq;
+		break;
+
+	case YAML::NodeType::Map:
+		if (node.Style() == YAML::EmitterStyle::Flow)
+			emitter << YAML::Flow;
+		emitter << YAML::BeginMap;
+		for (YAML::const_iterator it = node.begin(); it != node.end(); ++it) {
+			emitter << YAML::Key;
+			EmitYAML(emitter, it->first);
+			emitter << YAML::Value;
+			EmitYAML(emitter, it->second);
+		}
+		emitter << YAML::EndMap;
+		break;
+
+	default:
+		emitter << node;
+		break;
+	}
+}
\ No newline at end of file
@@ -2,6 +2,13 @@
 #define DOCUMENT_HPP
 #pragma once
 
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
 #include "glm/glm.hpp"
 #include "yaml-cpp/yaml.h"
 
@@ -33,65 +40,175 @@ struct convert<glm::ivec2> {
 };
 } // namespace YAML
 
+enum class DocumentFormat {
+	// Backed by a YAML::Node, used for files people read and edit
+	YAML = 0,
+	// Compact tagged values in one byte buffer, for runtime saves, snapshots and replication
+	Binary,
+};
+
+class Document;
+
+// One value of a document, handed to ForEachValue visitors. Getters work like the document's own, without looking
+// the key up again
+class DocumentValue {
+  public:
+	virtual ~DocumentValue() = default;
+
+	virtual bool GetBool(bool &out) const = 0;
+	virtual bool GetInt(i64 &out) const = 0;
+	virtual bool GetU64(u64 &out) const = 0;
+	virtual bool GetFloat(f32 &out) const = 0;
+	virtual bool GetString(std::string &out) const = 0;
+	virtual bool GetVec2(Vector2 &out) const = 0;
+	virtual bool GetColor(Color &out) const = 0;
+	virtual bool GetStringList(std::vector<std::string> &out) const = 0;
+};
+
+// Storage of a Document. Getters return false and leave out alone when the key is missing or holds another kind of
+// value, numbers convert between each other
+class DocumentBackend {
+  public:
+	virtual ~DocumentBackend() = default;
+
+	virtual DocumentFormat Format() const = 0;
+	virtual std::unique_ptr<DocumentBackend> Clone() const = 0;
+
+	virtual void SetBool(const char *name, bool value) = 0;
+	virtual void SetInt(const char *name, i64 value) = 0;
+	virtual void SetU64(const char *name, u64 value) = 0;
+	virtual void SetFloat(const char *name, f32 value) = 0;
+	virtual void SetString(const char *name, std::string_view value) = 0;
+	virtual void SetVec2(const char *name, const Vector2 &value) = 0;
+	virtual void SetColor(const char *name, const Color &value) = 0;
+	virtual void SetStringList(const char *name, const std::vector<std::string> &value) = 0;
+	virtual void SetDocument(const char *name, const Document &doc) = 0;
+	// Any value yaml-cpp can convert, Document::Set and Get go through it
+	virtual void SetValue(const char *name, const YAML::Node &value) = 0;
+
+	virtual bool Has(const char *name) const = 0;
+	virtual bool GetBool(const char *name, bool &out) const = 0;
+	virtual bool GetInt(const char *name, i64 &out) const = 0;
+	virtual bool GetU64(const char *name, u64 &out) const = 0;
+	virtual bool GetFloat(const char *name, f32 &out) const = 0;
+	virtual bool GetString(const char *name, std::string &out) const = 0;
+	virtual bool GetVec2(const char *name, Vector2 &out) const = 0;
+	virtual bool GetColor(const char *name, Color &out) const = 0;
+	virtual bool GetStringList(const char *name, std::vector<std::string> &out) const = 0;
+	virtual bool GetDocument(const char *name, Document &out) const = 0;
+	virtual bool GetValue(const char *name, YAML::Node &out) const = 0;
+
+	// Visits each key once
+	virtual void ForEachKey(const std::function<void(std::string_view name)> &visit) const = 0;
+	// Visits each key once with its value, which is only valid during the call
+	virtual void ForEachValue(const std::function<void(std::string_view name, const DocumentValue &value)> &visit) const = 0;
+
+	virtual YAML::Node ToYAML() const = 0;
+};
+
 class Document {
   public:
-	inline void SetInt(const char *name, i32 value) { _node[name] = value; }
-	inline void SetUint(const char *name, u32 value) { _node[name] = value; }
-	inline void SetU64(const char *name, u64 value) { _node[name] = value; }
-	inline void SetFloat(const char *name, f32 value) { _node[name] = value; }
-	inline void SetString(const char *name, const std::string &value) { _node[name] = value; }
-	inline void SetVec2(const char *name, const Vector2 &value) {
-		_node[name]["x"] = value.x;
-		_node[name]["y"] = value.y;
-	}
-	inline void SetColor(const char *name, Color color) {
-		_node[name]["r"] = color.r;
-		_node[name]["g"] = color.g;
-		_node[name]["b"] = color.b;
-		_node[name]["a"] = color.a;
-	}
-	inline void SetDocument(const char *name, const Document &doc) { _node[name] = doc._node; }
+	inline void SetBool(const char *name, bool value) { _backend->SetBool(name, value); }
+	inline void SetInt(const char *name, i32 value) { _backend->SetInt(name, value); }
+	inline void SetUint(const char *name, u32 value) { _backend->SetU64(name, value); }
+	inline void SetU64(const char *name, u64 value) { _backend->SetU64(name, value); }
+	inline void SetFloat(const char *name, f32 value) { _backend->SetFloat(name, value); }
+	inline void SetString(const char *name, const std::string &value) { _backend->SetString(name, value); }
+	inline void SetVec2(const char *name, const Vector2 &value) { _backend->SetVec2(name, value); }
+	inline void SetColor(const char *name, Color color) { _backend->SetColor(name, color); }
+	inline void SetStringList(const char *name, const std::vector<std::string> &value) { _backend->SetStringList(name, value); }
+	inline void SetDocument(const char *name, const Document &doc) { _backend->SetDocument(name, doc); }
 	template <typename T>
-	inline void Set(const char *name, const T &value) { _node[name] = value; }
+	inline void Set(const char *name, const T &value) { _backend->SetValue(name, YAML::Node(value)); }
 	template <typename T>
-	inline void SetVector(const char *name, const std::vector<T> &value) { _node[name] = value; }
+	inline void SetVector(const char *name, const std::vector<T> &value) { _backend->SetValue(name, YAML::Node(value)); }
 
-	inline i32 GetInt(const char *name, i32 fallback) const { return _node[name].as<i32>(fallback); }
-	inline u32 GetUint(const char *name, u32 fallback) const { return _node[name].as<u32>(fallback); }
-	inline u64 GetU64(const char *name, u64 fallback) const { return _node[name].as<u64>(fallback); }
-	inline f32 GetFloat(const char *name, f32 fallback) const { return _node[name].as<f32>(fallback); }
-	inline std::string GetString(const char *name, const std::string &fallback) const { return _node[name].as<std::string>(fallback); }
+	inline bool Has(const char *name) const { return _backend->Has(name); }
+	inline bool GetBool(const char *name, bool fallback) const {
+		_backend->GetBool(name, fallback);
+		return fallback;
+	}
+	inline i32 GetInt(const char *name, i32 fallback) const {
+		i64 value = fallback;
+		_backend->GetInt(name, value);
+		return static_cast<i32>(value);
+	}
+	inline u32 GetUint(const char *name, u32 fallback) const {
+		u64 value = fallback;
+		_backend->GetU64(name, value);
+		return static_cast<u32>(value);
+	}
+	inline u64 GetU64(const char *name, u64 fallback) const {
+		_backend->GetU64(name, fallback);
+		return fallback;
+	}
+	inline f32 GetFloat(const char *name, f32 fallback) const {
+		_backend->GetFloat(name, fallback);
+		return fallback;
+	}
+	inline std::string GetString(const char *name, const std::string &fallback) const {
+		std::string value;
+		return _backend->GetString(name, value) ? value : fallback;
+	}
 	inline Vector2 GetVec2(const char *name, Vector2 callback) const {
-		auto vec = _node[name];
-		if (vec) {
-			callback.x = vec["x"].as<float>(callback.x);
-			callback.y = vec["y"].as<float>(callback.y);
-		}
+		_backend->GetVec2(name, callback);
 		return callback;
 	}
 	inline Color GetColor(const char *name, Color callback) const {
-		auto color = _node[name];
-		if (color) {
-			callback.r = color["r"].as<float>(callback.r);
-			callback.g = color["g"].as<float>(callback.g);
-			callback.b = color["b"].as<float>(callback.b);
-			callback.a = color["a"].as<float>(callback.a);
-		}
+		_backend->GetColor(name, callback);
 		return callback;
 	}
-	inline Document GetDocument(const char *name) const { return Document(_node[name]); }
+	inline std::vector<std::string> GetStringList(const char *name, std::vector<std::string> fallback) const {
+		_backend->GetStringList(name, fallback);
+		return fallback;
+	}
+	// A missing key gives an empty document of the same format
+	inline Document GetDocument(const char *name) const {
+		Document doc(Format());
+		_backend->GetDocument(name, doc);
+		return doc;
+	}
 	template <typename T>
-	inline T Get(const char *name, T fallback) const { return _node[name].as<T>(fallback); }
+	inline T Get(const char *name, T fallback) const {
+		YAML::Node value;
+		return _backend->GetValue(name, value) ? value.as<T>(fallback) : fallback;
+	}
 	template <typename T>
-	inline std::vector<T> GetVector(const char *name, std::vector<T> fallback) const { return _node[name].as<std::vector<T>>(fallback); }
+	inline std::vector<T> GetVector(const char *name, std::vector<T> fallback) const { return Get(name, fallback); }
+
+	inline void ForEachKey(const std::function<void(std::string_view name)> &visit) const { _backend->ForEachKey(visit); }
+	inline void ForEachValue(const std::function<void(std::string_view name, const DocumentValue &value)> &visit) const { _backend->ForEachValue(visit); }
+
+	Document();
+	explicit Document(DocumentFormat format);
+	Document(YAML::Node node);
+	Document(const Document &other) : _backend(other._backend->Clone()) {}
+	// Moved from documents are left empty in the same format rather than without a backend
+	Document(Document &&other);
+	Document &operator=(const Document &other);
+	Document &operator=(Document &&other);
 
-	Document() = default;
-	Document(YAML::Node _node) : _node(_node) {}
-	YAML::Node &GetYAMLNode() { return _node; }
-	const YAML::Node &GetYAMLNode() const { return _node; }
+	inline DocumentFormat Format() const { return _backend->Format(); }
+	inline DocumentBackend &GetBackend() { return *_backend; }
+	inline const DocumentBackend &GetBackend() const { return *_backend; }
+
+	// YAML documents return their node, which shares its data with the document. Other formats are converted
+	inline YAML::Node ToYAML() const { return _backend->ToYAML(); }
+
+	// Copy of the document in another format. Binary copies own their data, so they can be handed to other threads
+	Document Convert(DocumentFormat format) const;
+
+	// Encoded contents of a binary document, other formats are converted
+	std::vector<std::byte> ToBinary() const;
+	// Replaces the contents with a binary document read from data, which is copied. Returns false if data is malformed
+	bool LoadBinary(const std::byte *data, size_t size);
 
   private:
-	YAML::Node _node;
+	std::unique_ptr<DocumentBackend> _backend;
 };
 
+// Emits node like YAML::Emitter does, but double quotes strings that would read back as a bool or a number. Strings
+// written by SetString and quoted scalars of loaded files carry the non-specific tag "!" that marks them
+void EmitYAML(YAML::Emitter &emitter, const YAML::Node &node);
+
 #endif // DOCUMENT_HPP
\ No newline at end of file
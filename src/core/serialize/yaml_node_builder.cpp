@@ -0,0 +1,114 @@
+#include "yaml_node_builder.hpp"
+
+void YAMLNodeBuilder::Begin(bool discard) {
+	_stack.clear();
+	_result.reset();
+	_building = true;
+	_done = false;
+	_discard = discard;
+	_discardDepth = 0;
+}
+
+YAML::Node YAMLNodeBuilder::Take() {
+	// Nodes assign through to their shared data, reset rebinds instead
+	YAML::Node result = _result;
+	_result.reset();
+	_building = false;
+	_done = false;
+	return result;
+}
+
+void YAMLNodeBuilder::Null(YAML::anchor_t anchor) {
+	if (_discard) {
+		_done = _discardDepth == 0;
+		return;
+	}
+	add(YAML::Node(YAML::NodeType::Null), anchor);
+}
+
+void YAMLNodeBuilder::Alias(YAML::anchor_t anchor) {
+	if (_discard) {
+		_done = _discardDepth == 0;
+		return;
+	}
+
+	auto it = _anchors.find(anchor);
+	add(it != _anchors.end() ? it->second : YAML::Node(YAML::NodeType::Null), YAML::NullAnchor);
+}
+
+void YAMLNodeBuilder::Scalar(const std::string &tag, YAML::anchor_t anchor, const std::string &value) {
+	if (_discard) {
+		_done = _discardDepth == 0;
+		return;
+	}
+
+	YAML::Node node(value);
+	node.SetTag(tag);
+	add(node, anchor);
+}
+
+void YAMLNodeBuilder::SequenceStart(const std::string &tag, YAML::anchor_t anchor, YAML::EmitterStyle::value style) {
+	if (_discard) {
+		_discardDepth++;
+		return;
+	}
+
+	Frame &frame = _stack.emplace_back();
+	frame.node.reset(YAML::Node(YAML::NodeType::Sequence));
+	frame.node.SetStyle(style);
+	frame.anchor = anchor;
+}
+
+void YAMLNodeBuilder::SequenceEnd() {
+	end();
+}
+
+void YAMLNodeBuilder::MapStart(const std::string &tag, YAML::anchor_t anchor, YAML::EmitterStyle::value style) {
+	if (_discard) {
+		_discardDepth++;
+		return;
+	}
+
+	Frame &frame = _stack.emplace_back();
+	frame.node.reset(YAML::Node(YAML::NodeType::Map));
+	frame.node.SetStyle(style);
+	frame.anchor = anchor;
+}
+
+void YAMLNodeBuilder::MapEnd() {
+	end();
+}
+
+void YAMLNodeBuilder::end() {
+	if (_discard) {
+		_discardDepth--;
+		_done = _discardDepth == 0;
+		return;
+	}
+
+	Frame frame = _stack.back();
+	_stack.pop_back();
+	add(frame.node, frame.anchor);
+}
+
+void YAMLNodeBuilder::add(YAML::Node value, YAML::anchor_t anchor) {
+	if (anchor != YAML::NullAnchor)
+		_anchors[anchor].reset(value);
+
+	if (_stack.empty()) {
+		_result.reset(value);
+		_done = true;
+		return;
+	}
+
+	Frame &parent = _stack.back();
+	if (parent.node.IsSequence()) {
+		parent.node.push_back(value);
+	} else if (!parent.hasKey) {
+		parent.key.reset(value);
+		parent.hasKey = true;
+	} else {
+		parent.node[parent.key] = value;
+		parent.hasKey = false;
+	}
+}
\ No newline at end of file
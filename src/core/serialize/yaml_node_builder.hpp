@@ -0,0 +1,58 @@
+#ifndef YAML_NODE_BUILDER_HPP
+#define YAML_NODE_BUILDER_HPP
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "yaml-cpp/eventhandler.h"
+#include "yaml-cpp/yaml.h"
+
+#include "sowa.hpp"
+
+// Builds one value at a time from YAML parser events, for loaders that never hold the whole document
+class YAMLNodeBuilder {
+  public:
+	// Starts a new value. A discarded value is only walked, nothing is allocated for it
+	void Begin(bool discard = false);
+
+	inline bool IsBuilding() const { return _building; }
+	inline bool IsDone() const { return _done; }
+
+	// Returns the finished value and resets the builder
+	YAML::Node Take();
+
+	void Null(YAML::anchor_t anchor);
+	void Alias(YAML::anchor_t anchor);
+	void Scalar(const std::string &tag, YAML::anchor_t anchor, const std::string &value);
+	void SequenceStart(const std::string &tag, YAML::anchor_t anchor, YAML::EmitterStyle::value style);
+	void SequenceEnd();
+	void MapStart(const std::string &tag, YAML::anchor_t anchor, YAML::EmitterStyle::value style);
+	void MapEnd();
+
+  private:
+	struct Frame {
+		YAML::Node node;
+		YAML::anchor_t anchor = YAML::NullAnchor;
+		YAML::Node key;
+		bool hasKey = false;
+	};
+
+	void add(YAML::Node value, YAML::anchor_t anchor);
+	void end();
+
+  private:
+	std::vector<Frame> _stack;
+	YAML::Node _result;
+
+	bool _building = false;
+	bool _done = false;
+	bool _discard = false;
+	u32 _discardDepth = 0;
+
+	// Anchors stay valid across values, since an alias may point into an earlier one
+	std::unordered_map<YAML::anchor_t, YAML::Node> _anchors;
+};
+
+#endif // YAML_NODE_BUILDER_HPP
\ No newline at end of file
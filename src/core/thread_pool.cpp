@@ -0,0 +1,63 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+
+ThreadPool::ThreadPool(u32 threadCount) {
+	// Web builds are not linked with pthreads, jobs run inline in Submit
+#ifndef SW_WEB
+	if (threadCount == 0) {
+		u32 cores = std::thread::hardware_concurrency();
+		threadCount = std::max<u32>(cores, 2) - 1;
+	}
+
+	_threads.reserve(threadCount);
+	for (u32 i = 0; i < threadCount; i++) {
+		_threads.emplace_back(&ThreadPool::work, this);
+	}
+#endif
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+	_wake.notify_all();
+
+	for (std::thread &thread : _threads) {
+		thread.join();
+	}
+}
+
+std::future<void> ThreadPool::Submit(std::function<void()> job) {
+	std::packaged_task<void()> task(std::move(job));
+	std::future<void> future = task.get_future();
+	if (_threads.empty()) {
+		task();
+		return future;
+	}
+
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_jobs.push_back(std::move(task));
+	}
+	_wake.notify_one();
+
+	return future;
+}
+
+void ThreadPool::work() {
+	while (true) {
+		std::packaged_task<void()> task;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_wake.wait(lock, [this]() { return _stop || !_jobs.empty(); });
+			if (_jobs.empty())
+				return;
+
+			task = std::move(_jobs.front());
+			_jobs.pop_front();
+		}
+		task();
+	}
+}
\ No newline at end of file
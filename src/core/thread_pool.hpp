@@ -0,0 +1,38 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+#pragma once
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "sowa.hpp"
+
+// Fixed set of worker threads running submitted jobs in order. Jobs must not touch GL or AL.
+// Without workers, as on web, Submit runs the job before returning
+class ThreadPool {
+  public:
+	// A thread count of 0 uses one worker per core, leaving one for the main thread
+	ThreadPool(u32 threadCount = 0);
+	~ThreadPool();
+
+	std::future<void> Submit(std::function<void()> job);
+
+	inline u32 ThreadCount() const { return static_cast<u32>(_threads.size()); }
+
+  private:
+	void work();
+
+	std::vector<std::thread> _threads;
+	std::deque<std::packaged_task<void()>> _jobs;
+
+	std::mutex _mutex;
+	std::condition_variable _wake;
+	bool _stop = false;
+};
+
+#endif // THREAD_POOL_HPP
\ No newline at end of file
@@ -14,8 +14,7 @@ void ProjectSettings::Load() {
 		return;
 	}
 
-	std::string str{reinterpret_cast<char *>(file->Buffer().data()), file->Buffer().size()};
-	YAML::Node doc = YAML::Load(str);
+	YAML::Node doc = YAML::Load(std::string(file->View()));
 
 	name = doc["Name"].as<std::string>(name);
 	author = doc["Author"].as<std::string>(author);
@@ -30,6 +29,13 @@ void ProjectSettings::Load() {
 			this->rendering.viewport.width = viewport["Width"].as<int>(this->rendering.viewport.width);
 			this->rendering.viewport.height = viewport["Height"].as<int>(this->rendering.viewport.height);
 		}
+
+		if (auto atlas = rendering["Atlas"]; atlas) {
+			this->rendering.atlas.enabled = atlas["Enabled"].as<bool>(this->rendering.atlas.enabled);
+			this->rendering.atlas.pageSize = atlas["PageSize"].as<int>(this->rendering.atlas.pageSize);
+			this->rendering.atlas.maxTextureSize = atlas["MaxTextureSize"].as<int>(this->rendering.atlas.maxTextureSize);
+			this->rendering.atlas.gutter = atlas["Gutter"].as<int>(this->rendering.atlas.gutter);
+		}
 	}
 
 	auto store = doc["GlobalStore"].as<std::unordered_map<std::string, std::string>>(std::unordered_map<std::string, std::string>());
@@ -51,9 +57,16 @@ bool ProjectSettings::Save() {
 	viewportNode["Width"] = rendering.viewport.width;
 	viewportNode["Height"] = rendering.viewport.height;
 
+	YAML::Node atlasNode;
+	atlasNode["Enabled"] = rendering.atlas.enabled;
+	atlasNode["PageSize"] = rendering.atlas.pageSize;
+	atlasNode["MaxTextureSize"] = rendering.atlas.maxTextureSize;
+	atlasNode["Gutter"] = rendering.atlas.gutter;
+
 	YAML::Node renderingNode;
 	renderingNode["Window"] = windowNode;
 	renderingNode["Viewport"] = viewportNode;
+	renderingNode["Atlas"] = atlasNode;
 
 	out["Rendering"] = renderingNode;
 	out["GlobalStore"] = App().GetGlobalStore().GetStore();
@@ -24,6 +24,14 @@ class ProjectSettings {
 			int width = 1280;
 			int height = 720;
 		} viewport;
+
+		// Small textures of a scene are packed into shared pages while it loads, see TextureAtlas::Pack
+		struct {
+			bool enabled = true;
+			int pageSize = 2048;
+			int maxTextureSize = 256;
+			int gutter = 4;
+		} atlas;
 	} rendering;
 };
 
@@ -0,0 +1,157 @@
+#include "random_number_generator.hpp"
+
+#include <random>
+#include <utility>
+
+static u64 SplitMix64(u64 &state) {
+	u64 z = (state += 0x9e3779b97f4a7c15);
+	z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+	z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+	return z ^ (z >> 31);
+}
+
+static u64 DeviceSeed() {
+	std::random_device device;
+	return (static_cast<u64>(device()) << 32) | device();
+}
+
+RandomNumberGenerator::RandomNumberGenerator() {
+	Seed(DeviceSeed());
+}
+
+RandomNumberGenerator::RandomNumberGenerator(u64 seed) {
+	Seed(seed);
+}
+
+void RandomNumberGenerator::Seed(u64 seed) {
+	_seed = seed;
+
+	u64 state = seed;
+	for (u64 &word : _s) {
+		word = SplitMix64(state);
+	}
+
+	for (size_t lane = 0; lane < LaneCount; lane++) {
+		for (size_t word = 0; word < 4; word++) {
+			_lanes[word][lane] = SplitMix64(state);
+		}
+	}
+}
+
+u32 RandomNumberGenerator::Bounded(u32 bound) {
+	// Lemire's multiply and reject
+	u64 m = static_cast<u64>(U32()) * bound;
+	u32 low = static_cast<u32>(m);
+	if (low < bound) {
+		u32 threshold = static_cast<u32>(-bound) % bound;
+		while (low < threshold) {
+			m = static_cast<u64>(U32()) * bound;
+			low = static_cast<u32>(m);
+		}
+	}
+	return static_cast<u32>(m >> 32);
+}
+
+i32 RandomNumberGenerator::Range(i32 min, i32 max) {
+	if (min == max)
+		return max;
+
+	if (max < min)
+		std::swap(min, max);
+
+	u32 span = static_cast<u32>(static_cast<i64>(max) - min);
+	return static_cast<i32>(static_cast<i64>(min) + Bounded(span));
+}
+
+f32 RandomNumberGenerator::RangeFloat(f32 min, f32 max) {
+	if (max < min)
+		std::swap(min, max);
+
+	return min + Float() * (max - min);
+}
+
+void RandomNumberGenerator::Jump() {
+	jumpState(_s);
+
+	// Bulk output reads the lanes only, they jump as well so Fill and FillFloat move to the sub stream too
+	for (size_t lane = 0; lane < LaneCount; lane++) {
+		u64 state[4];
+		for (size_t word = 0; word < 4; word++)
+			state[word] = _lanes[word][lane];
+		jumpState(state);
+		for (size_t word = 0; word < 4; word++)
+			_lanes[word][lane] = state[word];
+	}
+}
+
+void RandomNumberGenerator::Fill(u32 *out, size_t count) {
+	size_t i = 0;
+	for (; i + LaneCount <= count; i += LaneCount) {
+		u64 values[LaneCount];
+		stepLanes(values);
+		for (size_t lane = 0; lane < LaneCount; lane++)
+			out[i + lane] = static_cast<u32>(values[lane] >> 32);
+	}
+
+	for (; i < count; i++)
+		out[i] = U32();
+}
+
+void RandomNumberGenerator::FillFloat(f32 *out, size_t count, f32 min, f32 max) {
+	const f32 scale = (max - min) * 0x1.0p-24f;
+
+	size_t i = 0;
+	for (; i + LaneCount <= count; i += LaneCount) {
+		u64 values[LaneCount];
+		stepLanes(values);
+		for (size_t lane = 0; lane < LaneCount; lane++)
+			out[i + lane] = min + static_cast<f32>(values[lane] >> 40) * scale;
+	}
+
+	for (; i < count; i++)
+		out[i] = min + static_cast<f32>(Next() >> 40) * scale;
+}
+
+void RandomNumberGenerator::stepLanes(u64 *out) {
+	u64 *s0 = _lanes[0];
+	u64 *s1 = _lanes[1];
+	u64 *s2 = _lanes[2];
+	u64 *s3 = _lanes[3];
+
+	for (size_t lane = 0; lane < LaneCount; lane++) {
+		out[lane] = rotl(s1[lane] * 5, 7) * 9;
+
+		const u64 t = s1[lane] << 17;
+		s2[lane] ^= s0[lane];
+		s3[lane] ^= s1[lane];
+		s1[lane] ^= s2[lane];
+		s0[lane] ^= s3[lane];
+		s2[lane] ^= t;
+		s3[lane] = rotl(s3[lane], 45);
+	}
+}
+
+void RandomNumberGenerator::jumpState(u64 *state) {
+	static constexpr u64 jump[] = {0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c};
+
+	u64 s[4] = {0, 0, 0, 0};
+	for (u64 word : jump) {
+		for (int b = 0; b < 64; b++) {
+			if (word & (u64(1) << b)) {
+				for (int i = 0; i < 4; i++)
+					s[i] ^= state[i];
+			}
+
+			const u64 t = state[1] << 17;
+			state[2] ^= state[0];
+			state[3] ^= state[1];
+			state[1] ^= state[2];
+			state[0] ^= state[3];
+			state[2] ^= t;
+			state[3] = rotl(state[3], 45);
+		}
+	}
+
+	for (int i = 0; i < 4; i++)
+		state[i] = s[i];
+}
\ No newline at end of file
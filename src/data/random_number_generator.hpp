@@ -2,33 +2,80 @@
 #define RANDOM_NUMBER_GENERATOR_HPP
 #pragma once
 
-#include <random>
+#include <cstddef>
+#include <limits>
 
 #include "sowa.hpp"
 
+// xoshiro256** generator. Seeding is deterministic, so a stream can be replayed from its seed
 class RandomNumberGenerator {
   public:
-	RandomNumberGenerator() : e1(_device()) {}
+	using result_type = u64;
 
-	inline i32 I32() {
-		return std::uniform_int_distribution<i32>{INT32_MIN, INT32_MAX}(_device);
-	}
+	// Seeded from std::random_device, drawn once
+	RandomNumberGenerator();
+	explicit RandomNumberGenerator(u64 seed);
 
-	inline i64 I64() {
-		return std::uniform_int_distribution<i64>{INT64_MIN, INT64_MAX}(_device);
-	}
+	void Seed(u64 seed);
+	inline u64 GetSeed() const { return _seed; }
 
-	inline u32 U32() {
-		return std::uniform_int_distribution<u32>{0, UINT32_MAX}(_device);
-	}
+	inline u64 Next() {
+		const u64 result = rotl(_s[1] * 5, 7) * 9;
+		const u64 t = _s[1] << 17;
+
+		_s[2] ^= _s[0];
+		_s[3] ^= _s[1];
+		_s[1] ^= _s[2];
+		_s[0] ^= _s[3];
+		_s[2] ^= t;
+		_s[3] = rotl(_s[3], 45);
 
-	inline u64 U64() {
-		return std::uniform_int_distribution<u64>{0, UINT64_MAX}(_device);
+		return result;
 	}
 
+	inline i32 I32() { return static_cast<i32>(Next() >> 32); }
+	inline i64 I64() { return static_cast<i64>(Next()); }
+	inline u32 U32() { return static_cast<u32>(Next() >> 32); }
+	inline u64 U64() { return Next(); }
+
+	// [0, 1)
+	inline f32 Float() { return static_cast<f32>(Next() >> 40) * 0x1.0p-24f; }
+	inline f64 Double() { return static_cast<f64>(Next() >> 11) * 0x1.0p-53; }
+
+	// Unbiased integer in [0, bound)
+	u32 Bounded(u32 bound);
+	// [min, max), max is excluded
+	i32 Range(i32 min, i32 max);
+	f32 RangeFloat(f32 min, f32 max);
+
+	// Advances the stream and every bulk lane by 2^128 values, giving a non overlapping sub stream
+	void Jump();
+
+	// Bulk generation runs several independent lanes side by side so the loop vectorizes.
+	// Lanes are derived from the seed, so bulk output is reproducible as well
+	void Fill(u32 *out, size_t count);
+	void FillFloat(f32 *out, size_t count, f32 min = 0.f, f32 max = 1.f);
+
+	// UniformRandomBitGenerator, for use with <random> distributions
+	static constexpr result_type min() { return 0; }
+	static constexpr result_type max() { return std::numeric_limits<result_type>::max(); }
+	inline result_type operator()() { return Next(); }
+
   private:
-	std::random_device _device;
-	std::mt19937 e1;
+	static constexpr size_t LaneCount = 4;
+
+	static inline u64 rotl(u64 x, int k) {
+		return (x << k) | (x >> (64 - k));
+	}
+
+	void stepLanes(u64 *out);
+	// Applies the 2^128 jump polynomial to one 4 word state
+	static void jumpState(u64 *state);
+
+	u64 _seed = 0;
+	u64 _s[4];
+	// Lane states, stored word major: _lanes[word][lane]
+	u64 _lanes[4][LaneCount];
 };
 
 #endif // RANDOM_NUMBER_GENERATOR_HPP
\ No newline at end of file
@@ -14,6 +14,8 @@
 
 #include "gui.hpp"
 #include "resource/audio_stream.hpp"
+#include "resource/image_texture.hpp"
+#include "resource/prefab.hpp"
 #include "resource/sprite_sheet_animation.hpp"
 
 #define ICONS_BEGIN 0xE800
@@ -57,6 +59,9 @@ struct DragDropData {
 static DragDropData _sDragDropData;
 
 static bool _sShowStyleWindow = false;
+static bool _sShowResourceMemory = false;
+// Texture whose import settings the resource memory window edits
+static RID _sSelectedTexture = 0;
 
 void Editor::Init() {
 	IMGUI_CHECKVERSION();
@@ -110,24 +115,28 @@ void Editor::Init() {
 	_fileLeftClickEvent[".sscn"] = [this](std::filesystem::path path) {
 		for (size_t i = 0; i < this->_scenes.size(); i++) {
 			if (this->_scenes[i]->GetFilepath().string() == path.string()) {
-				App().SetCurrentScene(this->_scenes[i]);
+				if (!this->_scenes[i]->IsLoading())
+					App().SetCurrentScene(this->_scenes[i]);
 				return;
 			}
 		}
 
-		Ref<Scene> scene = _scenes.emplace_back(App().NewScene());
-		scene->LoadFromFile(path.string().c_str());
-
-		this->_ignoreOnSceneChanged = true;
-		App().SetCurrentScene(scene);
-		this->_ignoreOnSceneChanged = false;
+		// The scene is listed right away with its load progress, and opened once loaded
+		Ref<Scene> scene = App().LoadSceneAsync(path.string().c_str(), [this](Ref<Scene> loaded) {
+			this->_ignoreOnSceneChanged = true;
+			App().SetCurrentScene(loaded);
+			this->_ignoreOnSceneChanged = false;
+		});
+		if (scene)
+			_scenes.push_back(scene);
 	};
+	_fileLeftClickEvent[".sscnb"] = _fileLeftClickEvent[".sscn"];
 
 	auto imageContextMenu = [this](std::filesystem::path path) {
 		if (ImGui::MenuItem("Import to scene")) {
-			ImageTexture *texture = App().GetResourceRegistry().NewResource<ImageTexture>();
-			texture->Load(path.string().c_str());
-			App().GetResourceRegistry().AddResource(texture);
+			ResourceRef texture = App().GetResourceRegistry().Load<ImageTexture>(path);
+			if (texture && !App().GetCurrentScene()->HoldResource(texture))
+				Debug::Info("'{}' is already imported", path.string());
 		}
 	};
 	_fileContextMenu[".png"] = imageContextMenu;
@@ -136,9 +145,9 @@ void Editor::Init() {
 
 	auto audioContextMenu = [this](std::filesystem::path path) {
 		if (ImGui::MenuItem("Import to scene")) {
-			AudioStream *audio = App().GetResourceRegistry().NewResource<AudioStream>();
-			audio->Load(path.string().c_str());
-			App().GetResourceRegistry().AddResource(audio);
+			ResourceRef audio = App().GetResourceRegistry().Load<AudioStream>(path);
+			if (audio && !App().GetCurrentScene()->HoldResource(audio))
+				Debug::Info("'{}' is already imported", path.string());
 		}
 	};
 	_fileContextMenu[".wav"] = audioContextMenu;
@@ -203,6 +212,10 @@ void Editor::Update() {
 		}
 		if (ImGui::BeginMenu("  Debug  ")) {
 			ImGui::Checkbox("Show style window", &_sShowStyleWindow);
+			ImGui::Checkbox("Show resource memory", &_sShowResourceMemory);
+			ImGui::Separator();
+			ImGui::Text("2D batches: %u", App().GetRenderer().GetRenderer2D("2D").GetBatchCount());
+			ImGui::Text("Text batches: %u", App().GetRenderer().GetRenderer2D("Text").GetBatchCount());
 			ImGui::EndMenu();
 		}
 		ImGui::EndMainMenuBar();
@@ -245,7 +258,7 @@ void Editor::Update() {
 	ImGui::End();
 
 	if (_currentAnimation != 0) {
-		SpriteSheetAnimation *anim = dynamic_cast<SpriteSheetAnimation *>(App().GetResourceRegistry().GetResource(_currentAnimation));
+		SpriteSheetAnimation *anim = App().GetResourceRegistry().GetResource<SpriteSheetAnimation>(_currentAnimation);
 		if (anim) {
 			if (ImGui::Begin(ICON_HIERARCHY "  Animation###Animation")) {
 
@@ -309,7 +322,7 @@ void Editor::Update() {
 					ImGui::SetNextItemWidth(120.f);
 					ImGui::DragFloat("Speed", &sheet->speed, 0.1f, 0.f, FLT_MAX, "%.3f", ImGuiSliderFlags_AlwaysClamp);
 
-					ImageTexture *tex = dynamic_cast<ImageTexture *>(App().GetResourceRegistry().GetResource(sheet->texture));
+					ImageTexture *tex = App().GetResourceRegistry().GetResource<ImageTexture>(sheet->texture);
 					if (tex) {
 						static float textureScale = 1.f;
 						ImGui::SliderFloat("Scale", &textureScale, 0.1f, 10.f);
@@ -338,6 +351,8 @@ void Editor::Update() {
 								imageTopLeft.x -= ImGui::GetScrollX();
 								imageTopLeft.y -= ImGui::GetScrollY();
 
+								glm::vec2 uv0 = tex->MapUV(glm::vec2(x * uvSize.x, (invertedY * uvSize.y) + uvSize.y));
+								glm::vec2 uv1 = tex->MapUV(glm::vec2((x * uvSize.x) + uvSize.x, (invertedY * uvSize.y)));
 								if (ImGui::ImageButton(
 										"Image",
 										(ImTextureID)(intptr_t)tex->ID(),
@@ -345,8 +360,8 @@ void Editor::Update() {
 											tex->Width() * textureScale / sheet->gridSize.x,
 											tex->Height() * textureScale / sheet->gridSize.y),
 
-										ImVec2(x * uvSize.x, (invertedY * uvSize.y) + uvSize.y),
-										ImVec2((x * uvSize.x) + uvSize.x, (invertedY * uvSize.y))
+										ImVec2(uv0.x, uv0.y),
+										ImVec2(uv1.x, uv1.y)
 										// ImVec2((x * (sheet->gridSize.x + 1) * uvSize.x) + uvSize.x, (y * sheet->gridSize.y * uvSize.y) + uvSize.y)
 										// ImVec2(1, 0)
 										)) {
@@ -387,18 +402,105 @@ void Editor::Update() {
 		ImGui::End();
 	}
 
+	if (_sShowResourceMemory) {
+		ImGui::Begin("Resource memory", &_sShowResourceMemory, ImGuiWindowFlags_NoSavedSettings);
+		if (ImGui::BeginTable("##Table", 4, ImGuiTableFlags_Borders)) {
+			ImGui::TableSetupColumn("Type");
+			ImGui::TableSetupColumn("Count (cached)");
+			ImGui::TableSetupColumn("CPU KiB");
+			ImGui::TableSetupColumn("GPU KiB");
+			ImGui::TableHeadersRow();
+
+			for (auto &[type, stats] : App().GetResourceRegistry().GetMemoryStats()) {
+				ImGui::TableNextColumn();
+				ImGui::Text("%s", App().GetResourceRegistry().GetTypeName(type).c_str());
+				ImGui::TableNextColumn();
+				ImGui::Text("%u (%u)", stats.count, stats.cached);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.1f", stats.memory.cpu / 1024.0);
+				ImGui::TableNextColumn();
+				ImGui::Text("%.1f", stats.memory.gpu / 1024.0);
+			}
+			ImGui::EndTable();
+		}
+
+		if (ImGui::CollapsingHeader("Textures")) {
+			ResourceRegistry &registry = App().GetResourceRegistry();
+			u64 total = 0;
+			if (ImGui::BeginTable("##Textures", 4, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+				ImGui::TableSetupColumn("Path");
+				ImGui::TableSetupColumn("Size");
+				ImGui::TableSetupColumn("Format");
+				ImGui::TableSetupColumn("GPU KiB");
+				ImGui::TableHeadersRow();
+
+				registry.ForEachResource<ImageTexture>([&total](ImageTexture *texture) {
+					ResourceMemory memory = texture->GetMemoryUsage();
+					total += memory.gpu;
+
+					const std::string &path = texture->Filepath().String();
+					std::string label = Utils::Format("{}##{}", path.empty() ? "(generated)" : path, texture->GetRID());
+					ImGui::TableNextColumn();
+					if (ImGui::Selectable(label.c_str(), _sSelectedTexture == texture->GetRID(), ImGuiSelectableFlags_SpanAllColumns))
+						_sSelectedTexture = texture->GetRID();
+					ImGui::TableNextColumn();
+					ImGui::Text("%dx%d", texture->Width(), texture->Height());
+					ImGui::TableNextColumn();
+					ImGui::Text("%s%s%s", TextureCache::FormatName(texture->StorageFormat()), texture->GetImportSettings().mipmaps ? " + mips" : "", texture->IsAtlased() ? " (atlas)" : "");
+					ImGui::TableNextColumn();
+					ImGui::Text("%.1f", memory.gpu / 1024.0);
+				});
+				ImGui::EndTable();
+			}
+			ImGui::Text("Total: %.1f KiB", total / 1024.0);
+
+			if (ImageTexture *texture = registry.GetResource<ImageTexture>(_sSelectedTexture)) {
+				static const char *const filters[] = {"Nearest", "Linear"};
+				static const char *const wraps[] = {"Clamp to edge", "Repeat", "Mirrored repeat"};
+				static const char *const formats[] = {"RGBA8", "RGB565", "RGBA4444", "R8 (mask)"};
+#ifdef SW_WEB
+				// WebGL cannot draw R8 masks, see TextureImportSettings::format
+				const int formatCount = IM_ARRAYSIZE(formats) - 1;
+#else
+				const int formatCount = IM_ARRAYSIZE(formats);
+#endif
+
+				TextureImportSettings settings = texture->GetImportSettings();
+				int filter = static_cast<int>(settings.filter);
+				int wrap = static_cast<int>(settings.wrap);
+				int format = static_cast<int>(settings.format);
+
+				ImGui::Separator();
+				ImGui::Text("Import settings");
+				bool changed = ImGui::Combo("Filter", &filter, filters, IM_ARRAYSIZE(filters));
+				changed |= ImGui::Combo("Wrap", &wrap, wraps, IM_ARRAYSIZE(wraps));
+				changed |= ImGui::Combo("Format", &format, formats, formatCount);
+				changed |= ImGui::Checkbox("Mipmaps", &settings.mipmaps);
+				if (changed) {
+					settings.filter = static_cast<TextureFilter>(filter);
+					settings.wrap = static_cast<TextureWrap>(wrap);
+					settings.format = static_cast<TextureCache::Format>(format);
+					texture->SetImportSettings(settings);
+				}
+			}
+		}
+		ImGui::End();
+	}
+
 	ImGui::Begin(ICON_HIERARCHY "  Filesystem###Filesystem");
 	ImGui::BeginChild("##Window", ImVec2(ImGui::GetContentRegionAvail().x, ImGui::GetContentRegionAvail().y - ImGui::GetFrameHeight()));
 
 	bool openFileContext = false;
 	std::function<void(std::filesystem::path path)> drawDir;
 	drawDir = [&drawDir, this, &openFileContext](std::filesystem::path path) {
-		auto dir = App().FS().ReadDirectory(path);
+		// Cached until the folder changes on disk, only open folders are listed
+		const std::vector<FileEntry> &dir = App().FS().ListDirectory(path);
 
 		ImGuiTreeNodeFlags flags = ImGuiTreeNodeFlags_SpanFullWidth;
 
 		for (auto &entry : dir) {
-			if (!entry.is_directory)
+			// Imported textures, see TextureCache
+			if (!entry.is_directory || entry.path.filename() == ".import")
 				continue;
 
 			ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(0.f, 0.f));
@@ -503,7 +605,7 @@ void Editor::Update() {
 			ImGui::PushID(std::to_string(node->ID()).c_str());
 
 			ImVec4 textColor = ImVec4(1.f, 1.f, 1.f, 1.f);
-			if (Node2D *node2d = dynamic_cast<Node2D *>(node); node2d != nullptr && !node2d->IsVisible()) {
+			if (Node2D *node2d = node_cast<Node2D>(node); node2d != nullptr && !node2d->IsVisible()) {
 				textColor = ImVec4(0.65f, 0.65f, 0.65f, 1.f);
 			}
 
@@ -559,13 +661,14 @@ void Editor::Update() {
 			ImGui::SetNextItemAllowOverlap();
 			ImGui::SameLine();
 			ImGui::TextColored(textColor, "%s", node->Name().c_str());
-			if (Node2D *node2d = dynamic_cast<Node2D *>(node); node2d != nullptr) {
+			if (Node2D *node2d = node_cast<Node2D>(node); node2d != nullptr) {
 				ImGui::SameLine();
 				ImGui::SetCursorPosX(ImGui::GetWindowContentRegionMax().x - 18);
 
 				ImGui::PushStyleColor(ImGuiCol_Button, ImVec4(0.f, 0.f, 0.f, 0.f));
 				if (ImGui::Button(node2d->_visible ? ICON_VISIBLE : ICON_HIDDEN)) {
 					node2d->_visible = !node2d->_visible;
+					node2d->MarkDirty();
 				}
 				ImGui::PopStyleColor();
 			}
@@ -605,7 +708,17 @@ void Editor::Update() {
 					selectedNode->Free();
 				}
 
-				if (Camera2D *camera = dynamic_cast<Camera2D *>(selectedNode); nullptr != camera) {
+				if (ImGui::Selectable("Create Prefab")) {
+					// Owned here until the registry takes it, a prefab that fails to compile is deleted
+					std::unique_ptr<Prefab> prefab(App().GetResourceRegistry().NewResource<Prefab>());
+					if (prefab && prefab->Compile(selectedNode)) {
+						Prefab *added = prefab.release();
+						App().GetResourceRegistry().AddResource(added);
+						Debug::Info("Created prefab {} from '{}' ({} nodes)", added->GetRID(), selectedNode->Name(), added->NodeCount());
+					}
+				}
+
+				if (Camera2D *camera = node_cast<Camera2D>(selectedNode); nullptr != camera) {
 					if (ImGui::Selectable("Make Current")) {
 						camera->MakeCurrent();
 					}
@@ -672,7 +785,9 @@ void Editor::Update() {
 			ImGui::Text("%s", _scenes[i]->GetFilepath().c_str());
 			ImGui::SameLine();
 
-			if (ImGui::Button("Open")) {
+			if (_scenes[i]->IsLoading()) {
+				ImGui::ProgressBar(_scenes[i]->GetLoadProgress(), ImVec2(120.f, 0.f));
+			} else if (ImGui::Button("Open")) {
 				App().SetCurrentScene(_scenes[i]);
 			}
 
@@ -686,7 +801,7 @@ void Editor::Update() {
 		ImGui::Indent();
 
 		if (scene) {
-			Camera2D *camera = dynamic_cast<Camera2D *>(scene->GetNode(scene->GetCurrentCamera2D()));
+			Camera2D *camera = node_cast<Camera2D>(scene->GetNode(scene->GetCurrentCamera2D()));
 			if (camera) {
 				ImGui::Text("2D Camera: \"%s\"", camera->Name().c_str());
 
@@ -11,32 +11,34 @@ bool Gui::TexturePicker(const char *id, RID &rid) {
 	ImGui::PushID(id);
 
 	ImTextureID textureID = 0;
+	glm::vec2 uv0(0.f, 1.f);
+	glm::vec2 uv1(1.f, 0.f);
 
-	ImageTexture *res = dynamic_cast<ImageTexture *>(App().GetResourceRegistry().GetResource(rid));
+	ImageTexture *res = App().GetResourceRegistry().GetResource<ImageTexture>(rid);
 	if (res) {
 		textureID = (void *)(intptr_t)(res->ID());
+		uv0 = res->MapUV(uv0);
+		uv1 = res->MapUV(uv1);
 	}
 
-	if (ImGui::ImageButton("##Image", textureID, ImVec2(64, 64), ImVec2(0, 1), ImVec2(1, 0))) {
+	if (ImGui::ImageButton("##Image", textureID, ImVec2(64, 64), ImVec2(uv0.x, uv0.y), ImVec2(uv1.x, uv1.y))) {
 		ImGui::OpenPopup("##TexturePicker");
 	}
 
 	if (ImGui::BeginPopup("##TexturePicker" /*, ImGuiWindowFlags_NoMove */)) {
 		ImGui::BeginTable("##Table", 6);
 
-		for (auto &[id, res] : App().GetResourceRegistry().GetResources()) {
-			ImageTexture *texture = dynamic_cast<ImageTexture *>(res);
-			if (!texture)
-				continue;
-
+		App().GetResourceRegistry().ForEachResource<ImageTexture>([&](ImageTexture *texture) {
 			ImGui::TableNextColumn();
 
-			if (ImGui::ImageButton(std::to_string(id).c_str(), (void *)(intptr_t)texture->ID(), ImVec2(128, 128), ImVec2(0, 1), ImVec2(1, 0))) {
-				rid = id;
+			glm::vec2 uv0 = texture->MapUV(glm::vec2(0.f, 1.f));
+			glm::vec2 uv1 = texture->MapUV(glm::vec2(1.f, 0.f));
+			if (ImGui::ImageButton(std::to_string(texture->GetRID()).c_str(), (void *)(intptr_t)texture->ID(), ImVec2(128, 128), ImVec2(uv0.x, uv0.y), ImVec2(uv1.x, uv1.y))) {
+				rid = texture->GetRID();
 				changed = true;
 				ImGui::CloseCurrentPopup();
 			}
-		}
+		});
 
 		ImGui::EndTable();
 		ImGui::EndPopup();
@@ -46,9 +48,10 @@ bool Gui::TexturePicker(const char *id, RID &rid) {
 	return changed;
 }
 
-void Gui::AnimationInput(const char *id, RID &rid) {
+bool Gui::AnimationInput(const char *id, RID &rid) {
 	ImGui::PushID(id);
 
+	RID previous = rid;
 	ImGui::InputInt("##RID", &rid);
 	if (rid == 0) {
 		if (ImGui::Button("Create")) {
@@ -68,6 +71,7 @@ void Gui::AnimationInput(const char *id, RID &rid) {
 	}
 
 	ImGui::PopID();
+	return rid != previous;
 }
 
 bool Gui::BeginFooter(const char *label) {
@@ -6,7 +6,7 @@
 
 namespace Gui {
 bool TexturePicker(const char *id, RID &rid);
-void AnimationInput(const char *id, RID &rid);
+bool AnimationInput(const char *id, RID &rid);
 
 bool BeginFooter(const char *label);
 void EndFooter();
@@ -14,6 +14,11 @@ class Rect {
 	inline float Bottom() { return y; }
 	inline float Top() { return y + h; }
 
+	inline bool Contains(float px, float py) const { return px >= x && px <= x + w && py >= y && py <= y + h; }
+	inline bool Intersects(const Rect &other) const {
+		return x <= other.x + other.w && other.x <= x + w && y <= other.y + other.h && other.y <= y + h;
+	}
+
 	Rect() = default;
 	Rect(float x, float y) : x(x), y(y), w(0.f), h(0.f) {}
 	Rect(float x, float y, float w, float h) : x(x), y(y), w(w), h(h) {}
@@ -1,30 +1,40 @@
 #include "audio_stream.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
 #include <vector>
 
+#include "AL/al.h"
 #include "AL/alext.h"
 #include "sndfile.h"
 
 #include "core/application.hpp"
 #include "core/debug.hpp"
 
+// Reads straight from the loaded file
 struct sf_func_data {
-	std::vector<std::byte> data;
+	const std::byte *data = nullptr;
+	sf_count_t size = 0;
 	sf_count_t offset = 0;
 };
 
 static sf_count_t sf_func_get_file_len(void *userdata) {
 	sf_func_data *func_data = reinterpret_cast<sf_func_data *>(userdata);
-	return func_data->data.size();
+	return func_data->size;
 }
 
 static sf_count_t sf_func_read(void *ptr, sf_count_t count, void *userdata) {
 	sf_func_data *func_data = reinterpret_cast<sf_func_data *>(userdata);
-	if (static_cast<size_t>(func_data->offset + count) > func_data->data.size()) {
-		count = func_data->data.size() - func_data->offset;
+	if (func_data->offset + count > func_data->size) {
+		count = func_data->size - func_data->offset;
 	}
+	if (count <= 0)
+		return 0;
 
-	memcpy(ptr, func_data->data.data() + func_data->offset, count);
+	memcpy(ptr, func_data->data + func_data->offset, count);
 	func_data->offset += count;
 	return count;
 }
@@ -37,7 +47,7 @@ static sf_count_t sf_func_seek(sf_count_t offset, int whence, void *userdata) {
 	} else if (whence == SEEK_CUR) {
 		func_data->offset += offset;
 	} else if (whence == SEEK_END) {
-		func_data->offset = func_data->data.size() - offset;
+		func_data->offset = func_data->size + offset;
 	}
 
 	return func_data->offset;
@@ -53,6 +63,137 @@ static sf_count_t sf_func_write(const void *data, sf_count_t count, void *userda
 	return 0;
 }
 
+// An opened sound file reading from a FileData it keeps alive. Not movable, libsndfile holds a pointer to data
+struct SoundFile {
+	Ref<FileData> file;
+	sf_func_data data;
+	SNDFILE *handle = nullptr;
+	SF_INFO info = {};
+	ALenum format = AL_NONE;
+
+	SoundFile() = default;
+	SoundFile(const SoundFile &) = delete;
+	SoundFile &operator=(const SoundFile &) = delete;
+	~SoundFile() {
+		if (handle)
+			sf_close(handle);
+	}
+
+	bool Open(Ref<FileData> source, const char *path) {
+		file = source;
+		data.data = file->Data();
+		data.size = static_cast<sf_count_t>(file->Size());
+
+		SF_VIRTUAL_IO io;
+		io.get_filelen = sf_func_get_file_len;
+		io.read = sf_func_read;
+		io.seek = sf_func_seek;
+		io.tell = sf_func_tell;
+		io.write = sf_func_write;
+
+		handle = sf_open_virtual(&io, SFM_READ, &info, &data);
+		if (!handle) {
+			Debug::Error("Failed to open audio file {}", path);
+			return false;
+		}
+
+		if (info.frames < 1 || info.samplerate < 1) {
+			Debug::Error("Bad sample count");
+			return false;
+		}
+
+		if (info.channels == 1) {
+			format = AL_FORMAT_MONO16;
+		} else if (info.channels == 2) {
+			format = AL_FORMAT_STEREO16;
+		} else if (info.channels == 3) {
+			if (sf_command(handle, SFC_WAVEX_GET_AMBISONIC, NULL, 0) == SF_AMBISONIC_B_FORMAT) {
+				format = AL_FORMAT_BFORMAT2D_16;
+			}
+		} else if (info.channels == 4) {
+			if (sf_command(handle, SFC_WAVEX_GET_AMBISONIC, NULL, 0) == SF_AMBISONIC_B_FORMAT) {
+				format = AL_FORMAT_BFORMAT3D_16;
+			}
+		}
+
+		if (!format) {
+			Debug::Error("Unsupported channel count: {}", info.channels);
+			return false;
+		}
+		return true;
+	}
+};
+
+// Shared by a playback and its decode jobs, which may outlive it
+struct AudioStreamPlayback::Decoder {
+	SoundFile sound;
+	sf_count_t chunkFrames = 0;
+	std::atomic<bool> loop{false};
+
+	std::mutex mutex;
+	std::deque<std::vector<short>> decoded;
+	// Storage of queued chunks, reused for the next ones
+	std::vector<std::vector<short>> spare;
+	bool ended = false;
+
+	// Decodes chunks until count are waiting or the file ends. One call at a time
+	void Fill(u32 count) {
+		for (;;) {
+			std::vector<short> chunk;
+			{
+				std::lock_guard<std::mutex> lock(mutex);
+				if (ended || decoded.size() >= count)
+					return;
+				if (!spare.empty()) {
+					chunk = std::move(spare.back());
+					spare.pop_back();
+				}
+			}
+
+			int channels = sound.info.channels;
+			chunk.resize(static_cast<size_t>(chunkFrames * channels));
+			sf_count_t frames = 0;
+			bool rewound = false;
+			bool end = false;
+			while (frames < chunkFrames) {
+				sf_count_t read = sf_readf_short(sound.handle, chunk.data() + frames * channels, chunkFrames - frames);
+				if (read > 0) {
+					frames += read;
+					rewound = false;
+				} else if (loop && !rewound) {
+					sf_seek(sound.handle, 0, SEEK_SET);
+					rewound = true;
+				} else {
+					end = true;
+					break;
+				}
+			}
+			chunk.resize(static_cast<size_t>(frames * channels));
+
+			std::lock_guard<std::mutex> lock(mutex);
+			if (!chunk.empty())
+				decoded.push_back(std::move(chunk));
+			ended = end;
+		}
+	}
+
+	// Only while no job runs
+	void Rewind() {
+		sf_seek(sound.handle, 0, SEEK_SET);
+		std::lock_guard<std::mutex> lock(mutex);
+		while (!decoded.empty()) {
+			spare.push_back(std::move(decoded.front()));
+			decoded.pop_front();
+		}
+		ended = false;
+	}
+
+	bool NeedsMore() {
+		std::lock_guard<std::mutex> lock(mutex);
+		return !ended && decoded.size() < BufferCount;
+	}
+};
+
 AudioStream::AudioStream() {
 	_resourceType = typeid(AudioStream).hash_code();
 }
@@ -62,97 +203,86 @@ AudioStream::~AudioStream() {
 }
 
 void AudioStream::Load(const char *path) {
-	_filepath = "";
+	Decode(path);
+	Upload();
+}
+
+bool AudioStream::Decode(const char *path) {
+	_samples.clear();
+	_decodedFile.reset();
+	_format = AL_NONE;
+	_decodedPath = "";
 
-	Delete();
 	Ref<FileData> file = App().FS().Load(path);
 	if (!file) {
 		Debug::Error("Failed to load file: {}", path);
-		return;
+		return false;
 	}
 
-	ALenum err, format;
-	ALuint buffer;
-	SNDFILE *sndfile;
-	SF_INFO sfinfo;
-	short *membuf;
-	sf_count_t numFrames;
-	ALsizei numBytes;
-
-	std::vector<std::byte> bytes;
-	bytes.resize(file->Size());
-	memcpy(bytes.data(), file->Data(), file->Size());
-
-	SF_VIRTUAL_IO io;
-	io.get_filelen = sf_func_get_file_len;
-	io.read = sf_func_read;
-	io.seek = sf_func_seek;
-	io.tell = sf_func_tell;
-	io.write = sf_func_write;
-
-	sf_func_data func_data;
-	func_data.data = bytes;
-	func_data.offset = 0;
-
-	sndfile = sf_open_virtual(&io, SFM_READ, &sfinfo, &func_data);
-	if (!sndfile) {
-		Debug::Error("Failed to open audio file {}", path);
-		return;
+	SoundFile sound;
+	if (!sound.Open(file, path))
+		return false;
+
+	// Long assets are decoded as they play, a few minutes of PCM would take tens of megabytes
+	if (static_cast<f64>(sound.info.frames) / sound.info.samplerate > StreamMinDuration) {
+		// Playback reads the file for minutes, a mapped file truncated meanwhile would crash the decode jobs with SIGBUS
+		_decodedFile = FileData::NewDetached(file);
+		_format = sound.format;
+		_sampleRate = sound.info.samplerate;
+		_decodedPath = path;
+		return true;
 	}
 
-	if (sfinfo.frames < 1 || sfinfo.frames > (sf_count_t)(INT32_MAX / sizeof(short)) / sfinfo.channels) {
+	if (sound.info.frames > (sf_count_t)(INT32_MAX / sizeof(short)) / sound.info.channels) {
 		Debug::Error("Bad sample count");
-		return;
+		return false;
 	}
 
-	format = AL_NONE;
-	if (sfinfo.channels == 1) {
-		format = AL_FORMAT_MONO16;
-	} else if (sfinfo.channels == 2) {
-		format = AL_FORMAT_STEREO16;
-	} else if (sfinfo.channels == 3) {
-		if (sf_command(sndfile, SFC_WAVEX_GET_AMBISONIC, NULL, 0) == SF_AMBISONIC_B_FORMAT) {
-			format = AL_FORMAT_BFORMAT2D_16;
-		}
-	} else if (sfinfo.channels == 4) {
-		if (sf_command(sndfile, SFC_WAVEX_GET_AMBISONIC, NULL, 0) == SF_AMBISONIC_B_FORMAT) {
-			format = AL_FORMAT_BFORMAT3D_16;
-		}
+	_samples.resize((size_t)(sound.info.frames * sound.info.channels));
+	sf_count_t numFrames = sf_readf_short(sound.handle, _samples.data(), sound.info.frames);
+	if (numFrames < 1) {
+		_samples.clear();
+		Debug::Error("Failed to read samples");
+		return false;
 	}
 
-	if (!format) {
-		Debug::Error("Unsupported channel count: {}", sfinfo.channels);
-		sf_close(sndfile);
-		return;
-	}
+	_samples.resize((size_t)(numFrames * sound.info.channels));
+	_format = sound.format;
+	_sampleRate = sound.info.samplerate;
+	_decodedPath = path;
+	return true;
+}
 
-	membuf = static_cast<short *>(malloc((size_t)(sfinfo.frames * sfinfo.channels) * sizeof(short)));
-	numFrames = sf_readf_short(sndfile, membuf, sfinfo.frames);
-	if (numFrames < 1) {
-		free(membuf);
-		sf_close(sndfile);
-		Debug::Error("Failed to read samples");
+void AudioStream::Upload() {
+	_filepath = "";
+	Delete();
+
+	if (_decodedFile) {
+		_streamFile = std::move(_decodedFile);
+		_filepath = _decodedPath;
 		return;
 	}
 
-	numBytes = (ALsizei)(numFrames * sfinfo.channels) * (ALsizei)sizeof(short);
+	if (_samples.empty())
+		return;
 
-	buffer = 0;
+	ALuint buffer = 0;
 	alGenBuffers(1, &buffer);
-	alBufferData(buffer, format, membuf, numBytes, sfinfo.samplerate);
-
+	alBufferData(buffer, _format, _samples.data(), (ALsizei)(_samples.size() * sizeof(short)), _sampleRate);
 	_id = buffer;
-	free(membuf);
-	sf_close(sndfile);
+	_bufferSize = _samples.size() * sizeof(short);
 
-	err = alGetError();
+	_samples.clear();
+	_samples.shrink_to_fit();
+
+	ALenum err = alGetError();
 	if (err != AL_NO_ERROR) {
 		Debug::Error("AL ERROR: {}", alGetString(err));
 		Delete();
 		return;
 	}
 
-	_filepath = path;
+	_filepath = _decodedPath;
 }
 
 void AudioStream::Delete() {
@@ -160,4 +290,138 @@ void AudioStream::Delete() {
 		alDeleteBuffers(1, &_id);
 
 	_id = 0;
+	_bufferSize = 0;
+	_streamFile.reset();
+}
+
+ResourceMemory AudioStream::GetMemoryUsage() const {
+	ResourceMemory memory;
+	memory.cpu = _samples.size() * sizeof(short);
+	// Streamed assets keep their encoded file
+	if (_decodedFile)
+		memory.cpu += _decodedFile->Size();
+	if (_streamFile)
+		memory.cpu += _streamFile->Size();
+	memory.gpu = _bufferSize;
+	return memory;
+}
+
+std::unique_ptr<AudioStreamPlayback> AudioStream::NewPlayback(uint32_t source) const {
+	if (!_streamFile)
+		return nullptr;
+
+	Ref<AudioStreamPlayback::Decoder> decoder = std::make_shared<AudioStreamPlayback::Decoder>();
+	if (!decoder->sound.Open(_streamFile, Filepath().String().c_str()))
+		return nullptr;
+
+	decoder->chunkFrames = std::max(decoder->sound.info.samplerate / static_cast<int>(AudioStreamPlayback::ChunksPerSecond), 1);
+	return std::unique_ptr<AudioStreamPlayback>(new AudioStreamPlayback(decoder, source));
+}
+
+AudioStreamPlayback::AudioStreamPlayback(Ref<Decoder> decoder, uint32_t source) : _decoder(decoder), _source(source) {
+	alGenBuffers(BufferCount, _buffers);
+	_free.assign(_buffers, _buffers + BufferCount);
+}
+
+AudioStreamPlayback::~AudioStreamPlayback() {
+	// A running job keeps the decoder alive, it does not touch the buffers
+	Stop();
+	alDeleteBuffers(BufferCount, _buffers);
+}
+
+void AudioStreamPlayback::Play(bool loop) {
+	Stop();
+	if (_job.valid())
+		_job.wait();
+
+	_decoder->loop = loop;
+	_decoder->Rewind();
+	_decoder->Fill(1);
+	queueDecoded();
+	alSourcePlay(_source);
+
+	_active = true;
+	App().GetAudioServer().addPlayback(this);
+	scheduleDecode();
+}
+
+void AudioStreamPlayback::Stop() {
+	alSourceStop(_source);
+	// Detaching the queue frees every buffer at once
+	alSourcei(_source, AL_BUFFER, 0);
+	_free.assign(_buffers, _buffers + BufferCount);
+
+	if (_active) {
+		_active = false;
+		App().GetAudioServer().removePlayback(this);
+	}
+}
+
+void AudioStreamPlayback::SetLoop(bool loop) {
+	_decoder->loop = loop;
+}
+
+bool AudioStreamPlayback::IsOf(const AudioStream &stream) const {
+	return stream._streamFile == _decoder->sound.file;
+}
+
+bool AudioStreamPlayback::update() {
+	ALint processed = 0;
+	alGetSourcei(_source, AL_BUFFERS_PROCESSED, &processed);
+	for (ALint i = 0; i < processed; i++) {
+		ALuint buffer = 0;
+		alSourceUnqueueBuffers(_source, 1, &buffer);
+		_free.push_back(buffer);
+	}
+	queueDecoded();
+
+	// A source that runs out of queued buffers stops. Started again once decoding caught up, done once the stream ended
+	ALint state = 0, queued = 0;
+	alGetSourcei(_source, AL_SOURCE_STATE, &state);
+	alGetSourcei(_source, AL_BUFFERS_QUEUED, &queued);
+	if (state == AL_STOPPED) {
+		if (queued > 0) {
+			alSourcePlay(_source);
+		} else if (!_decoder->NeedsMore()) {
+			_active = false;
+			return false;
+		}
+	}
+
+	scheduleDecode();
+	return true;
+}
+
+void AudioStreamPlayback::queueDecoded() {
+	std::vector<std::vector<short>> chunks;
+	{
+		std::lock_guard<std::mutex> lock(_decoder->mutex);
+		while (chunks.size() < _free.size() && !_decoder->decoded.empty()) {
+			chunks.push_back(std::move(_decoder->decoded.front()));
+			_decoder->decoded.pop_front();
+		}
+	}
+
+	const SoundFile &sound = _decoder->sound;
+	for (std::vector<short> &chunk : chunks) {
+		ALuint buffer = _free.back();
+		_free.pop_back();
+		alBufferData(buffer, sound.format, chunk.data(), (ALsizei)(chunk.size() * sizeof(short)), sound.info.samplerate);
+		alSourceQueueBuffers(_source, 1, &buffer);
+	}
+
+	std::lock_guard<std::mutex> lock(_decoder->mutex);
+	for (std::vector<short> &chunk : chunks)
+		_decoder->spare.push_back(std::move(chunk));
+}
+
+void AudioStreamPlayback::scheduleDecode() {
+	if (_job.valid() && _job.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		return;
+	if (!_decoder->NeedsMore())
+		return;
+
+	_job = App().GetThreadPool().Submit([decoder = _decoder]() {
+		decoder->Fill(BufferCount);
+	});
 }
\ No newline at end of file
@@ -3,32 +3,117 @@
 #pragma once
 
 #include <cstdint>
+#include <future>
+#include <memory>
+#include <vector>
 
 #include "core/resource.hpp"
 
+struct FileData;
+class AudioStreamPlayback;
+
 class AudioStream : public Resource {
   public:
 	AudioStream();
 	virtual ~AudioStream();
 
+	// Assets longer than this many seconds are streamed instead of decoded whole
+	static constexpr f64 StreamMinDuration = 10.0;
+
 	void LoadResource(const Document &doc) override {
+		DecodeResource(doc);
+		UploadResource();
+	}
+
+	bool HasDecodePhase() override { return true; }
+	void DecodeResource(const Document &doc) override {
 		std::string path = doc.Get("Path", std::string(""));
 		if (path != "")
-			Load(path.c_str());
+			Decode(path.c_str());
 	}
+	void UploadResource() override { Upload(); }
+	ResourceMemory GetMemoryUsage() const override;
 
 	void SaveResource(Document &doc) override {
-		doc.Set("Path", Filepath());
+		doc.Set("Path", Filepath().String());
 	}
 
 	void Load(const char *path);
+	// Decodes all samples of short assets into memory, Upload fills the AL buffer with them. Long assets only keep the
+	// file, each AudioStreamPlayback decodes it while it plays
+	bool Decode(const char *path);
+	void Upload();
 
 	void Delete();
 
+	// Buffer holding the whole asset, 0 for streamed ones
 	inline uint32_t ID() const { return _id; }
+	inline bool IsStreamed() const { return _streamFile != nullptr; }
+	inline bool IsLoaded() const { return _id != 0 || IsStreamed(); }
+
+	// Plays a streamed asset on source, nullptr if the asset is not streamed or fails to open. Main thread only
+	std::unique_ptr<AudioStreamPlayback> NewPlayback(uint32_t source) const;
 
   private:
+	friend class AudioStreamPlayback;
+
 	uint32_t _id = 0;
+
+	std::vector<short> _samples;
+	int _format = 0;
+	int _sampleRate = 0;
+	// Bytes handed to the AL buffer
+	u64 _bufferSize = 0;
+	std::string _decodedPath = "";
+
+	// File of a long asset, moved to _streamFile on Upload
+	Ref<FileData> _decodedFile;
+	Ref<FileData> _streamFile;
+};
+
+// Streams an asset through a small ring of AL buffers queued on one source. Chunks are decoded ahead on the thread
+// pool straight from the loaded file and queued by AudioServer::Update on the main thread
+class AudioStreamPlayback {
+  public:
+	static constexpr u32 BufferCount = 4;
+	// Chunks are a quarter of a second, the ring holds one second ahead of the play position
+	static constexpr u32 ChunksPerSecond = 4;
+
+	~AudioStreamPlayback();
+	AudioStreamPlayback(const AudioStreamPlayback &) = delete;
+	AudioStreamPlayback &operator=(const AudioStreamPlayback &) = delete;
+
+	// Plays from the start. The first chunk is decoded before returning so the source starts right away
+	void Play(bool loop);
+	// Stops the source and drops what is queued
+	void Stop();
+	// Looping streams seek back to the start when decoding reaches the end
+	void SetLoop(bool loop);
+
+	// Whether the playback streams the file stream holds
+	bool IsOf(const AudioStream &stream) const;
+
+  private:
+	friend class AudioStream;
+	friend class AudioServer;
+
+	struct Decoder;
+
+	AudioStreamPlayback(Ref<Decoder> decoder, uint32_t source);
+
+	// Requeues played buffers with decoded chunks and schedules more decoding. Returns false once the stream ended and
+	// everything queued was played
+	bool update();
+	void queueDecoded();
+	void scheduleDecode();
+
+	Ref<Decoder> _decoder;
+	uint32_t _source = 0;
+	uint32_t _buffers[BufferCount] = {};
+	std::vector<uint32_t> _free;
+	// The decode job in flight, at most one runs per playback
+	std::future<void> _job;
+	bool _active = false;
 };
 
 #endif // AUDIO_STREAM_HPP
\ No newline at end of file
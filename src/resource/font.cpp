@@ -1,11 +1,18 @@
 #include "font.hpp"
 
+#include <cstring>
+#include <mutex>
+
 #include <ft2build.h>
 #include FT_FREETYPE_H
 
 #include "visual/gl.hpp"
 
 #include "core/application.hpp"
+#include "visual/visual.hpp"
+
+// Faces are decoded on worker threads. Creating and destroying faces of one library must be serialized
+static std::mutex s_FreeTypeMutex;
 
 static FT_Library GetFreeType() {
 	static FT_Library lib = nullptr;
@@ -15,6 +22,14 @@ static FT_Library GetFreeType() {
 }
 
 Font::~Font() {
+	if (Visual::Active()) {
+		for (auto &[charcode, character] : _characters) {
+			if (character.textureID != 0)
+				glDeleteTextures(1, &character.textureID);
+		}
+	}
+
+	std::lock_guard<std::mutex> lock(s_FreeTypeMutex);
 	FT_Done_Face(reinterpret_cast<FT_Face>(_face));
 }
 
@@ -23,23 +38,55 @@ Font::Font() {
 }
 
 void Font::Load(const char *path) {
-	_buffer = App().FS().Load(path);
+	if (Decode(path))
+		Upload();
+}
+
+void Font::LoadFromData(Ref<FileData> data) {
+	// FreeType reads glyphs from the buffer as they are first drawn, a mapped file truncated meanwhile would SIGBUS
+	_buffer = FileData::NewDetached(data);
 	if (!_buffer) {
 		return;
 	}
 
-	_filepath = path;
-	LoadFont();
+	_filepath = "";
+	if (decodeFont())
+		Upload();
 }
 
-void Font::LoadFromData(Ref<FileData> data) {
-	_buffer = data;
+bool Font::Decode(const char *path) {
+	_buffer = FileData::NewDetached(App().FS().Load(path));
 	if (!_buffer) {
-		return;
+		return false;
 	}
 
-	_filepath = "";
-	LoadFont();
+	_filepath = path;
+	return decodeFont();
+}
+
+void Font::Upload() {
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+	for (Glyph &glyph : _decodedGlyphs) {
+		uploadCharacter(glyph);
+	}
+	_decodedGlyphs.clear();
+	_decodedGlyphs.shrink_to_fit();
+}
+
+ResourceMemory Font::GetMemoryUsage() const {
+	ResourceMemory memory;
+	// FreeType reads the face from the file data for as long as it is open
+	memory.cpu = _buffer ? _buffer->Size() : 0;
+	for (const Glyph &glyph : _decodedGlyphs) {
+		memory.cpu += glyph.bitmap.size();
+	}
+
+	for (auto &[charcode, character] : _characters) {
+		u64 size = static_cast<u64>(character.size.x) * character.size.y;
+		memory.gpu += size + size / 3;
+	}
+	return memory;
 }
 
 uint32_t Font::GetGlyphTextureID(int charcode) {
@@ -62,53 +109,82 @@ glm::vec2 Font::CalcTextSize(const std::string &text) {
 	return size;
 }
 
-void Font::LoadFont() {
-	FT_Library freetype = GetFreeType();
-	if (FT_New_Memory_Face(freetype, (const unsigned char *)_buffer->Data(), _buffer->Size(), 0, reinterpret_cast<FT_Face *>(&_face))) {
-		return;
+bool Font::decodeFont() {
+	_decodedGlyphs.clear();
+	{
+		std::lock_guard<std::mutex> lock(s_FreeTypeMutex);
+		FT_Library freetype = GetFreeType();
+		if (_face) {
+			FT_Done_Face(reinterpret_cast<FT_Face>(_face));
+			_face = nullptr;
+		}
+		if (FT_New_Memory_Face(freetype, (const unsigned char *)_buffer->Data(), _buffer->Size(), 0, reinterpret_cast<FT_Face *>(&_face))) {
+			_face = nullptr;
+			return false;
+		}
 	}
 	FT_Set_Pixel_Sizes(reinterpret_cast<FT_Face>(_face), 0, 48);
 
 	if (FT_Load_Char(reinterpret_cast<FT_Face>(_face), 'X', FT_LOAD_RENDER)) {
-		return;
+		return false;
 	}
 
-	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
+	_decodedGlyphs.reserve(128);
 	for (int c = 0; c < 128; c++) {
-		LoadCharacter(c);
+		Glyph glyph;
+		if (decodeCharacter(c, glyph))
+			_decodedGlyphs.push_back(std::move(glyph));
 	}
+	return true;
 }
 
 void Font::LoadCharacter(int charcode) {
+	Glyph glyph;
+	if (decodeCharacter(charcode, glyph))
+		uploadCharacter(glyph);
+}
+
+bool Font::decodeCharacter(int charcode, Glyph &glyph) {
 	FT_Face face = reinterpret_cast<FT_Face>(_face);
-	FT_UInt glyphIndex = FT_Get_Char_Index(face, charcode);
+	if (!face) {
+		return false;
+	}
 
+	FT_UInt glyphIndex = FT_Get_Char_Index(face, charcode);
 	if (FT_Load_Glyph(face, glyphIndex, FT_LOAD_DEFAULT)) {
-		return;
+		return false;
 	}
 
 	if (FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL)) {
-		return;
+		return false;
+	}
+
+	const FT_Bitmap &bitmap = face->glyph->bitmap;
+	glyph.charcode = charcode;
+	glyph.bitmap.resize(static_cast<size_t>(bitmap.width) * bitmap.rows);
+	for (unsigned int row = 0; row < bitmap.rows; row++) {
+		std::memcpy(glyph.bitmap.data() + row * bitmap.width, bitmap.buffer + row * bitmap.pitch, bitmap.width);
 	}
 
+	glyph.character.size = glm::ivec2(bitmap.width, bitmap.rows);
+	glyph.character.bearing = glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top);
+	glyph.character.advance = static_cast<uint32_t>(face->glyph->advance.x);
+	return true;
+}
+
+void Font::uploadCharacter(Glyph &glyph) {
 	uint32_t tex = 0;
 	glGenTextures(1, &tex);
 	glBindTexture(GL_TEXTURE_2D, tex);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, face->glyph->bitmap.width, face->glyph->bitmap.rows, 0, GL_RED, GL_UNSIGNED_BYTE, face->glyph->bitmap.buffer);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, glyph.character.size.x, glyph.character.size.y, 0, GL_RED, GL_UNSIGNED_BYTE, glyph.bitmap.data());
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 
-	if (face->glyph->bitmap.width > 0 && face->glyph->bitmap.rows > 0)
+	if (glyph.character.size.x > 0 && glyph.character.size.y > 0)
 		glGenerateMipmap(GL_TEXTURE_2D);
 
-	Font::Character ch;
-	ch.textureID = tex;
-	ch.size = glm::ivec2(face->glyph->bitmap.width, face->glyph->bitmap.rows);
-	ch.bearing = glm::ivec2(face->glyph->bitmap_left, face->glyph->bitmap_top);
-	ch.advance = static_cast<uint32_t>(face->glyph->advance.x);
-
-	_characters[charcode] = ch;
-}
\ No newline at end of file
+	glyph.character.textureID = tex;
+	_characters[glyph.charcode] = glyph.character;
+}
@@ -5,6 +5,7 @@
 #include <glm/glm.hpp>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "core/filesystem/filesystem.hpp"
 #include "core/resource.hpp"
@@ -16,15 +17,26 @@ class Font : public Resource {
 
 	void Load(const char *path);
 	void LoadFromData(Ref<FileData> data);
+	// Sets up the face and renders the ASCII glyphs into memory, Upload creates their textures
+	bool Decode(const char *path);
+	void Upload();
 
 	void LoadResource(const Document &doc) override {
+		DecodeResource(doc);
+		UploadResource();
+	}
+
+	bool HasDecodePhase() override { return true; }
+	void DecodeResource(const Document &doc) override {
 		std::string path = doc.Get("Path", std::string(""));
 		if (path != "")
-			Load(path.c_str());
+			Decode(path.c_str());
 	}
+	void UploadResource() override { Upload(); }
+	ResourceMemory GetMemoryUsage() const override;
 
 	void SaveResource(Document &doc) override {
-		doc.Set("Path", Filepath());
+		doc.Set("Path", Filepath().String());
 	}
 
 	uint32_t GetGlyphTextureID(int charcode);
@@ -42,11 +54,22 @@ class Font : public Resource {
 	void LoadCharacter(int charcode);
 
   private:
-	void LoadFont();
+	struct Glyph {
+		int charcode = 0;
+		std::vector<unsigned char> bitmap;
+		Font::Character character;
+	};
+
+	bool decodeFont();
+	bool decodeCharacter(int charcode, Glyph &glyph);
+	void uploadCharacter(Glyph &glyph);
 
 	void *_face = nullptr;
 	Ref<FileData> _buffer;
 
+	// Glyphs rendered by Decode, waiting for Upload
+	std::vector<Glyph> _decodedGlyphs;
+
 	std::map<int, Font::Character> _characters;
 };
 
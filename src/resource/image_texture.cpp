@@ -8,6 +8,49 @@
 #include "stb_image.h"
 
 #include "core/application.hpp"
+#include "resource/texture_atlas.hpp"
+#include "resource/texture_cache.hpp"
+#include "visual/visual.hpp"
+
+static const char *const FilterNames[] = {"Nearest", "Linear"};
+static const char *const WrapNames[] = {"ClampToEdge", "Repeat", "MirroredRepeat"};
+
+// Index of name in names, fallback if it is not there
+template <typename T, size_t N>
+static T FindName(const char *const (&names)[N], const std::string &name, T fallback) {
+	for (size_t i = 0; i < N; i++)
+		if (name == names[i])
+			return static_cast<T>(i);
+	return fallback;
+}
+
+// Format textures asked to be imported as are stored in on this platform
+static TextureCache::Format SupportedFormat(TextureCache::Format format) {
+#ifdef SW_WEB
+	if (format == TextureCache::Format::R8)
+		return TextureCache::Format::RGBA8;
+#endif
+	return format;
+}
+
+void TextureImportSettings::Read(const Document &doc) {
+	filter = FindName(FilterNames, doc.GetString("Filter", ""), filter);
+	mipmaps = doc.GetBool("Mipmaps", mipmaps);
+	wrap = FindName(WrapNames, doc.GetString("Wrap", ""), wrap);
+
+	std::string formatName = doc.GetString("Format", "");
+	for (u16 i = 0; i < static_cast<u16>(TextureCache::Format::Count); i++)
+		if (formatName == TextureCache::FormatName(static_cast<TextureCache::Format>(i)))
+			format = static_cast<TextureCache::Format>(i);
+	format = SupportedFormat(format);
+}
+
+void TextureImportSettings::Write(Document &doc) const {
+	doc.SetString("Filter", FilterNames[static_cast<u8>(filter)]);
+	doc.SetBool("Mipmaps", mipmaps);
+	doc.SetString("Wrap", WrapNames[static_cast<u8>(wrap)]);
+	doc.SetString("Format", TextureCache::FormatName(format));
+}
 
 ImageTexture::ImageTexture() {
 	_resourceType = typeid(ImageTexture).hash_code();
@@ -19,7 +62,24 @@ ImageTexture::~ImageTexture() {
 
 void ImageTexture::Bind(int slot /*= 0*/) {
 	glActiveTexture(GL_TEXTURE0 + slot);
-	glBindTexture(GL_TEXTURE_2D, _id);
+	glBindTexture(GL_TEXTURE_2D, ID());
+}
+
+const unsigned char *ImageTexture::Pixels() const {
+	return _pixels ? reinterpret_cast<const unsigned char *>(_pixels->Data()) : nullptr;
+}
+
+uint32_t ImageTexture::ID() const {
+	return _atlasPage ? _atlasPage->ID() : _id;
+}
+
+void ImageTexture::SetAtlasPage(Ref<AtlasPage> page, const glm::vec4 &uvRect) {
+	Delete();
+	_atlasPage = page;
+	_uvRect = uvRect;
+
+	_pixels.reset();
+	_levels = 0;
 }
 
 void ImageTexture::Unbind() {
@@ -27,43 +87,208 @@ void ImageTexture::Unbind() {
 }
 
 void ImageTexture::Load(const char *path) {
+	Decode(path);
+	Upload();
+}
+
+bool ImageTexture::Decode(const char *path) {
+	_pixels.reset();
+	_levels = 0;
+
 	auto file = App().FS().Load(path);
 	if (!file) {
-		return;
+		return false;
+	}
+
+	u64 key = TextureCache::ImportKey(TextureCache::HashSource(*file), _settings.format, _settings.mipmaps);
+	TextureCache::Image image;
+	if (!TextureCache::Load(key, image)) {
+		// Decoding runs on worker threads, the flip flag is set per thread
+		int width = 0, height = 0, channels = 0;
+		stbi_set_flip_vertically_on_load_thread(true);
+		stbi_uc *pixels = stbi_load_from_memory(reinterpret_cast<stbi_uc *>(file->Data()), file->Size(), &width, &height, &channels, 4);
+		if (!pixels) {
+			std::cout << "Failed to load texture path:" << path << std::endl;
+			return false;
+		}
+
+		image = TextureCache::Import(pixels, width, height, channels, _settings.format, _settings.mipmaps);
+		stbi_image_free(pixels);
+		TextureCache::Save(key, image);
 	}
 
-	stbi_set_flip_vertically_on_load(true);
-	auto pixels = stbi_load_from_memory(reinterpret_cast<stbi_uc *>(file->Data()), file->Size(), &_width, &_height, &_channels, 4);
-	if (!pixels) {
+	_width = image.width;
+	_height = image.height;
+	_channels = image.channels;
+	_levels = image.levels;
+	_format = image.format;
+	_pixels = image.pixels;
+
+	_filepath = path;
+	return true;
+}
+
+void ImageTexture::Upload() {
+	// Packed images were uploaded with their atlas page
+	if (!_pixels && _atlasPage)
+		return;
+
+	if (!_pixels) {
 		Delete();
-		std::cout << "Failed to load texture path:" << path << std::endl;
 		return;
 	}
 
-	_filepath = path;
-	LoadFromData(pixels, _width, _height);
+	upload(reinterpret_cast<const unsigned char *>(_pixels->Data()), _levels, _format);
 
-	stbi_image_free(pixels);
+	_pixels.reset();
+	_levels = 0;
 }
 
-void ImageTexture::LoadFromData(unsigned char *data, int width, int height) {
-	Delete();
+bool ImageTexture::ReloadResource() {
+	std::string path = Filepath().String();
+	if (path.empty() || ID() == 0)
+		return false;
 
+	// A file caught halfway through being written fails to decode, the texture keeps its current image
+	int width = _width, height = _height, channels = _channels;
+	if (!Decode(path.c_str())) {
+		_width = width;
+		_height = height;
+		_channels = channels;
+		return false;
+	}
+
+	Upload();
+	return true;
+}
+
+void ImageTexture::LoadFromData(unsigned char *data, int width, int height) {
 	_width = width;
 	_height = height;
 	_channels = 4;
+	upload(data, 1, TextureCache::Format::RGBA8);
+
+	if (_settings.mipmaps) {
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 1000);
+		glGenerateMipmap(GL_TEXTURE_2D);
+
+		u32 levels = 1;
+		while (TextureCache::LevelSize(width, levels - 1) > 1 || TextureCache::LevelSize(height, levels - 1) > 1)
+			levels++;
+		applySampling(levels);
+		_uploadedLevels = levels;
+	}
+}
+
+// Upload format and type of each storage format
+struct GLFormat {
+	GLint internal;
+	GLenum format;
+	GLenum type;
+};
+
+#ifndef GL_RGB565
+#define GL_RGB565 0x8D62
+#endif
+
+static GLFormat GetGLFormat(TextureCache::Format format) {
+	switch (format) {
+	case TextureCache::Format::RGB565:
+		return {GL_RGB565, GL_RGB, GL_UNSIGNED_SHORT_5_6_5};
+	case TextureCache::Format::RGBA4444:
+		return {GL_RGBA4, GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4};
+	case TextureCache::Format::R8:
+		return {GL_R8, GL_RED, GL_UNSIGNED_BYTE};
+	default:
+		return {GL_RGBA8, GL_RGBA, GL_UNSIGNED_BYTE};
+	}
+}
+
+void ImageTexture::upload(const unsigned char *data, u32 levels, TextureCache::Format format) {
+	// New pixels go to a texture of its own, the old ones stay in the atlas page until it is freed
+	_atlasPage.reset();
+	_uvRect = glm::vec4(0.f, 0.f, 1.f, 1.f);
 
-	glGenTextures(1, &_id);
+	if (_id == 0)
+		glGenTextures(1, &_id);
 	glBindTexture(GL_TEXTURE_2D, _id);
+	applySampling(levels);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levels - 1);
 
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+#ifndef SW_WEB
+	// Masks read as white with the mask as alpha. Web builds never store R8, see SupportedFormat
+	bool mask = format == TextureCache::Format::R8;
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_R, mask ? GL_ONE : GL_RED);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_G, mask ? GL_ONE : GL_GREEN);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_B, mask ? GL_ONE : GL_BLUE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_SWIZZLE_A, mask ? GL_RED : GL_ALPHA);
+#endif
 
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, _width, _height, 0, GL_RGBA, GL_UNSIGNED_BYTE, data);
-	glGenerateMipmap(GL_TEXTURE_2D);
+	// Rows of 1 and 2 byte formats are not padded to 4 bytes
+	GLFormat gl = GetGLFormat(format);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	for (u32 level = 0; level < levels; level++) {
+		u32 w = TextureCache::LevelSize(_width, level), h = TextureCache::LevelSize(_height, level);
+		glTexImage2D(GL_TEXTURE_2D, level, gl.internal, w, h, 0, gl.format, gl.type, data);
+		data += TextureCache::LevelBytes(format, _width, _height, level);
+	}
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+	_format = format;
+	_uploadedLevels = levels;
+}
+
+void ImageTexture::applySampling(u32 levels) {
+	// In the order of TextureWrap
+	static const GLint wraps[] = {GL_CLAMP_TO_EDGE, GL_REPEAT, GL_MIRRORED_REPEAT};
+	GLint wrap = wraps[static_cast<u8>(_settings.wrap)];
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, wrap);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, wrap);
+
+	bool linear = _settings.filter == TextureFilter::Linear;
+	GLint minFilter = linear ? GL_LINEAR : GL_NEAREST;
+	if (levels > 1)
+		minFilter = linear ? GL_LINEAR_MIPMAP_LINEAR : GL_NEAREST_MIPMAP_NEAREST;
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minFilter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, linear ? GL_LINEAR : GL_NEAREST);
+}
+
+void ImageTexture::SetImportSettings(const TextureImportSettings &settings) {
+	TextureImportSettings previous = _settings;
+	_settings = settings;
+	_settings.format = SupportedFormat(settings.format);
+	if (_id == 0 && !_atlasPage)
+		return;
+
+	// Packed images leave their page for a texture of their own
+	if (_atlasPage || _settings.format != previous.format || _settings.mipmaps != previous.mipmaps) {
+		if (!ReloadResource())
+			_settings = previous;
+		return;
+	}
+
+	glBindTexture(GL_TEXTURE_2D, _id);
+	applySampling(_uploadedLevels);
+}
+
+ResourceMemory ImageTexture::GetMemoryUsage() const {
+	ResourceMemory memory;
+	memory.cpu = _pixels ? _pixels->Size() : 0;
+	// Packed images count their area of the page
+	if (_atlasPage)
+		memory.gpu = static_cast<u64>(_width) * _height * 4;
+	else if (_id != 0)
+		memory.gpu = TextureCache::ChainBytes(_format, _width, _height, _uploadedLevels);
+	return memory;
 }
 
 void ImageTexture::Delete() {
+	// Static textures outlive the GL context at exit
+	if (_id != 0 && Visual::Active())
+		glDeleteTextures(1, &_id);
+
+	_id = 0;
+	_uploadedLevels = 0;
+	_atlasPage.reset();
+	_uvRect = glm::vec4(0.f, 0.f, 1.f, 1.f);
 }
\ No newline at end of file
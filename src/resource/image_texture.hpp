@@ -4,7 +4,45 @@
 
 #include <cstdint>
 
+#include "glm/glm.hpp"
+
 #include "core/resource.hpp"
+#include "resource/texture_cache.hpp"
+
+class AtlasPage;
+struct FileData;
+
+enum class TextureFilter : u8 {
+	Nearest = 0,
+	Linear,
+};
+
+enum class TextureWrap : u8 {
+	ClampToEdge = 0,
+	Repeat,
+	MirroredRepeat,
+};
+
+// How a texture is imported and sampled, kept in its resource document. Format and mipmaps are baked into the imported
+// image, see TextureCache
+struct TextureImportSettings {
+	TextureFilter filter = TextureFilter::Nearest;
+	// Only sampled when the texture is drawn smaller than it is, the chain adds a third to its size
+	bool mipmaps = false;
+	// Repeat is what textures used before wrap could be picked, documents without a Wrap key read as it
+	TextureWrap wrap = TextureWrap::Repeat;
+	// R8 textures are masks, they sample as white with the mask as alpha. WebGL has no texture swizzles to draw them,
+	// web builds import R8 textures as RGBA8
+	TextureCache::Format format = TextureCache::Format::RGBA8;
+
+	void Read(const Document &doc);
+	void Write(Document &doc) const;
+
+	bool operator==(const TextureImportSettings &other) const {
+		return filter == other.filter && mipmaps == other.mipmaps && wrap == other.wrap && format == other.format;
+	}
+	bool operator!=(const TextureImportSettings &other) const { return !(*this == other); }
+};
 
 class ImageTexture : public Resource {
   public:
@@ -15,31 +53,82 @@ class ImageTexture : public Resource {
 	void Unbind();
 
 	void LoadResource(const Document &doc) override {
+		DecodeResource(doc);
+		UploadResource();
+	}
+
+	bool HasDecodePhase() override { return true; }
+	void DecodeResource(const Document &doc) override {
+		_settings.Read(doc);
 		std::string path = doc.Get("Path", std::string(""));
 		if (path != "")
-			Load(path.c_str());
+			Decode(path.c_str());
 	}
+	void UploadResource() override { Upload(); }
+	bool ReloadResource() override;
+	ResourceMemory GetMemoryUsage() const override;
 
 	void SaveResource(Document &doc) override {
-		doc.Set("Path", Filepath());
+		doc.Set("Path", Filepath().String());
+		_settings.Write(doc);
 	}
 
 	void Load(const char *path);
-	// data must be RGBA
+	// Reads the image and its mip chain into memory, Upload creates the texture from it. Images are decoded only when
+	// the texture cache has no import of the file's contents, see TextureCache
+	bool Decode(const char *path);
+	void Upload();
+	// data must be RGBA, it is stored as RGBA8 whatever the import format. A texture that already exists is respecified
+	// in place and keeps its ID
 	void LoadFromData(unsigned char *data, int width, int height);
 
+	inline const TextureImportSettings &GetImportSettings() const { return _settings; }
+	// Filter and wrap changes apply to the texture right away, format and mipmap changes import it again. Main thread
+	// only
+	void SetImportSettings(const TextureImportSettings &settings);
+	// Format of the uploaded texture
+	inline TextureCache::Format StorageFormat() const { return _format; }
+
 	void Delete();
 
-	inline uint32_t ID() const { return _id; }
+	// Draws from uvRect of page from now on and drops the decoded pixels. uvRect is the image's offset and size in the
+	// page, see TextureAtlas::Pack
+	void SetAtlasPage(Ref<AtlasPage> page, const glm::vec4 &uvRect);
+	inline bool IsAtlased() const { return _atlasPage != nullptr; }
+
+	// Decoded pixels of the first mip level waiting for Upload, nullptr once uploaded. Laid out in StorageFormat()
+	const unsigned char *Pixels() const;
+
+	// The atlas page's texture for packed images
+	uint32_t ID() const;
+	// Maps a UV of the image to one of ID(), the same UV unless the image was packed into an atlas
+	inline glm::vec2 MapUV(glm::vec2 uv) const { return glm::vec2(_uvRect.x + uv.x * _uvRect.z, _uvRect.y + uv.y * _uvRect.w); }
 	inline int Width() const { return _width; }
 	inline int Height() const { return _height; }
 	inline int Channels() const { return _channels; }
 
   private:
+	// Specifies levels mip levels of data, laid out one after another
+	void upload(const unsigned char *data, u32 levels, TextureCache::Format format);
+	// Sets the filter and wrap of the bound texture
+	void applySampling(u32 levels);
+
 	uint32_t _id = 0;
 	int _width = 0;
 	int _height = 0;
 	int _channels = 0;
+
+	// Mip chain read but not uploaded yet, level 0 first
+	Ref<FileData> _pixels;
+	u32 _levels = 0;
+	TextureCache::Format _format = TextureCache::Format::RGBA8;
+	u32 _uploadedLevels = 0;
+
+	TextureImportSettings _settings;
+
+	Ref<AtlasPage> _atlasPage;
+	// Offset and size of the image in ID()
+	glm::vec4 _uvRect = glm::vec4(0.f, 0.f, 1.f, 1.f);
 };
 
 #endif // IMAGE_TEXTURE_HPP
\ No newline at end of file
@@ -18,7 +18,14 @@ Mesh::~Mesh() {
 }
 
 void Mesh::Load(const char *path) {
-	_model.New();
+	Decode(path);
+	Upload();
+}
+
+bool Mesh::Decode(const char *path) {
+	_vertexData.clear();
+	_indexData.clear();
+	_decoded = false;
 
 	tinyobj::attrib_t attrib;
 	std::vector<tinyobj::shape_t> shapes;
@@ -27,23 +34,22 @@ void Mesh::Load(const char *path) {
 	std::string err;
 	std::string warn;
 
-	auto file = App().FS().Load(path);
-	if (!file) {
-		return;
+	// Read through a stream over the file instead of a string copy of it
+	std::unique_ptr<std::istream> stream = App().FS().LoadStream(path);
+	if (!stream) {
+		return false;
 	}
-	std::string data{reinterpret_cast<char *>(file->Data()), file->Size()};
-	std::istringstream ss(data);
 
-	bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, &ss);
+	bool ret = tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, stream.get());
 
 	if (!err.empty()) {
 		std::cout << "Failed to load object file " << path << std::endl;
 		std::cout << "error: " << err << std::endl;
-		return;
+		return false;
 	}
 
-	std::vector<float> vertexData;
-	std::vector<unsigned int> indexData;
+	std::vector<float> &vertexData = _vertexData;
+	std::vector<unsigned int> &indexData = _indexData;
 	bool hasNormals = false;
 	bool hasTexCoords = false;
 
@@ -108,13 +114,39 @@ void Mesh::Load(const char *path) {
 		}
 	}
 
+	_filepath = path;
+	_decoded = true;
+	return true;
+}
+
+void Mesh::Upload() {
+	_model.New();
+	_bufferSize = 0;
+	if (!_decoded) {
+		return;
+	}
+
 	_model.ResetAttributes();
-	_model.SetModelData(vertexData);
-	_model.SetIndexData(indexData);
+	_model.SetModelData(_vertexData);
+	_model.SetIndexData(_indexData);
 	_model.SetAttribute(0, AttributeType::Vec3);
 	_model.SetAttribute(1, AttributeType::Vec3);
 	_model.SetAttribute(2, AttributeType::Vec2);
 	_model.UploadAttributes();
+	_bufferSize = _vertexData.size() * sizeof(float) + _indexData.size() * sizeof(unsigned int);
+
+	_vertexData.clear();
+	_vertexData.shrink_to_fit();
+	_indexData.clear();
+	_indexData.shrink_to_fit();
+	_decoded = false;
+}
+
+ResourceMemory Mesh::GetMemoryUsage() const {
+	ResourceMemory memory;
+	memory.cpu = _vertexData.size() * sizeof(float) + _indexData.size() * sizeof(unsigned int);
+	memory.gpu = _bufferSize;
+	return memory;
 }
 
 void Mesh::Draw() const {
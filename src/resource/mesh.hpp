@@ -13,12 +13,39 @@ class Mesh : public Resource {
 	Mesh();
 	virtual ~Mesh();
 
+	void LoadResource(const Document &doc) override {
+		DecodeResource(doc);
+		UploadResource();
+	}
+
+	void SaveResource(Document &doc) override {
+		doc.Set("Path", Filepath().String());
+	}
+
+	bool HasDecodePhase() override { return true; }
+	void DecodeResource(const Document &doc) override {
+		std::string path = doc.Get("Path", std::string(""));
+		if (path != "")
+			Decode(path.c_str());
+	}
+	void UploadResource() override { Upload(); }
+	ResourceMemory GetMemoryUsage() const override;
+
 	void Load(const char *path);
+	// Parses the obj file into vertex and index data, Upload creates the model buffers from it
+	bool Decode(const char *path);
+	void Upload();
 
 	void Draw() const;
 
   private:
 	Model _model;
+
+	std::vector<float> _vertexData;
+	std::vector<unsigned int> _indexData;
+	bool _decoded = false;
+	// Bytes in the vertex and index buffers
+	u64 _bufferSize = 0;
 };
 
 #endif // MESH_HPP
\ No newline at end of file
@@ -0,0 +1,115 @@
+#include "prefab.hpp"
+
+#include <algorithm>
+
+#include "core/application.hpp"
+#include "core/debug.hpp"
+#include "scene/node.hpp"
+
+Prefab::Prefab() {
+	_resourceType = typeid(Prefab).hash_code();
+}
+
+Prefab::~Prefab() {
+	Clear();
+}
+
+void Prefab::LoadResource(const Document &doc) {
+	Clear();
+
+	YAML::Node nodes = doc.Get("Nodes", YAML::Node());
+	for (YAML::const_iterator it = nodes.begin(); it != nodes.end(); ++it) {
+		Document nodeDoc(*it);
+
+		std::string type = nodeDoc.GetString("Type", "Node");
+		Node *node = App().GetNodeDB().Create(App().GetNodeDB().GetNodeTypeID(type));
+		if (!node) {
+			Debug::Error("Failed to load prefab: unknown node type '{}'", type);
+			Clear();
+			return;
+		}
+		node->Deserialize(nodeDoc);
+
+		i32 parent = nodeDoc.GetInt("Parent", -1);
+		// Only the first entry is a root, every other node must point at an earlier entry
+		bool valid = _entries.empty() ? parent == -1 : parent >= 0 && parent < static_cast<i32>(_entries.size());
+		if (!valid) {
+			Debug::Error("Failed to load prefab: node '{}' has invalid parent {}", node->Name(), parent);
+			App().GetNodeDB().Destroy(node);
+			Clear();
+			return;
+		}
+		addEntry(node, parent);
+	}
+
+	buildGroups();
+}
+
+void Prefab::SaveResource(Document &doc) {
+	YAML::Node nodes;
+	for (const Entry &entry : _entries) {
+		Document nodeDoc;
+		entry.node->Serialize(nodeDoc);
+		nodeDoc.SetInt("Parent", entry.parent);
+
+		nodes.push_back(nodeDoc.ToYAML());
+	}
+	doc.Set("Nodes", nodes);
+}
+
+bool Prefab::Compile(Node *root) {
+	Clear();
+	if (!root)
+		return false;
+
+	std::vector<std::pair<Node *, i32>> stack{{root, -1}};
+	while (!stack.empty()) {
+		auto [src, parent] = stack.back();
+		stack.pop_back();
+
+		Node *node = App().GetNodeDB().Create(src->TypeID());
+		if (!node) {
+			Clear();
+			return false;
+		}
+		src->Copy(node);
+
+		i32 index = static_cast<i32>(_entries.size());
+		addEntry(node, parent);
+
+		// Pushed in reverse so children keep their order in the depth first layout
+		for (size_t i = src->GetChildCount(); i > 0; i--) {
+			stack.push_back({src->GetChild(i - 1), index});
+		}
+	}
+
+	buildGroups();
+	return true;
+}
+
+void Prefab::Clear() {
+	for (Entry &entry : _entries) {
+		App().GetNodeDB().Destroy(entry.node);
+	}
+	_entries.clear();
+	_groups.clear();
+}
+
+void Prefab::addEntry(Node *node, i32 parent) {
+	_entries.push_back(Entry{node, parent, 0});
+	if (parent >= 0)
+		_entries[parent].childCount++;
+}
+
+void Prefab::buildGroups() {
+	_groups.clear();
+	for (u32 i = 0; i < _entries.size(); i++) {
+		NodeTypeID type = _entries[i].node->TypeID();
+
+		auto group = std::find_if(_groups.begin(), _groups.end(), [type](const TypeGroup &g) { return g.type == type; });
+		if (group == _groups.end()) {
+			group = _groups.insert(_groups.end(), TypeGroup{type, {}});
+		}
+		group->entries.push_back(i);
+	}
+}
\ No newline at end of file
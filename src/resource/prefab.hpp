@@ -0,0 +1,49 @@
+#ifndef PREFAB_HPP
+#define PREFAB_HPP
+#pragma once
+
+#include <vector>
+
+#include "core/resource.hpp"
+#include "sowa.hpp"
+
+class Node;
+
+// A node subtree compiled into a flat list of template nodes, for spawning many copies at once through Scene::Instantiate
+class Prefab : public Resource {
+  public:
+	Prefab();
+	virtual ~Prefab();
+
+	void LoadResource(const Document &doc) override;
+	void SaveResource(Document &doc) override;
+
+	// Rebuilds the prefab from a copy of root and its descendants
+	bool Compile(Node *root);
+	void Clear();
+
+	inline size_t NodeCount() const { return _entries.size(); }
+
+  private:
+	friend class Scene;
+
+	struct Entry {
+		Node *node = nullptr;
+		// Index of the parent entry, -1 for the root. Parents always come before their children
+		i32 parent = -1;
+		u32 childCount = 0;
+	};
+
+	struct TypeGroup {
+		NodeTypeID type = 0;
+		std::vector<u32> entries;
+	};
+
+	void addEntry(Node *node, i32 parent);
+	void buildGroups();
+
+	std::vector<Entry> _entries;
+	std::vector<TypeGroup> _groups;
+};
+
+#endif // PREFAB_HPP
\ No newline at end of file
@@ -1,33 +1,356 @@
 #include "resource_registry.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
 
+#include "core/application.hpp"
+#include "core/debug.hpp"
 #include "data/id_generator.hpp"
 
+ResourceRef::ResourceRef(const ResourceRef &other) : _registry(other._registry), _resource(other._resource) {
+	if (_registry)
+		_registry->retain(_resource);
+}
+
+void ResourceRef::Reset() {
+	if (_registry)
+		_registry->release(_resource);
+
+	_registry = nullptr;
+	_resource = nullptr;
+}
+
 Resource *ResourceRegistry::GetResource(RID rid) {
-	return _resources[rid];
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto it = _resources.find(rid);
+	return it != _resources.end() ? it->second : nullptr;
 }
 
-const std::unordered_map<RID, Resource *> ResourceRegistry::GetResources() {
-	return _resources;
+Resource *ResourceRegistry::FindResource(const ResPath &path) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto it = _paths.find(path);
+	if (it == _paths.end())
+		return nullptr;
+
+	auto res = _resources.find(it->second);
+	return res != _resources.end() ? res->second : nullptr;
+}
+
+void ResourceRegistry::ForEachResource(const std::function<void(Resource *)> &visit) {
+	for (const TypeSlots &type : _slots) {
+		for (const Slot &slot : type.slots) {
+			if (Resource *res = slot.resource.load(std::memory_order_acquire); nullptr != res)
+				visit(res);
+		}
+	}
 }
 
 void ResourceRegistry::AddResource(Resource *res, RID rid) {
-	if (rid != 0)
-		res->_rid = rid;
+	Resource *duplicate = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		Entry &entry = insert(res, rid);
+		if (entry.resource != res)
+			duplicate = res;
 
-	if (res->GetRID() == 0) {
-		static UUIDGenerator gen;
-		res->_rid = gen.NextI32();
+		revive(entry);
+		entry.pinned = true;
 	}
 
-	_resources[res->GetRID()] = res;
+	if (duplicate)
+		destroy(duplicate);
 }
 
 void ResourceRegistry::RemoveResource(Resource *res) {
-	// TODO: Implement
+	if (res)
+		RemoveResourceByID(res->GetRID());
 }
 
 void ResourceRegistry::RemoveResourceByID(RID rid) {
-	// TODO: Implement
+	Resource *removed = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto it = _entries.find(rid);
+		if (it == _entries.end())
+			return;
+
+		it->second.pinned = false;
+		if (it->second.refs == 0)
+			removed = erase(rid);
+	}
+
+	if (removed)
+		destroy(removed);
+}
+
+ResourceRef ResourceRegistry::Load(const ResPath &path, TypeID type) {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		auto it = _paths.find(path);
+		if (it != _paths.end()) {
+			Entry &entry = _entries.at(it->second);
+			if (entry.resource->ResourceType() == type) {
+				revive(entry);
+				entry.refs++;
+				return ResourceRef(this, entry.resource);
+			}
+		}
+	}
+
+	Resource *res = CreateResource(type);
+	if (!res) {
+		Debug::Error("Failed to load '{}': unknown resource type", path.String());
+		return ResourceRef();
+	}
+
+	Document doc;
+	doc.SetString("Path", path.String());
+	res->LoadResource(doc);
+
+	// Resources only take their path once the file decoded
+	if (res->Filepath().Empty()) {
+		Debug::Error("Failed to load resource '{}'", path.String());
+		destroy(res);
+		return ResourceRef();
+	}
+	return Register(res);
+}
+
+ResourceRef ResourceRegistry::Acquire(RID rid) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto it = _entries.find(rid);
+	if (it == _entries.end())
+		return ResourceRef();
+
+	revive(it->second);
+	it->second.refs++;
+	return ResourceRef(this, it->second.resource);
+}
+
+ResourceRef ResourceRegistry::Register(Resource *res, RID rid) {
+	Resource *duplicate = nullptr;
+	Resource *registered = nullptr;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		Entry &entry = insert(res, rid);
+		if (entry.resource != res)
+			duplicate = res;
+
+		revive(entry);
+		entry.refs++;
+		registered = entry.resource;
+	}
+
+	if (duplicate)
+		destroy(duplicate);
+	return ResourceRef(this, registered);
+}
+
+void ResourceRegistry::Update() {
+	std::vector<Resource *> expired;
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (_released.empty())
+			return;
+
+		u64 cached = 0;
+		for (RID rid : _released) {
+			ResourceMemory memory = _entries.at(rid).resource->GetMemoryUsage();
+			cached += memory.cpu + memory.gpu;
+		}
+
+		// _released is in release order, so expired entries are all at the front
+		auto now = std::chrono::steady_clock::now();
+		while (!_released.empty()) {
+			Entry &entry = _entries.at(_released.front());
+			if (now - entry.releasedAt < _gracePeriod && cached <= _cacheBudget)
+				break;
+
+			ResourceMemory memory = entry.resource->GetMemoryUsage();
+			cached -= std::min(cached, memory.cpu + memory.gpu);
+			expired.push_back(erase(_released.front()));
+		}
+	}
+
+	for (Resource *res : expired) {
+		destroy(res);
+	}
+}
+
+void ResourceRegistry::SetReleaseCache(std::chrono::milliseconds gracePeriod, u64 budget) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_gracePeriod = gracePeriod;
+	_cacheBudget = budget;
+}
+
+std::unordered_map<TypeID, ResourceMemoryStats> ResourceRegistry::GetMemoryStats() {
+	std::unordered_map<TypeID, ResourceMemoryStats> stats;
+
+	std::lock_guard<std::mutex> lock(_mutex);
+	for (auto &[rid, entry] : _entries) {
+		ResourceMemory memory = entry.resource->GetMemoryUsage();
+		ResourceMemoryStats &type = stats[entry.resource->ResourceType()];
+		type.count++;
+		type.memory.cpu += memory.cpu;
+		type.memory.gpu += memory.gpu;
+
+		if (entry.cached) {
+			type.cached++;
+			type.cachedMemory.cpu += memory.cpu;
+			type.cachedMemory.gpu += memory.gpu;
+		}
+	}
+	return stats;
+}
+
+ResourceRegistry::Entry &ResourceRegistry::insert(Resource *res, RID rid) {
+	if (rid == 0)
+		rid = res->GetRID();
+
+	if (rid == 0) {
+		static UUIDGenerator gen;
+		do {
+			rid = gen.NextI32();
+		} while (rid == 0 || _entries.count(rid) != 0);
+	}
+
+	auto [it, added] = _entries.try_emplace(rid);
+	Entry &entry = it->second;
+	if (!added)
+		return entry;
+
+	res->_rid = rid;
+	entry.resource = res;
+	_resources[rid] = res;
+	_version++;
+
+	auto alloc = _allocators.find(res->ResourceType());
+	entry.tag = alloc != _allocators.end() ? alloc->second.tag : 0;
+	if (entry.tag != 0) {
+		TypeSlots &type = _slots[entry.tag - 1];
+		if (!type.free.empty()) {
+			entry.slot = type.free.back();
+			type.free.pop_back();
+		} else {
+			entry.slot = static_cast<u32>(type.slots.size());
+			type.slots.emplace_back();
+		}
+		publish(entry, res);
+	}
+
+	if (!res->Filepath().Empty()) {
+		_paths.emplace(res->Filepath(), rid);
+		// Cached resources are reloaded as well, so they are up to date when revived
+		entry.watch = App().GetHotReload().Watch(res->Filepath(), GetTypeName(res->ResourceType()), [this, rid]() {
+			Resource *current = nullptr;
+			{
+				std::lock_guard<std::mutex> lock(_mutex);
+				auto it = _entries.find(rid);
+				if (it != _entries.end())
+					current = it->second.resource;
+			}
+			return current != nullptr && current->ReloadResource();
+		});
+	}
+	return entry;
+}
+
+void ResourceRegistry::revive(Entry &entry) {
+	if (!entry.cached)
+		return;
+
+	RID rid = *entry.released;
+	_released.erase(entry.released);
+	entry.cached = false;
+	_resources[rid] = entry.resource;
+	publish(entry, entry.resource);
+}
+
+Resource *ResourceRegistry::getResource(RID rid, u16 tag) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto it = _entries.find(rid);
+	if (tag == 0 || it == _entries.end() || it->second.cached || it->second.tag != tag)
+		return nullptr;
+	return it->second.resource;
+}
+
+void ResourceRegistry::lookup(RID rid, u16 tag, u32 &slot, u32 &generation) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto it = _entries.find(rid);
+	if (it == _entries.end() || it->second.tag != tag) {
+		slot = ResHandle<Resource>::NoSlot;
+		return;
+	}
+
+	slot = it->second.slot;
+	generation = _slots[tag - 1].slots[slot].generation;
+}
+
+void ResourceRegistry::publish(const Entry &entry, Resource *res) {
+	if (entry.tag != 0)
+		_slots[entry.tag - 1].slots[entry.slot].resource.store(res, std::memory_order_release);
+}
+
+void ResourceRegistry::retain(Resource *res) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	_entries.at(res->GetRID()).refs++;
+}
+
+void ResourceRegistry::release(Resource *res) {
+	std::lock_guard<std::mutex> lock(_mutex);
+	auto it = _entries.find(res->GetRID());
+	if (it == _entries.end())
+		return;
+
+	Entry &entry = it->second;
+	if (entry.refs > 0)
+		entry.refs--;
+	if (entry.refs > 0 || entry.pinned)
+		return;
+
+	entry.cached = true;
+	entry.releasedAt = std::chrono::steady_clock::now();
+	entry.released = _released.insert(_released.end(), it->first);
+	_resources.erase(it->first);
+	publish(entry, nullptr);
+}
+
+Resource *ResourceRegistry::erase(RID rid) {
+	auto it = _entries.find(rid);
+	if (it == _entries.end())
+		return nullptr;
+
+	Entry &entry = it->second;
+	Resource *res = entry.resource;
+	if (entry.cached)
+		_released.erase(entry.released);
+	if (entry.watch != 0) {
+		App().GetHotReload().Unwatch(entry.watch);
+		entry.watch = 0;
+	}
+
+	if (entry.tag != 0) {
+		TypeSlots &type = _slots[entry.tag - 1];
+		Slot &slot = type.slots[entry.slot];
+		slot.resource.store(nullptr, std::memory_order_release);
+		slot.generation++;
+		type.free.push_back(entry.slot);
+	}
+
+	auto path = _paths.find(res->Filepath());
+	if (path != _paths.end() && path->second == rid)
+		_paths.erase(path);
+
+	_resources.erase(rid);
+	_entries.erase(it);
+	return res;
+}
+
+void ResourceRegistry::destroy(Resource *res) {
+	auto it = _allocators.find(res->ResourceType());
+	if (it != _allocators.end() && it->second.destroyFunc)
+		it->second.destroyFunc(res);
+	else
+		delete res;
 }
\ No newline at end of file
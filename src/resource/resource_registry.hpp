@@ -2,8 +2,15 @@
 #define RESOURCE_REGISTRY
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <deque>
 #include <functional>
+#include <list>
+#include <mutex>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "core/resource.hpp"
 #include "sowa.hpp"
@@ -11,16 +18,158 @@
 struct ResourceAllocate {
 	std::function<Resource *()> createFunc;
 	std::function<void(Resource *)> destroyFunc;
+	u16 tag = 0;
 };
 
+// Small index of a resource type, set by ResourceRegistry::AddResourceType. 0 for types that were never added
+template <typename T>
+struct ResourceTypeTag {
+	static inline u16 value = 0;
+};
+
+class ResourceRegistry;
+
+// Resource of type T looked up by RID once, then read straight from its slot in the registry. Nodes keep one next to
+// each RID property and pass both to ResourceRegistry::Resolve
+template <typename T>
+class ResHandle {
+  public:
+	inline RID GetRID() const { return _rid; }
+
+  private:
+	friend class ResourceRegistry;
+	static constexpr u32 NoSlot = ~0u;
+
+	RID _rid = 0;
+	u32 _slot = NoSlot;
+	u32 _generation = 0;
+	// Registry version of the last lookup, a handle that found nothing looks again once resources were added
+	u64 _version = 0;
+};
+
+// Counted reference to a registered resource. A resource stays loaded while it is pinned or referenced, after the last
+// reference goes away it waits in the release cache where loading it again revives it
+class ResourceRef {
+  public:
+	ResourceRef() = default;
+	ResourceRef(const ResourceRef &other);
+	ResourceRef(ResourceRef &&other) noexcept : _registry(other._registry), _resource(other._resource) {
+		other._registry = nullptr;
+		other._resource = nullptr;
+	}
+	ResourceRef &operator=(ResourceRef other) noexcept {
+		std::swap(_registry, other._registry);
+		std::swap(_resource, other._resource);
+		return *this;
+	}
+	~ResourceRef() { Reset(); }
+
+	void Reset();
+
+	inline Resource *Get() const { return _resource; }
+	inline Resource *operator->() const { return _resource; }
+	inline explicit operator bool() const { return _resource != nullptr; }
+	inline bool operator==(const ResourceRef &other) const { return _resource == other._resource; }
+
+	template <typename T>
+	inline T *As() const { return dynamic_cast<T *>(_resource); }
+
+  private:
+	friend class ResourceRegistry;
+	// Takes over a reference the registry already counted
+	ResourceRef(ResourceRegistry *registry, Resource *resource) : _registry(registry), _resource(resource) {}
+
+	ResourceRegistry *_registry = nullptr;
+	Resource *_resource = nullptr;
+};
+
+// Resources of one type. Cached ones are released and waiting in the release cache, they are included in count and
+// memory as well
+struct ResourceMemoryStats {
+	u32 count = 0;
+	u32 cached = 0;
+	ResourceMemory memory;
+	ResourceMemory cachedMemory;
+};
+
+// Owns every loaded resource. Resources added with AddResource are pinned and live until removed, the ones handed out
+// through Load, Acquire and Register are freed once their references are gone and the release cache lets go of them
 class ResourceRegistry {
   public:
+	// Live resources only, released ones in the cache are not returned
 	Resource *GetResource(RID rid);
-	const std::unordered_map<RID, Resource *> GetResources();
+	// nullptr if the resource is not a T
+	template <typename T>
+	T *GetResource(RID rid) {
+		return static_cast<T *>(getResource(rid, ResourceTypeTag<T>::value));
+	}
+	// First resource added from path, nullptr if there is none
+	Resource *FindResource(const ResPath &path);
+
+	// Resource of type T with rid, or nullptr. The RID is only looked up when it differs from the handle's last one, or
+	// after the resource went away. Main thread only
+	template <typename T>
+	T *Resolve(ResHandle<T> &handle, RID rid) {
+		u16 tag = ResourceTypeTag<T>::value;
+		if (tag == 0)
+			return nullptr;
+
+		if (handle._rid != rid || (handle._slot == ResHandle<T>::NoSlot && handle._version != _version)) {
+			handle._rid = rid;
+			handle._version = _version;
+			lookup(rid, tag, handle._slot, handle._generation);
+		}
+		if (handle._slot == ResHandle<T>::NoSlot)
+			return nullptr;
+
+		const Slot &slot = _slots[tag - 1].slots[handle._slot];
+		if (slot.generation != handle._generation) {
+			handle._slot = ResHandle<T>::NoSlot;
+			return nullptr;
+		}
+		return static_cast<T *>(slot.resource.load(std::memory_order_acquire));
+	}
+
+	// Visits live resources, of every type or only those of T. Main thread only
+	void ForEachResource(const std::function<void(Resource *)> &visit);
+	template <typename T>
+	void ForEachResource(const std::function<void(T *)> &visit) {
+		u16 tag = ResourceTypeTag<T>::value;
+		if (tag == 0)
+			return;
+
+		for (const Slot &slot : _slots[tag - 1].slots) {
+			if (Resource *res = slot.resource.load(std::memory_order_acquire); nullptr != res)
+				visit(static_cast<T *>(res));
+		}
+	}
+	// Pins res, adding it first if it is not registered yet
 	void AddResource(Resource *res, RID rid = 0);
+	// Unpins the resource, it is destroyed right away unless something still references it
 	void RemoveResource(Resource *res);
 	void RemoveResourceByID(RID rid);
 
+	// Loads a resource of type from path, or shares the one already loaded from it. Returns an empty reference if the
+	// file could not be loaded
+	ResourceRef Load(const ResPath &path, TypeID type);
+	template <typename T>
+	ResourceRef Load(const ResPath &path) {
+		return Load(path, typeid(T).hash_code());
+	}
+
+	// Reference to the live or cached resource with rid, empty if there is none. Background scene loads can call it
+	ResourceRef Acquire(RID rid);
+	// Adds res unpinned, it lives as long as the returned reference and its copies. If rid is already registered res is
+	// destroyed and the registered resource returned instead
+	ResourceRef Register(Resource *res, RID rid = 0);
+
+	// Destroys cached resources released longer than the grace period ago, then the oldest ones while the cache holds
+	// more than its budget. Application::Update calls it once a frame
+	void Update();
+	void SetReleaseCache(std::chrono::milliseconds gracePeriod, u64 budget);
+
+	std::unordered_map<TypeID, ResourceMemoryStats> GetMemoryStats();
+
 	template <typename T>
 	void AddResourceType(const char *name) {
 		ResourceAllocate &alloc = _allocators[typeid(T).hash_code()];
@@ -32,18 +181,26 @@ class ResourceRegistry {
 		};
 		_typenames[std::string(name)] = typeid(T).hash_code();
 		_typeIds[typeid(T).hash_code()] = std::string(name);
+
+		if (ResourceTypeTag<T>::value == 0) {
+			_slots.emplace_back();
+			ResourceTypeTag<T>::value = static_cast<u16>(_slots.size());
+		}
+		alloc.tag = ResourceTypeTag<T>::value;
 	}
 
+	// Creating resources only reads the type tables, so background scene loads can call it
 	Resource *CreateResource(TypeID type) {
-		auto fn = _allocators[type].createFunc;
-		if (fn) {
-			return fn();
+		auto it = _allocators.find(type);
+		if (it != _allocators.end() && it->second.createFunc) {
+			return it->second.createFunc();
 		}
 		return nullptr;
 	}
 
 	Resource *CreateResource(const char *typeName) {
-		return CreateResource(_typenames[std::string(typeName)]);
+		auto it = _typenames.find(std::string(typeName));
+		return it != _typenames.end() ? CreateResource(it->second) : nullptr;
 	}
 
 	template <typename T>
@@ -56,7 +213,71 @@ class ResourceRegistry {
 	}
 
   private:
+	friend class ResourceRef;
+
+	// Resources of one type are kept in a dense array of slots. A slot's resource is null while the resource is cached or
+	// the slot free, the generation changes whenever the slot is freed so handles to it fail
+	struct Slot {
+		std::atomic<Resource *> resource{nullptr};
+		u32 generation = 0;
+	};
+
+	struct TypeSlots {
+		// Elements never move, so slots handed out stay valid as more are added
+		std::deque<Slot> slots;
+		std::vector<u32> free;
+	};
+
+	struct Entry {
+		Resource *resource = nullptr;
+		u16 tag = 0;
+		u32 slot = 0;
+		u32 refs = 0;
+		bool pinned = false;
+		// Hot reload watch of the resource's file, 0 if it has none. Entries only start in insert, which takes the watch,
+		// and only end in erase, which releases it, so removed and expired resources never leave a handler behind
+		u32 watch = 0;
+
+		// Set while the entry waits in _released
+		bool cached = false;
+		std::list<RID>::iterator released;
+		std::chrono::steady_clock::time_point releasedAt;
+	};
+
+	// Adds res under rid, or returns the entry already registered there. The helpers below are called with _mutex held,
+	// except for retain, release and destroy
+	Entry &insert(Resource *res, RID rid);
+	// Takes the entry out of the release cache
+	void revive(Entry &entry);
+	// Forgets the entry and returns its resource for destroy
+	Resource *erase(RID rid);
+
+	Resource *getResource(RID rid, u16 tag);
+	// Finds the slot of the resource with rid, slot is set to NoSlot if there is none of type tag
+	void lookup(RID rid, u16 tag, u32 &slot, u32 &generation);
+	// Sets the resource a slot shows, nullptr while it is cached
+	void publish(const Entry &entry, Resource *res);
+
+	void retain(Resource *res);
+	// Moves the resource to the release cache once it is unpinned and unreferenced
+	void release(Resource *res);
+	void destroy(Resource *res);
+
+	std::mutex _mutex;
+	std::unordered_map<RID, Entry> _entries;
+	// Live resources, cached ones are left out
 	std::unordered_map<RID, Resource *> _resources;
+	std::unordered_map<ResPath, RID> _paths;
+	// Oldest release first
+	std::list<RID> _released;
+
+	// Indexed by type tag - 1
+	std::deque<TypeSlots> _slots;
+	// Changes whenever a resource is added
+	u64 _version = 1;
+
+	std::chrono::milliseconds _gracePeriod{10000};
+	u64 _cacheBudget = 64 * 1024 * 1024;
 
 	std::unordered_map<TypeID, ResourceAllocate> _allocators;
 	std::unordered_map<std::string, TypeID> _typenames;
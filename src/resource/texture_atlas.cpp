@@ -0,0 +1,255 @@
+#include "texture_atlas.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "core/debug.hpp"
+#include "resource/image_texture.hpp"
+#include "visual/gl.hpp"
+#include "visual/renderer2d.hpp"
+#include "visual/visual.hpp"
+
+MaxRectsPacker::MaxRectsPacker(i32 width, i32 height) : _width(width), _height(height) {
+	_free.push_back(Area{0, 0, width, height});
+}
+
+bool MaxRectsPacker::Insert(i32 w, i32 h, i32 &x, i32 &y) {
+	// Best short side fit, ties go to the best long side fit
+	const Area *best = nullptr;
+	i32 bestShort = std::numeric_limits<i32>::max();
+	i32 bestLong = std::numeric_limits<i32>::max();
+	for (const Area &area : _free) {
+		if (area.w < w || area.h < h)
+			continue;
+
+		i32 leftoverW = area.w - w;
+		i32 leftoverH = area.h - h;
+		i32 shortSide = std::min(leftoverW, leftoverH);
+		i32 longSide = std::max(leftoverW, leftoverH);
+		if (shortSide < bestShort || (shortSide == bestShort && longSide < bestLong)) {
+			best = &area;
+			bestShort = shortSide;
+			bestLong = longSide;
+		}
+	}
+
+	if (!best)
+		return false;
+
+	Area used{best->x, best->y, w, h};
+	x = used.x;
+	y = used.y;
+	split(used);
+	prune();
+	_used += static_cast<u64>(w) * h;
+	return true;
+}
+
+f32 MaxRectsPacker::Occupancy() const {
+	return static_cast<f32>(_used) / (static_cast<f32>(_width) * _height);
+}
+
+void MaxRectsPacker::split(const Area &used) {
+	std::vector<Area> pieces;
+	for (size_t i = 0; i < _free.size();) {
+		const Area area = _free[i];
+		if (used.x >= area.x + area.w || used.x + used.w <= area.x || used.y >= area.y + area.h || used.y + used.h <= area.y) {
+			i++;
+			continue;
+		}
+
+		// The parts of area left, right, below and above used, they overlap each other
+		if (used.x > area.x)
+			pieces.push_back(Area{area.x, area.y, used.x - area.x, area.h});
+		if (used.x + used.w < area.x + area.w)
+			pieces.push_back(Area{used.x + used.w, area.y, area.x + area.w - (used.x + used.w), area.h});
+		if (used.y > area.y)
+			pieces.push_back(Area{area.x, area.y, area.w, used.y - area.y});
+		if (used.y + used.h < area.y + area.h)
+			pieces.push_back(Area{area.x, used.y + used.h, area.w, area.y + area.h - (used.y + used.h)});
+
+		_free[i] = _free.back();
+		_free.pop_back();
+	}
+	_free.insert(_free.end(), pieces.begin(), pieces.end());
+}
+
+void MaxRectsPacker::prune() {
+	auto contains = [](const Area &outer, const Area &inner) {
+		return inner.x >= outer.x && inner.y >= outer.y && inner.x + inner.w <= outer.x + outer.w && inner.y + inner.h <= outer.y + outer.h;
+	};
+
+	for (size_t i = 0; i < _free.size(); i++) {
+		for (size_t j = i + 1; j < _free.size();) {
+			if (contains(_free[i], _free[j])) {
+				_free.erase(_free.begin() + j);
+			} else if (contains(_free[j], _free[i])) {
+				_free.erase(_free.begin() + i);
+				j = i + 1;
+			} else {
+				j++;
+			}
+		}
+	}
+}
+
+AtlasPage::~AtlasPage() {
+	if (_id != 0 && Visual::Active())
+		glDeleteTextures(1, &_id);
+}
+
+namespace TextureAtlas {
+
+struct Placement {
+	ImageTexture *texture = nullptr;
+	i32 x = 0;
+	i32 y = 0;
+};
+
+struct PageLayout {
+	PageLayout(i32 size) : packer(size, size) {}
+
+	MaxRectsPacker packer;
+	std::vector<Placement> placements;
+	i32 right = 0;
+	i32 top = 0;
+};
+
+static i32 NextPowerOfTwo(i32 value) {
+	i32 pow = 1;
+	while (pow < value)
+		pow *= 2;
+	return pow;
+}
+
+// Copies the image to x, y of the page with its edge pixels repeated gutter times around it
+static void CopyImage(std::vector<u8> &page, i32 pageWidth, i32 x, i32 y, const unsigned char *pixels, i32 w, i32 h, i32 gutter) {
+	auto at = [&](i32 px, i32 py) {
+		return page.data() + (static_cast<size_t>(py) * pageWidth + px) * 4;
+	};
+
+	for (i32 row = 0; row < h; row++) {
+		u8 *dst = at(x, y + gutter + row);
+		const unsigned char *src = pixels + static_cast<size_t>(row) * w * 4;
+		for (i32 i = 0; i < gutter; i++) {
+			std::memcpy(dst + i * 4, src, 4);
+			std::memcpy(dst + (gutter + w + i) * 4, src + (w - 1) * 4, 4);
+		}
+		std::memcpy(dst + gutter * 4, src, static_cast<size_t>(w) * 4);
+	}
+
+	// Corners come along with the first and last rows
+	size_t rowBytes = static_cast<size_t>(w + 2 * gutter) * 4;
+	for (i32 i = 0; i < gutter; i++) {
+		std::memcpy(at(x, y + i), at(x, y + gutter), rowBytes);
+		std::memcpy(at(x, y + gutter + h + i), at(x, y + gutter + h - 1), rowBytes);
+	}
+}
+
+AtlasReport Pack(const std::vector<ImageTexture *> &textures, const AtlasSettings &settings) {
+	AtlasReport report;
+
+	i32 gutter = std::max(settings.gutter, 0);
+	i32 pageSize = settings.pageSize;
+
+	std::vector<ImageTexture *> candidates;
+	for (ImageTexture *texture : textures) {
+		if (!texture || !texture->Pixels() || texture->Width() <= 0 || texture->Height() <= 0)
+			continue;
+		// Pages are RGBA8 without mipmaps, sampled like a default texture
+		if (texture->GetImportSettings() != TextureImportSettings() || texture->StorageFormat() != TextureCache::Format::RGBA8)
+			continue;
+		if (texture->Width() > settings.maxTextureSize || texture->Height() > settings.maxTextureSize)
+			continue;
+		if (texture->Width() + 2 * gutter > pageSize || texture->Height() + 2 * gutter > pageSize)
+			continue;
+		candidates.push_back(texture);
+	}
+
+	// Large images first leave the small ones to fill the gaps
+	std::stable_sort(candidates.begin(), candidates.end(), [](ImageTexture *a, ImageTexture *b) {
+		i32 sideA = std::max(a->Width(), a->Height());
+		i32 sideB = std::max(b->Width(), b->Height());
+		return sideA != sideB ? sideA > sideB : a->Height() > b->Height();
+	});
+
+	std::vector<PageLayout> layouts;
+	for (ImageTexture *texture : candidates) {
+		i32 w = texture->Width() + 2 * gutter;
+		i32 h = texture->Height() + 2 * gutter;
+
+		Placement placement{texture};
+		PageLayout *layout = nullptr;
+		for (PageLayout &page : layouts) {
+			if (page.packer.Insert(w, h, placement.x, placement.y)) {
+				layout = &page;
+				break;
+			}
+		}
+		if (!layout) {
+			layout = &layouts.emplace_back(pageSize);
+			if (!layout->packer.Insert(w, h, placement.x, placement.y))
+				continue;
+		}
+
+		layout->placements.push_back(placement);
+		layout->right = std::max(layout->right, placement.x + w);
+		layout->top = std::max(layout->top, placement.y + h);
+	}
+
+	u64 usedArea = 0;
+	u64 pageArea = 0;
+	for (PageLayout &layout : layouts) {
+		// A page of one image saves nothing, the image keeps its own texture
+		if (layout.placements.size() < 2)
+			continue;
+
+		// The page shrinks to what was used
+		i32 width = std::min(NextPowerOfTwo(layout.right), pageSize);
+		i32 height = std::min(NextPowerOfTwo(layout.top), pageSize);
+		std::vector<u8> pixels(static_cast<size_t>(width) * height * 4, 0);
+		for (const Placement &placement : layout.placements) {
+			ImageTexture *texture = placement.texture;
+			CopyImage(pixels, width, placement.x, placement.y, texture->Pixels(), texture->Width(), texture->Height(), gutter);
+			usedArea += static_cast<u64>(texture->Width()) * texture->Height();
+		}
+		pageArea += static_cast<u64>(width) * height;
+
+		uint32_t id = 0;
+		glGenTextures(1, &id);
+		glBindTexture(GL_TEXTURE_2D, id);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, 0);
+
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+
+		Ref<AtlasPage> page = std::make_shared<AtlasPage>(id, width, height);
+		for (const Placement &placement : layout.placements) {
+			ImageTexture *texture = placement.texture;
+			glm::vec4 uvRect(
+				static_cast<f32>(placement.x + gutter) / width,
+				static_cast<f32>(placement.y + gutter) / height,
+				static_cast<f32>(texture->Width()) / width,
+				static_cast<f32>(texture->Height()) / height);
+			texture->SetAtlasPage(page, uvRect);
+		}
+
+		report.textures += static_cast<u32>(layout.placements.size());
+		report.pages++;
+	}
+
+	if (report.pages == 0)
+		return report;
+
+	report.occupancy = static_cast<f32>(usedArea) / static_cast<f32>(pageArea);
+	report.batchesBefore = (report.textures + BATCH2D_MAX_TEXTURE - 1) / BATCH2D_MAX_TEXTURE;
+	report.batchesAfter = (report.pages + BATCH2D_MAX_TEXTURE - 1) / BATCH2D_MAX_TEXTURE;
+	return report;
+}
+
+} // namespace TextureAtlas
\ No newline at end of file
@@ -0,0 +1,85 @@
+#ifndef TEXTURE_ATLAS_HPP
+#define TEXTURE_ATLAS_HPP
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "sowa.hpp"
+
+class ImageTexture;
+
+// Free space of one atlas page, packed with MaxRects using the best short side fit heuristic
+class MaxRectsPacker {
+  public:
+	MaxRectsPacker(i32 width, i32 height);
+
+	// Places a w x h rectangle and marks it used. Returns false if it does not fit
+	bool Insert(i32 w, i32 h, i32 &x, i32 &y);
+	// Fraction of the page in use
+	f32 Occupancy() const;
+
+  private:
+	struct Area {
+		i32 x = 0;
+		i32 y = 0;
+		i32 w = 0;
+		i32 h = 0;
+	};
+
+	// Cuts used out of every free area it overlaps
+	void split(const Area &used);
+	// Drops free areas contained in another one
+	void prune();
+
+	i32 _width = 0;
+	i32 _height = 0;
+	u64 _used = 0;
+	std::vector<Area> _free;
+};
+
+// GL texture images were packed into. Textures packed into it share ownership, it is freed with the last of them
+class AtlasPage {
+  public:
+	AtlasPage(uint32_t id, i32 width, i32 height) : _id(id), _width(width), _height(height) {}
+	~AtlasPage();
+
+	AtlasPage(const AtlasPage &) = delete;
+	AtlasPage &operator=(const AtlasPage &) = delete;
+
+	inline uint32_t ID() const { return _id; }
+	inline i32 Width() const { return _width; }
+	inline i32 Height() const { return _height; }
+
+  private:
+	uint32_t _id = 0;
+	i32 _width = 0;
+	i32 _height = 0;
+};
+
+struct AtlasSettings {
+	i32 pageSize = 2048;
+	// Larger images keep their own texture
+	i32 maxTextureSize = 256;
+	// Edge pixels are repeated this far around each image, so sampling at its border never reaches a neighbour
+	i32 gutter = 4;
+};
+
+struct AtlasReport {
+	u32 textures = 0;
+	u32 pages = 0;
+	f32 occupancy = 0.f;
+	// Fewest 2D batches that can draw every packed texture, without and with the atlas. Renderer2D binds up to
+	// BATCH2D_MAX_TEXTURE textures per batch
+	u32 batchesBefore = 0;
+	u32 batchesAfter = 0;
+};
+
+namespace TextureAtlas {
+// Packs textures that are decoded but not uploaded yet, no larger than maxTextureSize and imported with the default
+// TextureImportSettings into shared pages. Packed textures drop their pixels and draw from their page through a UV
+// sub-rect, the others are left for Upload. Main thread only
+AtlasReport Pack(const std::vector<ImageTexture *> &textures, const AtlasSettings &settings);
+} // namespace TextureAtlas
+
+#endif // TEXTURE_ATLAS_HPP
\ No newline at end of file
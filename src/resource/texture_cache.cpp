@@ -0,0 +1,226 @@
+#include "texture_cache.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <ostream>
+#include <vector>
+
+#include "core/application.hpp"
+#include "core/filesystem/filesystem.hpp"
+#include "utils/string.hpp"
+
+namespace TextureCache {
+
+struct Header {
+	char magic[4] = {'S', 'T', 'E', 'X'};
+	u32 version = Version;
+	u64 source = 0;
+	u16 format = 0;
+	u16 channels = 0;
+	u32 width = 0;
+	u32 height = 0;
+	u32 levels = 0;
+};
+static_assert(sizeof(Header) == 32, "stex header is written as is");
+
+u32 PixelSize(Format format) {
+	switch (format) {
+	case Format::RGB565:
+	case Format::RGBA4444:
+		return 2;
+	case Format::R8:
+		return 1;
+	default:
+		return 4;
+	}
+}
+
+const char *FormatName(Format format) {
+	switch (format) {
+	case Format::RGB565:
+		return "RGB565";
+	case Format::RGBA4444:
+		return "RGBA4444";
+	case Format::R8:
+		return "R8";
+	default:
+		return "RGBA8";
+	}
+}
+
+size_t ChainBytes(Format format, u32 width, u32 height, u32 levels) {
+	size_t size = 0;
+	for (u32 i = 0; i < levels; i++)
+		size += LevelBytes(format, width, height, i);
+	return size;
+}
+
+// FNV-1a over 8 byte words, the tail byte by byte. Sources are hashed on every load so this has to keep up with the
+// disk rather than be strong
+u64 HashSource(const FileData &source) {
+	const std::byte *data = source.Data();
+	size_t size = source.Size();
+
+	u64 hash = 0xcbf29ce484222325ull ^ size;
+	size_t i = 0;
+	for (; i + 8 <= size; i += 8) {
+		u64 word;
+		std::memcpy(&word, data + i, 8);
+		hash ^= word;
+		hash *= 0x100000001b3ull;
+	}
+	for (; i < size; i++) {
+		hash ^= static_cast<u8>(data[i]);
+		hash *= 0x100000001b3ull;
+	}
+	return hash;
+}
+
+u64 ImportKey(u64 sourceHash, Format format, bool mipmaps) {
+	u64 options = static_cast<u64>(format) << 1 | (mipmaps ? 1 : 0);
+	// Spreads the options over the whole key, so the same source imported two ways lands in two files
+	return sourceHash ^ ((options + 1) * 0x9e3779b97f4a7c15ull);
+}
+
+ResPath CachePath(u64 key) {
+	return ResPath(Utils::Format("res://.import/{:016x}.stex", key));
+}
+
+bool Load(u64 key, Image &out) {
+	Ref<FileData> file = App().FS().Load(CachePath(key));
+	if (!file || file->Size() < sizeof(Header))
+		return false;
+
+	Header header;
+	std::memcpy(&header, file->Data(), sizeof(Header));
+	if (std::memcmp(header.magic, "STEX", 4) != 0 || header.version != Version || header.source != key)
+		return false;
+	if (header.format >= static_cast<u16>(Format::Count) || header.width == 0 || header.height == 0 || header.levels == 0 || header.levels > 32)
+		return false;
+
+	size_t size = ChainBytes(static_cast<Format>(header.format), header.width, header.height, header.levels);
+	if (file->Size() != sizeof(Header) + size)
+		return false;
+
+	out.width = header.width;
+	out.height = header.height;
+	out.levels = header.levels;
+	out.format = static_cast<Format>(header.format);
+	out.channels = header.channels;
+	out.pixels = FileData::NewView(file, file->Data() + sizeof(Header), size);
+	return true;
+}
+
+bool Save(u64 key, const Image &image) {
+	if (!image.pixels || image.pixels->Size() != ChainBytes(image.format, image.width, image.height, image.levels))
+		return false;
+
+	SaveableFileServer *fs = dynamic_cast<SaveableFileServer *>(App().FS().GetFileServer("res"));
+	std::filesystem::path dir = App().FS().GetDiskPath(ResPath("res://.import"));
+	if (fs == nullptr || dir.empty())
+		return false;
+
+	std::error_code ec;
+	std::filesystem::create_directories(dir, ec);
+	if (ec)
+		return false;
+
+	Header header;
+	header.source = key;
+	header.format = static_cast<u16>(image.format);
+	header.channels = static_cast<u16>(image.channels);
+	header.width = image.width;
+	header.height = image.height;
+	header.levels = image.levels;
+
+	return fs->SaveAtomic(CachePath(key).String(), [&](std::ostream &stream) {
+		stream.write(reinterpret_cast<const char *>(&header), sizeof(Header));
+		stream.write(reinterpret_cast<const char *>(image.pixels->Data()), static_cast<std::streamsize>(image.pixels->Size()));
+		return stream.good();
+	});
+}
+
+static u8 Quantize(u8 value, u32 max) {
+	return static_cast<u8>((value * max + 127) / 255);
+}
+
+// Converts count RGBA pixels to format
+static void Convert(const u8 *src, u8 *dst, size_t count, Format format, bool hasAlpha) {
+	for (size_t i = 0; i < count; i++, src += 4) {
+		switch (format) {
+		case Format::RGB565: {
+			u16 texel = static_cast<u16>(Quantize(src[0], 31) << 11 | Quantize(src[1], 63) << 5 | Quantize(src[2], 31));
+			std::memcpy(dst + i * 2, &texel, 2);
+			break;
+		}
+		case Format::RGBA4444: {
+			u16 texel = static_cast<u16>(Quantize(src[0], 15) << 12 | Quantize(src[1], 15) << 8 | Quantize(src[2], 15) << 4 | Quantize(src[3], 15));
+			std::memcpy(dst + i * 2, &texel, 2);
+			break;
+		}
+		case Format::R8:
+			dst[i] = hasAlpha ? src[3] : src[0];
+			break;
+		default:
+			std::memcpy(dst + i * 4, src, 4);
+			break;
+		}
+	}
+}
+
+Image Import(const unsigned char *rgba, u32 width, u32 height, u32 channels, Format format, bool mipmaps) {
+	Image image;
+	image.width = width;
+	image.height = height;
+	image.format = format;
+	image.channels = channels;
+	image.levels = 1;
+	while (mipmaps && (LevelSize(width, image.levels - 1) > 1 || LevelSize(height, image.levels - 1) > 1))
+		image.levels++;
+
+	// Every level in RGBA first, the mips are filtered from full precision. RGBA8 images are built in place
+	size_t chainBytes = ChainBytes(Format::RGBA8, width, height, image.levels);
+	std::vector<u8> rgbaChain;
+	image.pixels = FileData::New();
+	if (format == Format::RGBA8)
+		image.pixels->Buffer().resize(chainBytes);
+	else
+		rgbaChain.resize(chainBytes);
+
+	u8 *chain = format == Format::RGBA8 ? reinterpret_cast<u8 *>(image.pixels->Data()) : rgbaChain.data();
+	u8 *dst = chain;
+	std::memcpy(dst, rgba, LevelBytes(Format::RGBA8, width, height, 0));
+
+	// Each level is a 2x2 box filter of the one before, odd edges repeat their last texel
+	for (u32 level = 1; level < image.levels; level++) {
+		const u8 *src = dst;
+		u32 srcW = LevelSize(width, level - 1), srcH = LevelSize(height, level - 1);
+		dst += LevelBytes(Format::RGBA8, width, height, level - 1);
+
+		u32 w = LevelSize(width, level), h = LevelSize(height, level);
+		for (u32 y = 0; y < h; y++) {
+			u32 y0 = y * 2, y1 = y0 + 1 < srcH ? y0 + 1 : y0;
+			for (u32 x = 0; x < w; x++) {
+				u32 x0 = x * 2, x1 = x0 + 1 < srcW ? x0 + 1 : x0;
+				const u8 *a = src + (static_cast<size_t>(y0) * srcW + x0) * 4;
+				const u8 *b = src + (static_cast<size_t>(y0) * srcW + x1) * 4;
+				const u8 *c = src + (static_cast<size_t>(y1) * srcW + x0) * 4;
+				const u8 *d = src + (static_cast<size_t>(y1) * srcW + x1) * 4;
+
+				u8 *out = dst + (static_cast<size_t>(y) * w + x) * 4;
+				for (u32 i = 0; i < 4; i++)
+					out[i] = static_cast<u8>((a[i] + b[i] + c[i] + d[i] + 2) / 4);
+			}
+		}
+	}
+
+	if (format == Format::RGBA8)
+		return image;
+
+	size_t texels = chainBytes / 4;
+	image.pixels->Buffer().resize(texels * PixelSize(format));
+	Convert(chain, reinterpret_cast<u8 *>(image.pixels->Data()), texels, format, channels == 2 || channels == 4);
+	return image;
+}
+
+} // namespace TextureCache
\ No newline at end of file
@@ -0,0 +1,64 @@
+#ifndef TEXTURE_CACHE_HPP
+#define TEXTURE_CACHE_HPP
+#pragma once
+
+#include <memory>
+
+#include "sowa.hpp"
+
+#include "core/filesystem/res_path.hpp"
+
+struct FileData;
+
+// Imported textures, saved under res://.import as <import key>.stex. A cached texture holds the pixels of its source in
+// their storage format together with the mip chain, so loading it needs neither stb_image nor glGenerateMipmap
+namespace TextureCache {
+// Bumped whenever the file layout changes, older files are treated as missing
+constexpr u32 Version = 2;
+
+enum class Format : u16 {
+	RGBA8 = 0,
+	RGB565,
+	RGBA4444,
+	// One channel, the source's alpha or its red channel if it has no alpha
+	R8,
+	Count,
+};
+
+struct Image {
+	u32 width = 0;
+	u32 height = 0;
+	u32 levels = 0;
+	Format format = Format::RGBA8;
+	// Channels of the source image
+	u32 channels = 4;
+	// Every level one after another, level 0 first
+	Ref<FileData> pixels;
+};
+
+u32 PixelSize(Format format);
+const char *FormatName(Format format);
+
+// Size of a mip level, levels halve down to 1x1
+inline u32 LevelSize(u32 size, u32 level) { return size >> level ? size >> level : 1; }
+inline size_t LevelBytes(Format format, u32 width, u32 height, u32 level) {
+	return static_cast<size_t>(LevelSize(width, level)) * LevelSize(height, level) * PixelSize(format);
+}
+size_t ChainBytes(Format format, u32 width, u32 height, u32 levels);
+
+u64 HashSource(const FileData &source);
+// Key of a source imported with the given options, the name of its cache file
+u64 ImportKey(u64 sourceHash, Format format, bool mipmaps);
+ResPath CachePath(u64 key);
+
+// Reads the texture imported under key. The pixels are a view into the loaded file
+bool Load(u64 key, Image &out);
+// Writes image under key. Returns false without logging when res:// can not be written to, as in packed builds
+bool Save(u64 key, const Image &image);
+
+// Converts RGBA pixels to format, with a mip chain down to 1x1 when mipmaps is set. Mips are box filtered before the
+// conversion. channels is what the source had before it was expanded to RGBA
+Image Import(const unsigned char *rgba, u32 width, u32 height, u32 channels, Format format, bool mipmaps);
+} // namespace TextureCache
+
+#endif // TEXTURE_CACHE_HPP
\ No newline at end of file
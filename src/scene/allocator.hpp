@@ -2,30 +2,90 @@
 #define ALLOCATOR_HPP
 #pragma once
 
+#include <algorithm>
 #include <functional>
 #include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
 
 #include "node.hpp"
 
 using NodeCreateFunc = std::function<Node *()>;
 using NodeDestroyFunc = std::function<void(Node *)>;
+using NodeCreateBatchFunc = std::function<void(size_t, Node **)>;
+
+// Chunked free list storage for a single node type. Memory is kept until shutdown and reused by later nodes
+template <typename T>
+class NodePool {
+  public:
+	static constexpr size_t ChunkSize = 64;
+
+	T *Allocate() {
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (_free.empty())
+			grow(ChunkSize);
+
+		T *slot = _free.back();
+		_free.pop_back();
+		return slot;
+	}
+
+	void Allocate(size_t count, T **out) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (_free.size() < count)
+			grow(std::max(count - _free.size(), ChunkSize));
+
+		std::copy(_free.end() - count, _free.end(), out);
+		_free.resize(_free.size() - count);
+	}
+
+	void Deallocate(T *slot) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		_free.push_back(slot);
+	}
+
+  private:
+	using Storage = std::aligned_storage_t<sizeof(T), alignof(T)>;
+
+	void grow(size_t count) {
+		Storage *chunk = _chunks.emplace_back(new Storage[count]).get();
+
+		// Reversed so slots are handed out in address order
+		_free.reserve(_free.size() + count);
+		for (size_t i = count; i > 0; i--) {
+			_free.push_back(reinterpret_cast<T *>(&chunk[i - 1]));
+		}
+	}
+
+	std::mutex _mutex;
+	std::vector<std::unique_ptr<Storage[]>> _chunks;
+	std::vector<T *> _free;
+};
 
 struct NodeAllocator {
   public:
 	//
 	template <typename T>
 	static NodeAllocator Get() {
-		std::allocator<T> *alloc = new std::allocator<T>;
+		static NodePool<T> pool;
 
 		static NodeAllocator allocator(
-			[alloc]() -> Node * {
-				T *node = alloc->allocate(1);
+			[]() -> Node * {
+				T *node = pool.Allocate();
 				new (node) T();
 				return node;
 			},
-			[alloc](Node *node) -> void {
+			[](Node *node) -> void {
 				node->~Node();
-				alloc->deallocate(reinterpret_cast<T *>(node), 1);
+				pool.Deallocate(static_cast<T *>(node));
+			},
+			[](size_t count, Node **out) -> void {
+				std::vector<T *> slots(count);
+				pool.Allocate(count, slots.data());
+				for (size_t i = 0; i < count; i++) {
+					out[i] = new (slots[i]) T();
+				}
 			});
 
 		return allocator;
@@ -33,8 +93,8 @@ struct NodeAllocator {
 
   public:
 	NodeAllocator() {}
-	NodeAllocator(NodeCreateFunc createFunc, NodeDestroyFunc destroyFunc)
-		: _createFunc(createFunc), _destroyFunc(destroyFunc) {}
+	NodeAllocator(NodeCreateFunc createFunc, NodeDestroyFunc destroyFunc, NodeCreateBatchFunc createBatchFunc = nullptr)
+		: _createFunc(createFunc), _destroyFunc(destroyFunc), _createBatchFunc(createBatchFunc) {}
 
 	inline Node *Create() {
 		if (!_createFunc)
@@ -43,6 +103,22 @@ struct NodeAllocator {
 		return _createFunc();
 	}
 
+	// Creates count nodes with a single pool allocation
+	inline bool Create(size_t count, Node **out) {
+		if (_createBatchFunc) {
+			_createBatchFunc(count, out);
+			return true;
+		}
+
+		if (!_createFunc)
+			return false;
+
+		for (size_t i = 0; i < count; i++) {
+			out[i] = _createFunc();
+		}
+		return true;
+	}
+
 	inline void Destroy(Node *node) {
 		if (!_destroyFunc)
 			return;
@@ -53,6 +129,7 @@ struct NodeAllocator {
   private:
 	NodeCreateFunc _createFunc;
 	NodeDestroyFunc _destroyFunc;
+	NodeCreateBatchFunc _createBatchFunc;
 };
 
 #endif // ALLOCATOR_HPP
\ No newline at end of file
@@ -1,79 +1,214 @@
 #include "node.hpp"
 
+#include "glm/glm.hpp"
+
 #include "core/application.hpp"
+#include "editor/gui.hpp"
+#include "scene/node_db.hpp"
 
 #include "imgui.h"
 #include "misc/cpp/imgui_stdlib.h"
 
+SW_OFFSETOF_BEGIN
+const NodeProperty Node::s_Properties[] = {
+	SW_PROPERTY(Node, _name, "Name", "name").Flags(PropertyFlags_Serialize | PropertyFlags_Copy),
+	SW_PROPERTY(Node, _id, "ID", "id").Flags(PropertyFlags_Serialize),
+	SW_PROPERTY(Node, _groups, "Groups", "groups").Flags(PropertyFlags_Serialize | PropertyFlags_Copy | PropertyFlags_Editor),
+};
+SW_OFFSETOF_END
+const NodePropertyTable Node::Properties = Node::s_Properties;
+
 void Node::RemoveChild(Node *child) {
 	child->_parent = nullptr;
 	removeChild(child);
 }
 
 bool Node::Serialize(Document &doc) {
-	doc.SetString("Type", App().GetNodeDB().GetNodeTypename(TypeID()));
-	doc.SetString("Name", Name());
-	doc.SetU64("ID", ID());
-	doc.Set("Groups", _groups);
+	if (!Type())
+		return false;
+
+	doc.SetString("Type", Type()->name);
+	for (const NodeProperty &prop : Type()->properties) {
+		if (prop.Has(PropertyFlags_Serialize))
+			NodeProperties::Write(doc, prop, this);
+	}
 
 	return true;
 }
 
 bool Node::Deserialize(const Document &doc) {
-	Rename(doc.GetString("Name", Name()));
-	_id = doc.GetU64("ID", ID());
-	_groups = doc.Get("Groups", _groups);
+	if (!Type())
+		return false;
+
+	// One pass over the document's values, they are matched to properties through the type's index
+	doc.ForEachValue([this](std::string_view key, const DocumentValue &value) {
+		const NodeProperty *prop = Type()->FindProperty(key);
+		if (prop && prop->Has(PropertyFlags_Serialize))
+			NodeProperties::Read(value, *prop, this);
+	});
 
+	MarkDirty();
 	return true;
 }
 
 bool Node::Copy(Node *dst) {
-	dst->Rename(Name());
-	dst->_groups = _groups;
+	if (!Type() || !dst->Type())
+		return false;
+
+	if (dst->Type() == Type()) {
+		copyPlan(dst);
+		dst->MarkDirty();
+		return true;
+	}
+
+	// Nodes of different types share the properties of their common ancestors
+	for (const NodeProperty &prop : Type()->properties) {
+		if (prop.Has(PropertyFlags_Copy) && dst->Type()->IsA(prop.owner))
+			NodeProperties::Copy(prop, this, dst);
+	}
+	dst->MarkDirty();
 	return true;
 }
 
+void Node::copyPlan(Node *dst) const {
+	for (u32 index : Type()->copyProperties) {
+		NodeProperties::Copy(Type()->properties[index], this, dst);
+	}
+}
+
 void Node::UpdateEditor() {
-	if (ImGui::CollapsingHeader("Node", ImGuiTreeNodeFlags_DefaultOpen)) {
+	if (!Type())
+		return;
+
+	// One header per type, the most derived first
+	NodeDB &db = App().GetNodeDB();
+	for (NodeTypeID id = TypeID(); id != 0; id = db.GetNodeType(id).extends) {
+		const NodeType &type = db.GetNodeType(id);
+		if (!ImGui::CollapsingHeader(type.name.c_str(), ImGuiTreeNodeFlags_DefaultOpen))
+			continue;
+
+		ImGui::PushID(type.name.c_str());
 		ImGui::Indent();
+		for (const NodeProperty &prop : Type()->properties) {
+			if (prop.owner == id && prop.Has(PropertyFlags_Editor))
+				drawProperty(prop);
+		}
+		ImGui::Unindent();
+		ImGui::PopID();
+	}
+}
 
-		if (ImGui::CollapsingHeader("Groups", ImGuiTreeNodeFlags_DefaultOpen)) {
-			ImGui::Indent();
-			for (size_t i = 0; i < _groups.size();) {
-				ImGui::PushID((void *)&_groups[i]);
-
-				ImGui::Text("%s", _groups[i].c_str());
-				ImGui::SameLine();
-				if (ImGui::Button("x", ImVec2(24, 24))) {
-					RemoveGroup(_groups[i]);
-				} else {
-					i++;
-				}
+void Node::drawProperty(const NodeProperty &prop) {
+	ImGui::PushID(prop.name);
+	ImGui::Text("%s", prop.name);
 
-				ImGui::PopID();
-			}
+	if (prop.type == PropertyType::StringList) {
+		std::vector<std::string> &list = prop.Ref<std::vector<std::string>>(this);
+
+		ImGui::Indent();
+		for (size_t i = 0; i < list.size();) {
+			ImGui::PushID(static_cast<int>(i));
 
-			if (ImGui::Button("+", ImVec2(24, 24))) {
-				ImGui::OpenPopup("Node_Groups_Add");
+			ImGui::Text("%s", list[i].c_str());
+			ImGui::SameLine();
+			if (ImGui::Button("x", ImVec2(24, 24))) {
+				list.erase(list.begin() + i);
+				MarkDirty();
+			} else {
+				i++;
 			}
 
-			if (ImGui::BeginPopup("Node_Groups_Add")) {
-				std::string buf = "";
-				ImGui::Text("Group");
-				ImGui::SameLine();
+			ImGui::PopID();
+		}
+
+		if (ImGui::Button("+", ImVec2(24, 24))) {
+			ImGui::OpenPopup("Add");
+		}
+
+		if (ImGui::BeginPopup("Add")) {
+			std::string buf = "";
+			ImGui::Text("%s", prop.name);
+			ImGui::SameLine();
 
-				if (ImGui::InputText("##Group", &buf, ImGuiInputTextFlags_EnterReturnsTrue)) {
-					AddGroup(buf);
-					ImGui::CloseCurrentPopup();
+			if (ImGui::InputText("##Add", &buf, ImGuiInputTextFlags_EnterReturnsTrue)) {
+				if (!buf.empty() && std::find(list.begin(), list.end(), buf) == list.end()) {
+					list.push_back(buf);
+					MarkDirty();
 				}
+				ImGui::CloseCurrentPopup();
+			}
+
+			ImGui::EndPopup();
+		}
+		ImGui::Unindent();
+
+		ImGui::PopID();
+		return;
+	}
+
+	ImGui::SameLine();
+	ImGuiSliderFlags clamp = prop.min < prop.max ? ImGuiSliderFlags_AlwaysClamp : ImGuiSliderFlags_None;
+
+	if (prop.hint == PropertyHint::Custom) {
+		editProperty(prop);
+		ImGui::PopID();
+		return;
+	}
+
+	bool changed = false;
+	switch (prop.type) {
+	case PropertyType::Bool:
+		changed = ImGui::Checkbox("##Value", &prop.Ref<bool>(this));
+		break;
 
-				ImGui::EndPopup();
+	case PropertyType::Int:
+		if (prop.hint == PropertyHint::Texture)
+			changed = Gui::TexturePicker("##Value", prop.Ref<i32>(this));
+		else if (prop.hint == PropertyHint::Animation)
+			changed = Gui::AnimationInput("##Value", prop.Ref<i32>(this));
+		else
+			changed = ImGui::InputInt("##Value", &prop.Ref<i32>(this));
+		break;
+
+	case PropertyType::U64:
+		changed = ImGui::InputScalar("##Value", ImGuiDataType_U64, &prop.Ref<u64>(this));
+		break;
+
+	case PropertyType::Float: {
+		f32 &value = prop.Ref<f32>(this);
+		if (prop.hint == PropertyHint::Angle) {
+			float rad = glm::radians(value);
+			if (ImGui::SliderAngle("##Value", &rad)) {
+				value = glm::degrees(rad);
+				changed = true;
 			}
-			ImGui::Unindent();
+		} else if (prop.hint == PropertyHint::Slider) {
+			changed = ImGui::SliderFloat("##Value", &value, prop.min, prop.max);
+		} else {
+			changed = ImGui::DragFloat("##Value", &value, prop.speed, prop.min, prop.max, "%.3f", clamp);
 		}
+		break;
+	}
 
-		ImGui::Unindent();
+	case PropertyType::String:
+		changed = ImGui::InputText("##Value", &prop.Ref<std::string>(this));
+		break;
+
+	case PropertyType::Vec2:
+		changed = ImGui::DragFloat2("##Value", &prop.Ref<Vector2>(this).x, prop.speed, prop.min, prop.max, "%.3f", clamp);
+		break;
+
+	case PropertyType::Color:
+		changed = ImGui::ColorEdit4("##Value", &prop.Ref<Color>(this).r);
+		break;
+
+	case PropertyType::StringList:
+		break;
 	}
+
+	if (changed)
+		MarkDirty();
+	ImGui::PopID();
 }
 
 void Node::AddChild(Node *child) {
@@ -82,6 +217,7 @@ void Node::AddChild(Node *child) {
 	}
 	child->_parent = this;
 	_children.push_back(child);
+	markSubtreeDirty();
 }
 
 void Node::Free() {
@@ -137,4 +273,16 @@ Node *Node::Duplicate(Scene *scene /*= nullptr*/) {
 
 void Node::removeChild(Node *child) {
 	_children.erase(std::remove(_children.begin(), _children.end(), child), _children.end());
+	markSubtreeDirty();
+}
+
+void Node::markDirty() {
+	_dirty = true;
+	markSubtreeDirty();
+}
+
+void Node::markSubtreeDirty() {
+	// Stops at the first flagged ancestor, everything above it is flagged already
+	for (Node *node = this; nullptr != node && !node->_subtreeDirty; node = node->_parent)
+		node->_subtreeDirty = true;
 }
\ No newline at end of file
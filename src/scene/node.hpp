@@ -8,10 +8,12 @@
 #include <vector>
 
 #include "core/serialize/document.hpp"
+#include "node_property.hpp"
 #include "sowa.hpp"
 #include "utils/utils.hpp"
 
 class Scene;
+struct NodeType;
 
 class Node {
   public:
@@ -21,20 +23,28 @@ class Node {
 	virtual void Update() {}
 	virtual void Exit() {}
 
+	// Serialize, Deserialize, Copy and UpdateEditor work through the property tables registered with NodeDB. Node types
+	// only override them for state that is not a property
 	virtual bool Serialize(Document &doc);
 	virtual bool Deserialize(const Document &doc);
 
 	virtual bool Copy(Node *dst);
 	virtual void UpdateEditor();
 
+	static const NodePropertyTable Properties;
+
 	//
 	inline NodeTypeID TypeID() const { return _typeid; }
+	inline const NodeType *Type() const { return _type; }
 	inline NodeID ID() const { return _id; }
 	inline std::string GetID() const { return std::to_string(_id); }
 
 	inline const std::string &Name() const { return _name; }
 	inline const std::string &GetName() const { return _name; }
-	inline void Rename(const std::string &name) { _name = name; }
+	inline void Rename(const std::string &name) {
+		_name = name;
+		MarkDirty();
+	}
 	inline const std::vector<std::string> &Groups() const { return _groups; }
 	inline bool IsInGroup(const std::string &group) {
 		return std::find(_groups.begin(), _groups.end(), group) != _groups.end();
@@ -44,11 +54,13 @@ class Node {
 			return;
 
 		_groups.push_back(group);
+		MarkDirty();
 	}
 	inline void RemoveGroup(const std::string &group) {
 		for (size_t i = 0; i < _groups.size();) {
 			if (_groups[i] == group) {
 				_groups.erase(_groups.begin() + i);
+				MarkDirty();
 				return;
 			}
 			i++;
@@ -57,6 +69,7 @@ class Node {
 
 	inline std::vector<Node *> GetChildren() { return _children; }
 	inline Node *GetParent() { return _parent; }
+	inline Scene *GetScene() { return _pScene; }
 
 	void RemoveChild(Node *child);
 	void AddChild(Node *child);
@@ -70,14 +83,35 @@ class Node {
 	// If no scene is given, duplicates in current scene
 	Node *Duplicate(Scene *scene = nullptr);
 
+	// Tells the scene the node changed since it was last saved, the save serializes it again. Accessors, the inspector,
+	// scripts and Deserialize call it, code that writes a property field directly has to call it too
+	inline void MarkDirty() {
+		if (!_dirty)
+			markDirty();
+	}
+
+  protected:
+	// Draws the inspector widget of a property with PropertyHint::Custom, the label is already drawn
+	virtual void editProperty(const NodeProperty &prop) {}
+
   private:
 	// Internal hierarchy functions that does not modify other than the node passed
 	void removeChild(Node *child);
+	void drawProperty(const NodeProperty &prop);
+	// Copies through the type's copy plan, dst must have the same type
+	void copyPlan(Node *dst) const;
+
+	void markDirty();
+	// Flags the node and its ancestors, the saved text of their subtrees is stale
+	void markSubtreeDirty();
+
+	static const NodeProperty s_Properties[];
 
 	friend class Scene;
 	friend class NodeDB;
 
 	NodeTypeID _typeid = 0;
+	const NodeType *_type = nullptr;
 	NodeID _id = 0;
 
 	std::string _name = "";
@@ -87,6 +121,10 @@ class Node {
 	std::vector<Node *> _children;
 
 	Scene *_pScene = nullptr;
+
+	// Save cache state, cleared by the scene when it saves the node. A dirty node always has subtree dirty ancestors
+	bool _dirty = true;
+	bool _subtreeDirty = true;
 };
 
 #endif // NODE_HPP
\ No newline at end of file
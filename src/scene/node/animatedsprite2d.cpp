@@ -3,31 +3,51 @@
 #include "imgui.h"
 
 #include "core/application.hpp"
-#include "editor/gui.hpp"
+
+SW_OFFSETOF_BEGIN
+const NodeProperty AnimatedSprite2D::s_Properties[] = {
+	SW_PROPERTY(AnimatedSprite2D, _animation, "Animation", "animation").Hint(PropertyHint::Animation),
+	SW_PROPERTY(AnimatedSprite2D, _currentAnimation, "CurrentAnimation", "current_animation").Hint(PropertyHint::Custom).Flags(PropertyFlags_Serialize | PropertyFlags_Copy | PropertyFlags_Editor),
+	SW_PROPERTY(AnimatedSprite2D, _animationScale, "AnimationScale", "animation_scale").Speed(0.1f),
+	SW_PROPERTY(AnimatedSprite2D, _playing, "Playing", "playing").Hint(PropertyHint::Custom),
+};
+SW_OFFSETOF_END
+const NodePropertyTable AnimatedSprite2D::Properties = AnimatedSprite2D::s_Properties;
 
 void AnimatedSprite2D::Start() {
 	_playing = true;
+	MarkDirty();
 	RestartAnimation();
 }
 
 void AnimatedSprite2D::Update() {
-	if (!IsVisible())
+	if (!IsVisible()) {
+		removeBounds();
 		return;
+	}
 
-	SpriteSheetAnimation *res = dynamic_cast<SpriteSheetAnimation *>(App().GetResourceRegistry().GetResource(_animation));
-	if (!res)
+	SpriteSheetAnimation *res = App().GetResourceRegistry().Resolve(_animationHandle, _animation);
+	if (!res) {
+		removeBounds();
 		return;
+	}
 
 	SpriteSheet *anim = res->GetAnimation(_currentAnimation);
-	if (!anim)
+	if (!anim) {
+		removeBounds();
 		return;
+	}
 
-	if (anim->frames.size() == 0)
+	if (anim->frames.size() == 0) {
+		removeBounds();
 		return;
+	}
 
-	ImageTexture *texture = dynamic_cast<ImageTexture *>(App().GetResourceRegistry().GetResource(anim->texture));
-	if (!texture)
+	ImageTexture *texture = App().GetResourceRegistry().Resolve(_textureHandle, anim->texture);
+	if (!texture) {
+		removeBounds();
 		return;
+	}
 
 	if (_playing) {
 		_animationDelta += std::max(App().Delta() * _animationScale, 0.f);
@@ -46,39 +66,19 @@ void AnimatedSprite2D::Update() {
 
 	glm::vec2 topLeft(frameSize.x * anim->frames[_frameIndex].x, 1.f - frameSize.y * anim->frames[_frameIndex].y);
 
+	glm::mat4 transform = GetTransform();
+	glm::vec2 size(texture->Width() * frameSize.x, texture->Height() * frameSize.y);
+	updateBounds(transform, Rect(-size.x * 0.5f, -size.y * 0.5f, size.x, size.y));
+
 	App().GetRenderer().GetRenderer2D("2D").PushQuad(PushQuadArgs{
-		.transform = GetTransform(),
+		.transform = transform,
 		.textureID = static_cast<float>(texture->ID()),
 		.z = static_cast<float>(GetZIndex()),
 		.drawID = static_cast<float>(ID()),
 		.color = Color(1.f),
-		.textureScale = glm::vec2(texture->Width() * frameSize.x, texture->Height() * frameSize.y),
-		.uvTopLeft = topLeft,
-		.uvBottomRight = glm::vec2(topLeft.x + frameSize.x, topLeft.y - frameSize.y)});
-}
-
-bool AnimatedSprite2D::Serialize(Document &doc) {
-	if (!Node2D::Serialize(doc)) {
-		return false;
-	}
-
-	doc.Set("Animation", _animation);
-	doc.Set("CurrentAnimation", _currentAnimation);
-	doc.Set("AnimationScale", _animationScale);
-	doc.Set("Playing", _playing);
-	return true;
-}
-
-bool AnimatedSprite2D::Deserialize(const Document &doc) {
-	if (!Node2D::Deserialize(doc)) {
-		return false;
-	}
-
-	_animation = doc.Get("Animation", _animation);
-	_currentAnimation = doc.Get("CurrentAnimation", _currentAnimation);
-	_animationScale = doc.Get("AnimationScale", _animationScale);
-	_playing = doc.Get("Playing", _playing);
-	return true;
+		.textureScale = size,
+		.uvTopLeft = texture->MapUV(topLeft),
+		.uvBottomRight = texture->MapUV(glm::vec2(topLeft.x + frameSize.x, topLeft.y - frameSize.y))});
 }
 
 bool AnimatedSprite2D::Copy(Node *dst) {
@@ -86,29 +86,19 @@ bool AnimatedSprite2D::Copy(Node *dst) {
 		return false;
 	}
 
-	AnimatedSprite2D *dstNode = dynamic_cast<AnimatedSprite2D *>(dst);
-	dstNode->_animation = _animation;
-	dstNode->SetCurrentAnimation(_currentAnimation);
-	dstNode->_animationScale = _animationScale;
-	dstNode->_playing = _playing;
-	dstNode->_frameIndex = _frameIndex;
-	dstNode->_animationDelta = _animationDelta;
+	// Playback position is not a property
+	if (AnimatedSprite2D *dstNode = node_cast<AnimatedSprite2D>(dst); nullptr != dstNode) {
+		dstNode->_frameIndex = _frameIndex;
+		dstNode->_animationDelta = _animationDelta;
+	}
 	return true;
 }
 
-void AnimatedSprite2D::UpdateEditor() {
-	if (ImGui::CollapsingHeader("AnimatedSprite2D", ImGuiTreeNodeFlags_DefaultOpen)) {
-		ImGui::Indent();
-
-		ImGui::Text("%s", "Animation");
-		ImGui::SameLine();
-		Gui::AnimationInput("##Animation", _animation);
-
-		SpriteSheetAnimation *animation = dynamic_cast<SpriteSheetAnimation *>(App().GetResourceRegistry().GetResource(_animation));
-
-		ImGui::Text("%s", "Current Animation");
-		ImGui::SameLine();
-		if (ImGui::BeginCombo("##CurrentAnimation", _currentAnimation.c_str())) {
+SW_OFFSETOF_BEGIN
+void AnimatedSprite2D::editProperty(const NodeProperty &prop) {
+	if (prop.offset == offsetof(AnimatedSprite2D, _currentAnimation)) {
+		SpriteSheetAnimation *animation = App().GetResourceRegistry().Resolve(_animationHandle, _animation);
+		if (ImGui::BeginCombo("##Value", _currentAnimation.c_str())) {
 			if (animation) {
 				for (auto &[name, anim] : animation->GetAnimations()) {
 					if (ImGui::Selectable(name.c_str())) {
@@ -118,23 +108,16 @@ void AnimatedSprite2D::UpdateEditor() {
 			}
 			ImGui::EndCombo();
 		}
-
-		ImGui::Text("%s", "Animation Scale");
-		ImGui::SameLine();
-		ImGui::DragFloat("##AnimationScale", &_animationScale, 0.1f, 0.f);
-
-		ImGui::Text("%s", "Playing");
-		ImGui::SameLine();
-		if (ImGui::Checkbox("##Playing", &_playing)) {
+	} else if (prop.offset == offsetof(AnimatedSprite2D, _playing)) {
+		if (ImGui::Checkbox("##Value", &_playing)) {
+			MarkDirty();
 			if (_playing) {
 				RestartAnimation();
 			}
 		}
-
-		ImGui::Unindent();
 	}
-	Node2D::UpdateEditor();
 }
+SW_OFFSETOF_END
 
 const std::string &AnimatedSprite2D::GetCurrentAnimation() {
 	return _currentAnimation;
@@ -142,6 +125,7 @@ const std::string &AnimatedSprite2D::GetCurrentAnimation() {
 
 void AnimatedSprite2D::SetCurrentAnimation(const std::string &name, bool reset /* = true*/) {
 	_currentAnimation = name;
+	MarkDirty();
 	if (reset)
 		RestartAnimation();
 }
@@ -8,6 +8,7 @@
 
 #include "node2d.hpp"
 #include "resource/image_texture.hpp"
+#include "resource/resource_registry.hpp"
 #include "resource/sprite_sheet_animation.hpp"
 
 class AnimatedSprite2D : public Node2D {
@@ -17,11 +18,9 @@ class AnimatedSprite2D : public Node2D {
 	void Start() override;
 	void Update() override;
 
-	bool Serialize(Document &doc) override;
-	bool Deserialize(const Document &doc) override;
-
 	bool Copy(Node *dst) override;
-	void UpdateEditor() override;
+
+	static const NodePropertyTable Properties;
 
 	// SpriteSheetAnimation
 	RID _animation;
@@ -35,10 +34,19 @@ class AnimatedSprite2D : public Node2D {
 	bool _playing = false;
 	float _animationScale = 1.f;
 
+  protected:
+	void editProperty(const NodeProperty &prop) override;
+
   private:
 	int _frameIndex = 0;
 	std::string _currentAnimation = "";
 	float _animationDelta = 0.f;
+
+	ResHandle<SpriteSheetAnimation> _animationHandle;
+	// Texture of the current sprite sheet
+	ResHandle<ImageTexture> _textureHandle;
+
+	static const NodeProperty s_Properties[];
 };
 
 #endif // ANIMATEDSPRITE2D_HPP
\ No newline at end of file
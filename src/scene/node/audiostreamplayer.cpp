@@ -9,17 +9,29 @@
 
 #include "imgui.h"
 
-AudioStreamPlayer::AudioStreamPlayer() {
-	alGenSources(1, &_sourceID);
-	alSourcef(_sourceID, AL_PITCH, 1.f);
-	alSourcef(_sourceID, AL_GAIN, 1.f);
-	alSourcei(_sourceID, AL_LOOPING, false);
-}
+SW_OFFSETOF_BEGIN
+const NodeProperty AudioStreamPlayer::s_Properties[] = {
+	SW_PROPERTY(AudioStreamPlayer, _stream, "Stream", "stream").Hint(PropertyHint::Custom),
+	SW_PROPERTY(AudioStreamPlayer, _autoplay, "Autoplay", "autoplay"),
+	SW_PROPERTY(AudioStreamPlayer, _loop, "Loop", "loop"),
+	SW_PROPERTY(AudioStreamPlayer, _gain, "Gain", "gain").Speed(0.001f).Min(0.f),
+	SW_PROPERTY(AudioStreamPlayer, _pitch, "Pitch", "pitch").Hint(PropertyHint::Slider).Range(0.5f, 2.f),
+};
+SW_OFFSETOF_END
+const NodePropertyTable AudioStreamPlayer::Properties = AudioStreamPlayer::s_Properties;
+
+// Async scene loads create nodes on a worker thread, the source is created by the first Play on the main thread
+AudioStreamPlayer::AudioStreamPlayer() {}
 
 AudioStreamPlayer::~AudioStreamPlayer() {
+	if (_sourceID == 0)
+		return;
+
 	if (HasValidAudio()) {
 		Stop();
 	}
+	// Its buffers are queued on the source
+	_playback.reset();
 	alDeleteSources(1, &_sourceID);
 }
 
@@ -28,17 +40,50 @@ void AudioStreamPlayer::Exit() {
 }
 
 void AudioStreamPlayer::Play() {
-	AudioStream *stream = dynamic_cast<AudioStream *>(App().GetResourceRegistry().GetResource(_stream));
+	AudioStream *stream = this->stream();
 	if (!stream) {
 		Debug::Error("Failed to play audio. Stream not found: {}", _stream);
 		return;
 	}
 
-	if (stream->ID() == 0) {
+	if (!stream->IsLoaded()) {
 		Debug::Error("Failed to play audio. Invalid stream");
 		return;
 	}
 
+	if (_sourceID == 0) {
+		alGenSources(1, &_sourceID);
+		alSourcef(_sourceID, AL_PITCH, 1.f);
+		alSourcef(_sourceID, AL_GAIN, 1.f);
+		alSourcei(_sourceID, AL_LOOPING, false);
+	}
+
+	// Long assets play through a playback of their own that queues buffers as they decode
+	if (stream->IsStreamed()) {
+		if (!_playback || !_playback->IsOf(*stream)) {
+			alSourceStop(_sourceID);
+			alSourcei(_sourceID, AL_BUFFER, 0);
+			_lastBuffer = 0;
+
+			_playback = stream->NewPlayback(_sourceID);
+			if (!_playback) {
+				Debug::Error("Failed to play audio. Stream can not be opened");
+				return;
+			}
+		} else if (IsPaused()) {
+			updateSource();
+			alSourcePlay(_sourceID);
+			return;
+		}
+
+		updateSource();
+		_playback->Play(_loop);
+		return;
+	}
+
+	// Drops the queue of the last streamed asset
+	_playback.reset();
+
 	if (_lastBuffer != stream->ID()) {
 		_lastBuffer = stream->ID();
 		alSourcei(_sourceID, AL_BUFFER, _lastBuffer);
@@ -49,36 +94,48 @@ void AudioStreamPlayer::Play() {
 }
 
 void AudioStreamPlayer::Stop() {
-	AudioStream *stream = dynamic_cast<AudioStream *>(App().GetResourceRegistry().GetResource(_stream));
+	AudioStream *stream = this->stream();
 	if (!stream) {
 		Debug::Error("Failed to stop audio. Stream not found: {}", _stream);
 		return;
 	}
 
-	if (stream->ID() == 0) {
+	if (!stream->IsLoaded()) {
 		Debug::Error("Failed to stop audio. Invalid stream");
 		return;
 	}
 
+	// Never played
+	if (_sourceID == 0)
+		return;
+
 	alSourceStop(_sourceID);
+	if (_playback)
+		_playback->Stop();
 }
 
 void AudioStreamPlayer::Pause() {
-	AudioStream *stream = dynamic_cast<AudioStream *>(App().GetResourceRegistry().GetResource(_stream));
+	AudioStream *stream = this->stream();
 	if (!stream) {
 		Debug::Error("Failed to pause audio. Stream not found");
 		return;
 	}
 
-	if (stream->ID() == 0) {
+	if (!stream->IsLoaded()) {
 		Debug::Error("Failed to pause audio. Invalid stream");
 		return;
 	}
 
+	if (_sourceID == 0)
+		return;
+
 	alSourcePause(_sourceID);
 }
 
 bool AudioStreamPlayer::IsPlaying() {
+	if (_sourceID == 0)
+		return false;
+
 	int playing = 0;
 	alGetSourcei(_sourceID, AL_SOURCE_STATE, &playing);
 
@@ -86,6 +143,9 @@ bool AudioStreamPlayer::IsPlaying() {
 }
 
 bool AudioStreamPlayer::IsPaused() {
+	if (_sourceID == 0)
+		return false;
+
 	int playing = 0;
 	alGetSourcei(_sourceID, AL_SOURCE_STATE, &playing);
 
@@ -93,12 +153,12 @@ bool AudioStreamPlayer::IsPaused() {
 }
 
 bool AudioStreamPlayer::HasValidAudio() {
-	AudioStream *stream = dynamic_cast<AudioStream *>(App().GetResourceRegistry().GetResource(_stream));
+	AudioStream *stream = this->stream();
 	if (!stream) {
 		return false;
 	}
 
-	if (stream->ID() == 0) {
+	if (!stream->IsLoaded()) {
 		return false;
 	}
 
@@ -116,87 +176,34 @@ void AudioStreamPlayer::Update() {
 		updateSource();
 }
 
-bool AudioStreamPlayer::Serialize(Document &doc) {
-	if (!Node::Serialize(doc))
-		return false;
-
-	doc.Set("Stream", _stream);
-	doc.Set("Autoplay", _autoplay);
-	doc.Set("Pitch", _pitch);
-	doc.Set("Gain", _gain);
-	doc.Set("Loop", _loop);
-	return true;
-}
-
-bool AudioStreamPlayer::Deserialize(const Document &doc) {
-	if (!Node::Deserialize(doc))
-		return false;
-
-	_stream = doc.Get("Stream", _stream);
-	_autoplay = doc.Get("Autoplay", _autoplay);
-	_loop = doc.Get("Loop", _loop);
-	_gain = doc.Get("Gain", _gain);
-	_pitch = doc.Get("Pitch", _pitch);
-
-	return true;
-}
-
-bool AudioStreamPlayer::Copy(Node *dst) {
-	if (!Node::Copy(dst))
-		return false;
-
-	AudioStreamPlayer *dstNode = dynamic_cast<AudioStreamPlayer *>(dst);
-	dstNode->_stream = _stream;
-	dstNode->_autoplay = _autoplay;
-	dstNode->_loop = _loop;
-	dstNode->_gain = _gain;
-	dstNode->_pitch = _pitch;
-
-	return true;
-}
-
-void AudioStreamPlayer::UpdateEditor() {
-	if (ImGui::CollapsingHeader("AudioStreamPlayer", ImGuiTreeNodeFlags_DefaultOpen)) {
-		ImGui::Indent();
-
-		ImGui::Text("Stream");
-		ImGui::SameLine();
-		ImGui::InputInt("##Stream", &_stream);
+SW_OFFSETOF_BEGIN
+void AudioStreamPlayer::editProperty(const NodeProperty &prop) {
+	if (prop.offset != offsetof(AudioStreamPlayer, _stream))
+		return;
 
-		if (IsPlaying()) {
-			if (ImGui::Button("Stop")) {
-				Stop();
-			}
-		} else {
-			if (ImGui::Button("Play")) {
-				Play();
-			}
+	if (ImGui::InputInt("##Value", &_stream))
+		MarkDirty();
+	if (IsPlaying()) {
+		if (ImGui::Button("Stop")) {
+			Stop();
+		}
+	} else {
+		if (ImGui::Button("Play")) {
+			Play();
 		}
-
-		ImGui::Text("Autoplay");
-		ImGui::SameLine();
-		ImGui::Checkbox("##Autoplay", &_autoplay);
-
-		ImGui::Text("Loop");
-		ImGui::SameLine();
-		ImGui::Checkbox("##Loop", &_loop);
-
-		ImGui::Text("Gain");
-		ImGui::SameLine();
-		ImGui::DragFloat("##Gain", &_gain, 0.001, 0.f, FLT_MAX, "%.3f", ImGuiSliderFlags_AlwaysClamp);
-
-		ImGui::Text("Pitch");
-		ImGui::SameLine();
-		ImGui::SliderFloat("##Pitch", &_pitch, 0.5f, 2.f);
-
-		ImGui::Unindent();
 	}
+}
+SW_OFFSETOF_END
 
-	Node::UpdateEditor();
+AudioStream *AudioStreamPlayer::stream() {
+	return App().GetResourceRegistry().Resolve(_streamHandle, _stream);
 }
 
 void AudioStreamPlayer::updateSource() {
 	alSourcef(_sourceID, AL_PITCH, Math::Clamp(_pitch, 0.5f, 2.f));
 	alSourcef(_sourceID, AL_GAIN, _gain);
-	alSourcei(_sourceID, AL_LOOPING, _loop);
+	// Streams loop by decoding from the start again, a looping source would replay its queue
+	alSourcei(_sourceID, AL_LOOPING, _loop && !_playback);
+	if (_playback)
+		_playback->SetLoop(_loop);
 }
\ No newline at end of file
@@ -2,7 +2,10 @@
 #define AUDIOSTREAMPLAYER_HPP
 #pragma once
 
+#include <memory>
+
 #include "resource/audio_stream.hpp"
+#include "resource/resource_registry.hpp"
 #include "scene/node.hpp"
 
 class AudioStreamPlayer : public Node {
@@ -14,11 +17,7 @@ class AudioStreamPlayer : public Node {
 	void Update() override;
 	void Exit() override;
 
-	bool Serialize(Document &doc) override;
-	bool Deserialize(const Document &doc) override;
-
-	bool Copy(Node *dst) override;
-	void UpdateEditor() override;
+	static const NodePropertyTable Properties;
 
 	void Play();
 	void Pause();
@@ -35,11 +34,20 @@ class AudioStreamPlayer : public Node {
 	float _pitch = 1.f; // min 0.5, max 2.0
 	float _gain = 1.f;
 
+  protected:
+	void editProperty(const NodeProperty &prop) override;
+
   private:
 	uint32_t _sourceID = 0;
 	uint32_t _lastBuffer = 0;
+	ResHandle<AudioStream> _streamHandle;
+	// Set while the source plays a streamed asset
+	std::unique_ptr<AudioStreamPlayback> _playback;
 
+	AudioStream *stream();
 	void updateSource();
+
+	static const NodeProperty s_Properties[];
 };
 
 #endif // AUDIOSTREAMPLAYER_HPP
\ No newline at end of file
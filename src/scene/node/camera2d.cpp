@@ -1,56 +1,19 @@
 #include "camera2d.hpp"
 
-#include "imgui.h"
-
 #include "core/application.hpp"
 #include "math/matrix.hpp"
 
-bool Camera2D::Serialize(Document &doc) {
-	if (!Node2D::Serialize(doc))
-		return false;
-
-	return true;
-}
-
-bool Camera2D::Deserialize(const Document &doc) {
-	if (!Node2D::Deserialize(doc))
-		return false;
-
-	return true;
-}
-
-bool Camera2D::Copy(Node *dst) {
-	if (!Node2D::Copy(dst)) {
-		return false;
-	}
-
-	Camera2D *dstNode = dynamic_cast<Camera2D *>(dst);
-	dstNode->Rotatable() = Rotatable();
-
-	return true;
-}
-
-void Camera2D::UpdateEditor() {
-	if (ImGui::CollapsingHeader("Camera2D", ImGuiTreeNodeFlags_DefaultOpen)) {
-		ImGui::Indent();
-
-		ImGui::Text("%s", "Offset");
-		ImGui::SameLine();
-		ImGui::DragFloat2("##Offset", &_offset.x);
-
-		ImGui::Text("%s", "Rotatable");
-		ImGui::SameLine();
-		ImGui::Checkbox("##Rotatable", &_rotatable);
-
-		ImGui::Unindent();
-	}
-
-	Node2D::UpdateEditor();
-}
+SW_OFFSETOF_BEGIN
+const NodeProperty Camera2D::s_Properties[] = {
+	SW_PROPERTY(Camera2D, _offset, "Offset", "offset"),
+	SW_PROPERTY(Camera2D, _rotatable, "Rotatable", "rotatable"),
+};
+SW_OFFSETOF_END
+const NodePropertyTable Camera2D::Properties = Camera2D::s_Properties;
 
 glm::mat4 Camera2D::GetMatrix() {
 	glm::mat4 transform;
-	if (!Rotatable()) {
+	if (!_rotatable) {
 		Vector2 position;
 		Vector2 scale;
 		Matrix::DecomposeTransform(GetTransform(), &position, nullptr, &scale);
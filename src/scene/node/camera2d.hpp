@@ -13,11 +13,7 @@ class Camera2D : public Node2D {
   public:
 	virtual ~Camera2D() = default;
 
-	bool Serialize(Document &doc) override;
-	bool Deserialize(const Document &doc) override;
-
-	bool Copy(Node *dst) override;
-	void UpdateEditor() override;
+	static const NodePropertyTable Properties;
 
 	glm::mat4 GetMatrix();
 	static glm::mat4 GetBlankMatrix();
@@ -26,11 +22,17 @@ class Camera2D : public Node2D {
 
 	void MakeCurrent();
 
-	inline bool &Rotatable() { return _rotatable; }
+	inline bool &Rotatable() {
+		MarkDirty();
+		return _rotatable;
+	}
 
   public:
 	bool _rotatable = false;
 	Vector2 _offset = Vector2(0.f);
+
+  private:
+	static const NodeProperty s_Properties[];
 };
 
 #endif // CAMERA2D_HPP
\ No newline at end of file
@@ -1,80 +1,18 @@
 #include "node2d.hpp"
 
 #include "math/matrix.hpp"
-
-#include "imgui.h"
-
-bool Node2D::Serialize(Document &doc) {
-	if (!Node::Serialize(doc))
-		return false;
-
-	doc.SetVec2("Position", Position());
-	doc.SetFloat("Rotation", Rotation());
-	doc.SetVec2("Scale", Scale());
-	doc.Set("ZIndex", ZIndex());
-	doc.Set("Visible", _visible);
-
-	return true;
-}
-
-bool Node2D::Deserialize(const Document &doc) {
-	if (!Node::Deserialize(doc))
-		return false;
-
-	Position() = doc.GetVec2("Position", Position());
-	Rotation() = doc.GetFloat("Rotation", Rotation());
-	Scale() = doc.GetVec2("Scale", Scale());
-	ZIndex() = doc.Get("ZIndex", ZIndex());
-	_visible = doc.Get("Visible", _visible);
-
-	return true;
-}
-
-bool Node2D::Copy(Node *dst) {
-	if (!Node::Copy(dst)) {
-		return false;
-	}
-
-	Node2D *dstNode = dynamic_cast<Node2D *>(dst);
-	dstNode->Position() = Position();
-	dstNode->Rotation() = Rotation();
-	dstNode->Scale() = Scale();
-	dstNode->ZIndex() = ZIndex();
-	dstNode->_visible = _visible;
-
-	return true;
-}
-
-void Node2D::UpdateEditor() {
-	if (ImGui::CollapsingHeader("Node2D", ImGuiTreeNodeFlags_DefaultOpen)) {
-		ImGui::Indent();
-
-		ImGui::Text("%s", "Position");
-		ImGui::SameLine();
-		ImGui::DragFloat2("##Position", &_position.x, 1.f);
-
-		ImGui::Text("%s", "Rotation");
-		ImGui::SameLine();
-		float rad = glm::radians(_rotation);
-		ImGui::SliderAngle("##Rotation", &rad);
-		_rotation = glm::degrees(rad);
-
-		ImGui::Text("%s", "Scale");
-		ImGui::SameLine();
-		ImGui::DragFloat2("##Scale", &_scale.x, 0.005f);
-
-		ImGui::Text("%s", "Z Index");
-		ImGui::SameLine();
-		ImGui::InputInt("##ZIndex", &_zIndex);
-
-		ImGui::Text("%s", "Visible");
-		ImGui::SameLine();
-		ImGui::Checkbox("##Visible", &_visible);
-
-		ImGui::Unindent();
-	}
-	Node::UpdateEditor();
-}
+#include "scene/scene.hpp"
+
+SW_OFFSETOF_BEGIN
+const NodeProperty Node2D::s_Properties[] = {
+	SW_PROPERTY(Node2D, _position, "Position", "position"),
+	SW_PROPERTY(Node2D, _rotation, "Rotation", "rotation").Hint(PropertyHint::Angle),
+	SW_PROPERTY(Node2D, _scale, "Scale", "scale").Speed(0.005f),
+	SW_PROPERTY(Node2D, _zIndex, "ZIndex", "z_index"),
+	SW_PROPERTY(Node2D, _visible, "Visible", "visible"),
+};
+SW_OFFSETOF_END
+const NodePropertyTable Node2D::Properties = Node2D::s_Properties;
 
 glm::mat4 Node2D::GetTransform(const Vector2 &offset) {
 	return Matrix::CalculateTransform(_position, _rotation, _scale, offset, GetParentTransform());
@@ -85,7 +23,7 @@ glm::mat4 Node2D::GetLocalTransform(const Vector2 &offset) {
 }
 
 glm::mat4 Node2D::GetParentTransform() {
-	if (Node2D *parent = dynamic_cast<Node2D *>(GetParent()); nullptr != parent) {
+	if (Node2D *parent = node_cast<Node2D>(GetParent()); nullptr != parent) {
 		return parent->GetTransform();
 	}
 
@@ -93,7 +31,7 @@ glm::mat4 Node2D::GetParentTransform() {
 }
 
 int Node2D::GetZIndex() {
-	if (Node2D *parent = dynamic_cast<Node2D *>(GetParent()); nullptr != parent) {
+	if (Node2D *parent = node_cast<Node2D>(GetParent()); nullptr != parent) {
 		return _zIndex + parent->GetZIndex();
 	}
 
@@ -101,7 +39,7 @@ int Node2D::GetZIndex() {
 }
 
 bool Node2D::IsVisible() {
-	if (Node2D *parent = dynamic_cast<Node2D *>(GetParent()); nullptr != parent) {
+	if (Node2D *parent = node_cast<Node2D>(GetParent()); nullptr != parent) {
 		if (!parent->_visible) {
 			return false;
 		}
@@ -116,4 +54,28 @@ Vector2 Node2D::GetGlobalPosition() {
 	Vector2 pos;
 	Matrix::DecomposeTransform(GetTransform(), &pos, nullptr, nullptr);
 	return pos;
+}
+
+void Node2D::updateBounds(const glm::mat4 &transform, const Rect &local) {
+	// Most nodes do not move in a frame, comparing is cheaper than the lookup and corner transforms of an update
+	bool moved = transform != _indexedTransform || local.x != _indexedLocal.x || local.y != _indexedLocal.y || local.w != _indexedLocal.w || local.h != _indexedLocal.h;
+	if (_indexed && !moved)
+		return;
+
+	if (Scene *scene = GetScene(); nullptr != scene) {
+		scene->GetSpatialIndex().Update(ID(), SpatialIndex::TransformBounds(transform, local));
+		_indexedTransform = transform;
+		_indexedLocal = local;
+		_indexed = true;
+	}
+}
+
+void Node2D::removeBounds() {
+	if (!_indexed)
+		return;
+
+	if (Scene *scene = GetScene(); nullptr != scene) {
+		scene->GetSpatialIndex().Remove(ID());
+	}
+	_indexed = false;
 }
\ No newline at end of file
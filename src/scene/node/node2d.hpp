@@ -4,6 +4,7 @@
 
 #include "glm/glm.hpp"
 
+#include "math/rect.hpp"
 #include "math/vector2.hpp"
 #include "scene/node.hpp"
 
@@ -11,11 +12,7 @@ class Node2D : public Node {
   public:
 	virtual ~Node2D() = default;
 
-	bool Serialize(Document &doc) override;
-	bool Deserialize(const Document &doc) override;
-
-	bool Copy(Node *dst) override;
-	void UpdateEditor() override;
+	static const NodePropertyTable Properties;
 
 	glm::mat4 GetTransform(const Vector2 &offset = Vector2(0.f, 0.f));
 	glm::mat4 GetLocalTransform(const Vector2 &offset = Vector2(0.f, 0.f));
@@ -25,10 +22,29 @@ class Node2D : public Node {
 
 	Vector2 GetGlobalPosition();
 
-	inline Vector2 &Position() { return _position; }
-	inline float &Rotation() { return _rotation; }
-	inline Vector2 &Scale() { return _scale; }
-	inline int &ZIndex() { return _zIndex; }
+	// Mutable accessors are for writing, they mark the node dirty. Read the fields to avoid it
+	inline Vector2 &Position() {
+		MarkDirty();
+		return _position;
+	}
+	inline float &Rotation() {
+		MarkDirty();
+		return _rotation;
+	}
+	inline Vector2 &Scale() {
+		MarkDirty();
+		return _scale;
+	}
+	inline int &ZIndex() {
+		MarkDirty();
+		return _zIndex;
+	}
+
+  protected:
+	// Keeps the owning scene's spatial index in sync with what was drawn this frame. The entry is only touched when the
+	// transform or the local rect changed since the last call
+	void updateBounds(const glm::mat4 &transform, const Rect &local);
+	void removeBounds();
 
   public:
 	Vector2 _position{0.f, 0.f};
@@ -36,6 +52,14 @@ class Node2D : public Node {
 	Vector2 _scale{1.f, 1.f};
 	int _zIndex = 0;
 	bool _visible = true;
+
+  private:
+	static const NodeProperty s_Properties[];
+
+	// What the spatial index entry was built from
+	glm::mat4 _indexedTransform{1.f};
+	Rect _indexedLocal;
+	bool _indexed = false;
 };
 
 #endif // NODE2D_HPP
\ No newline at end of file
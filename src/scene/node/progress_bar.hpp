@@ -12,11 +12,8 @@ class ProgressBar : public Node2D {
 	virtual ~ProgressBar() = default;
 
 	void Update() override;
-	bool Serialize(Document &doc) override;
-	bool Deserialize(const Document &doc) override;
 
-	bool Copy(Node *dst) override;
-	void UpdateEditor() override;
+	static const NodePropertyTable Properties;
 
   public:
 	float _minValue = 0.f;
@@ -28,6 +25,9 @@ class ProgressBar : public Node2D {
 
 	Color _foregroundColor = Color(1.f, 1.f, 1.f, 1.f);
 	Color _backgroundColor = Color(0.f, 0.f, 0.f, 1.f);
+
+  private:
+	static const NodeProperty s_Properties[];
 };
 
 #endif // PROGRESS_BAR_HPP
\ No newline at end of file
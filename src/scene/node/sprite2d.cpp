@@ -1,70 +1,42 @@
 #include "sprite2d.hpp"
 
-#include "imgui.h"
-
 #include "core/application.hpp"
 #include "core/debug.hpp"
-#include "editor/gui.hpp"
 #include "math/matrix.hpp"
 #include "resource/image_texture.hpp"
 #include "visual/renderer.hpp"
 
-bool Sprite2D::Serialize(Document &doc) {
-	if (!Node2D::Serialize(doc))
-		return false;
-
-	doc.SetInt("Texture", GetTexture());
-	doc.SetColor("Modulate", Modulate());
-
-	return true;
-}
-
-bool Sprite2D::Deserialize(const Document &doc) {
-	if (!Node2D::Deserialize(doc))
-		return false;
-
-	GetTexture() = doc.GetInt("Texture", GetTexture());
-	Modulate() = doc.GetColor("Modulate", Modulate());
-
-	return true;
-}
-
-bool Sprite2D::Copy(Node *dst) {
-	if (!Node2D::Copy(dst)) {
-		return false;
-	}
-
-	Sprite2D *dstNode = dynamic_cast<Sprite2D *>(dst);
-	dstNode->GetTexture() = GetTexture();
-	dstNode->Modulate() = Modulate();
-
-	return true;
-}
-
-void Sprite2D::UpdateEditor() {
-	if (ImGui::CollapsingHeader("Sprite2D", ImGuiTreeNodeFlags_DefaultOpen)) {
-		ImGui::Indent();
-
-		ImGui::Text("%s", "Texture");
-		ImGui::SameLine();
-		Gui::TexturePicker("##Texture", _texture);
-
-		ImGui::Text("%s", "Modulate");
-		ImGui::SameLine();
-		ImGui::ColorEdit4("##Modulate", &_modulate.r);
-
-		ImGui::Unindent();
-	}
-	Node2D::UpdateEditor();
-}
+SW_OFFSETOF_BEGIN
+const NodeProperty Sprite2D::s_Properties[] = {
+	SW_PROPERTY(Sprite2D, _texture, "Texture", "texture").Hint(PropertyHint::Texture),
+	SW_PROPERTY(Sprite2D, _modulate, "Modulate", "modulate"),
+};
+SW_OFFSETOF_END
+const NodePropertyTable Sprite2D::Properties = Sprite2D::s_Properties;
 
 void Sprite2D::Update() {
-	if (!IsVisible())
+	if (!IsVisible()) {
+		removeBounds();
 		return;
+	}
 
-	ImageTexture *res = dynamic_cast<ImageTexture *>(App().GetResourceRegistry().GetResource(_texture));
-	if (!res)
+	ImageTexture *res = App().GetResourceRegistry().Resolve(_textureHandle, _texture);
+	if (!res) {
+		removeBounds();
 		return;
+	}
 
-	App().GetRenderer().GetRenderer2D("2D").PushQuad(GetTransform(), res->ID(), glm::vec2(res->Width(), res->Height()), GetZIndex(), Modulate(), ID());
+	glm::mat4 transform = GetTransform();
+	glm::vec2 size(res->Width(), res->Height());
+	updateBounds(transform, Rect(-size.x * 0.5f, -size.y * 0.5f, size.x, size.y));
+
+	App().GetRenderer().GetRenderer2D("2D").PushQuad(PushQuadArgs{
+		.transform = transform,
+		.textureID = static_cast<float>(res->ID()),
+		.z = static_cast<float>(GetZIndex()),
+		.drawID = static_cast<float>(ID()),
+		.color = _modulate,
+		.textureScale = size,
+		.uvTopLeft = res->MapUV(glm::vec2(0.f, 1.f)),
+		.uvBottomRight = res->MapUV(glm::vec2(1.f, 0.f))});
 }
\ No newline at end of file
@@ -6,24 +6,35 @@
 
 #include "data/color.hpp"
 #include "node2d.hpp"
+#include "resource/resource_registry.hpp"
+
+class ImageTexture;
 
 class Sprite2D : public Node2D {
   public:
 	virtual ~Sprite2D() = default;
 
 	void Update() override;
-	bool Serialize(Document &doc) override;
-	bool Deserialize(const Document &doc) override;
 
-	bool Copy(Node *dst) override;
-	void UpdateEditor() override;
+	static const NodePropertyTable Properties;
 
-	inline RID &GetTexture() { return _texture; }
-	inline Color &Modulate() { return _modulate; }
+	inline RID &GetTexture() {
+		MarkDirty();
+		return _texture;
+	}
+	inline Color &Modulate() {
+		MarkDirty();
+		return _modulate;
+	}
 
   public:
 	RID _texture;
 	Color _modulate;
+
+  private:
+	ResHandle<ImageTexture> _textureHandle;
+
+	static const NodeProperty s_Properties[];
 };
 
 #endif // SPRITE2D_HPP
\ No newline at end of file
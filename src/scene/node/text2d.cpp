@@ -1,78 +1,34 @@
 #include "text2d.hpp"
 
-#include "imgui.h"
-#include "misc/cpp/imgui_stdlib.h"
-
 #include "core/application.hpp"
 #include "math/matrix.hpp"
 #include "resource/font.hpp"
 #include "visual/renderer.hpp"
 
+SW_OFFSETOF_BEGIN
+const NodeProperty Text2D::s_Properties[] = {
+	SW_PROPERTY(Text2D, _text, "Text", "text"),
+	SW_PROPERTY(Text2D, _font, "Font", "font"),
+	SW_PROPERTY(Text2D, _modulate, "Modulate", "modulate"),
+};
+SW_OFFSETOF_END
+const NodePropertyTable Text2D::Properties = Text2D::s_Properties;
+
 void Text2D::Update() {
-	if (!IsVisible())
+	if (!IsVisible()) {
+		removeBounds();
 		return;
+	}
 
-	Font *res = dynamic_cast<Font *>(App().GetResourceRegistry().GetResource(_font));
+	Font *res = App().GetResourceRegistry().Resolve(_fontHandle, _font);
 	if (!res) {
 		res = App().GetDefaultFont();
 	}
 
-	App().GetRenderer().GetRenderer2D("Text").DrawText(_text, *res, GetTransform(), GetZIndex(), Modulate());
-}
-
-bool Text2D::Serialize(Document &doc) {
-	if (!Node2D::Serialize(doc))
-		return false;
-
-	doc.SetString("Text", Text());
-	doc.SetInt("Font", GetFont());
-	doc.SetColor("Modulate", Modulate());
-
-	return true;
-}
-
-bool Text2D::Deserialize(const Document &doc) {
-	if (!Node2D::Deserialize(doc))
-		return false;
-
-	Text() = doc.GetString("Text", Text());
-	GetFont() = doc.GetInt("Font", GetFont());
-	Modulate() = doc.GetColor("Modulate", Modulate());
-
-	return true;
-}
-
-bool Text2D::Copy(Node *dst) {
-	if (!Node2D::Copy(dst)) {
-		return false;
-	}
-
-	Text2D *dstNode = dynamic_cast<Text2D *>(dst);
-	dstNode->Text() = Text();
-	dstNode->GetFont() = GetFont();
-	dstNode->Modulate() = Modulate();
-
-	return true;
-}
-
-void Text2D::UpdateEditor() {
-	if (ImGui::CollapsingHeader("Text2D", ImGuiTreeNodeFlags_DefaultOpen)) {
-		ImGui::Indent();
-
-		ImGui::Text("%s", "Text");
-		ImGui::SameLine();
-		ImGui::InputText("##Text", &_text);
-
-		ImGui::Text("%s", "Modulate");
-		ImGui::SameLine();
-		ImGui::ColorEdit4("##Modulate", &_modulate.r);
-
-		ImGui::Text("%s", "Font");
-		ImGui::SameLine();
-		ImGui::InputInt("##Font", &_font);
-
-		ImGui::Unindent();
-	}
+	// Text starts at the origin on its baseline, descenders are approximated
+	glm::mat4 transform = GetTransform();
+	glm::vec2 size = res->CalcTextSize(_text);
+	updateBounds(transform, Rect(0.f, -size.y * 0.25f, size.x, size.y * 1.25f));
 
-	Node2D::UpdateEditor();
+	App().GetRenderer().GetRenderer2D("Text").DrawText(_text, *res, transform, GetZIndex(), _modulate);
 }
\ No newline at end of file
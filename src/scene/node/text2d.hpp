@@ -9,26 +9,40 @@
 #include "node2d.hpp"
 
 #include "data/color.hpp"
+#include "resource/resource_registry.hpp"
+
+class Font;
 
 class Text2D : public Node2D {
   public:
 	virtual ~Text2D() = default;
 
 	void Update() override;
-	bool Serialize(Document &doc) override;
-	bool Deserialize(const Document &doc) override;
-
-	bool Copy(Node *dst) override;
-	void UpdateEditor() override;
 
-	inline RID &GetFont() { return _font; }
-	inline std::string &Text() { return _text; }
-	inline Color &Modulate() { return _modulate; }
+	static const NodePropertyTable Properties;
+
+	inline RID &GetFont() {
+		MarkDirty();
+		return _font;
+	}
+	inline std::string &Text() {
+		MarkDirty();
+		return _text;
+	}
+	inline Color &Modulate() {
+		MarkDirty();
+		return _modulate;
+	}
 
   public:
 	RID _font;
 	std::string _text;
 	Color _modulate;
+
+  private:
+	ResHandle<Font> _fontHandle;
+
+	static const NodeProperty s_Properties[];
 };
 
 #endif // TEXT2D_HPP
\ No newline at end of file
@@ -1,21 +1,62 @@
 #include "node_db.hpp"
 
+#include <algorithm>
+
+// Lookups only use find, scenes loading in the background create nodes while the main thread runs
 Node *NodeDB::Create(NodeTypeID type) {
-	Node *node = _allocators[type].Create();
+	auto allocator = _allocators.find(type);
+	if (allocator == _allocators.end())
+		return nullptr;
+
+	Node *node = allocator->second.Create();
 	if (!node)
 		return nullptr;
 	node->_typeid = type;
+	if (auto it = _types.find(type); it != _types.end())
+		node->_type = &it->second;
 	return node;
 }
 
+bool NodeDB::Create(NodeTypeID type, size_t count, Node **out) {
+	auto allocator = _allocators.find(type);
+	if (allocator == _allocators.end() || !allocator->second.Create(count, out))
+		return false;
+
+	const NodeType *nodeType = nullptr;
+	if (auto it = _types.find(type); it != _types.end())
+		nodeType = &it->second;
+
+	for (size_t i = 0; i < count; i++) {
+		out[i]->_typeid = type;
+		out[i]->_type = nodeType;
+	}
+	return true;
+}
+
 void NodeDB::Destroy(Node *node) {
 	if (!node)
 		return;
 	_allocators[node->TypeID()].Destroy(node);
 }
 
+void NodeDB::Destroy(const std::vector<Node *> &nodes) {
+	NodeTypeID type = 0;
+	NodeAllocator *allocator = nullptr;
+	for (Node *node : nodes) {
+		if (!node)
+			continue;
+
+		if (!allocator || node->TypeID() != type) {
+			type = node->TypeID();
+			allocator = &_allocators[type];
+		}
+		allocator->Destroy(node);
+	}
+}
+
 NodeTypeID NodeDB::GetNodeTypeID(const std::string &typeName) {
-	return _typeids[typeName];
+	auto it = _typeids.find(typeName);
+	return it != _typeids.end() ? it->second : 0;
 }
 
 const char *NodeDB::GetNodeTypename(NodeTypeID typeId) {
@@ -28,4 +69,25 @@ const NodeType &NodeDB::GetNodeType(NodeTypeID typeId) {
 
 const std::unordered_map<NodeTypeID, NodeType> &NodeDB::GetNodeTypes() {
 	return _types;
+}
+
+void NodeDB::registerProperties(NodeType &type, NodeTypeID id, const NodeType *base) {
+	if (base)
+		type.properties = base->properties;
+
+	if (!base || base->propertyTable.data != type.propertyTable.data) {
+		for (const NodeProperty &prop : type.propertyTable) {
+			type.properties.push_back(prop);
+			type.properties.back().owner = id;
+		}
+	}
+
+	for (u32 i = 0; i < type.properties.size(); i++) {
+		type.propertyIndex[type.properties[i].name] = i;
+	}
+
+	for (u32 i = 0; i < type.properties.size(); i++) {
+		if (type.properties[i].Has(PropertyFlags_Copy))
+			type.copyProperties.push_back(i);
+	}
 }
\ No newline at end of file
@@ -3,7 +3,11 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <type_traits>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 extern "C" {
 #include <lauxlib.h>
@@ -14,6 +18,7 @@ extern "C" {
 
 #include "allocator.hpp"
 #include "node.hpp"
+#include "node_property.hpp"
 #include "sowa.hpp"
 
 #include "data/id_generator.hpp"
@@ -22,8 +27,38 @@ struct NodeType {
 	std::string name = "";
 	NodeTypeID extends = 0;
 	const void *scriptKey = nullptr;
+
+	// Bit n is set if type n is this type or one of its ancestors
+	std::vector<u64> ancestors;
+
+	// Inherited properties first, then the type's own in table order
+	std::vector<NodeProperty> properties;
+	std::unordered_map<std::string_view, u32> propertyIndex;
+	// The table T::Properties named at registration, a type without its own table names its base's
+	NodePropertyTable propertyTable;
+
+	// Node::Copy plan, indices of the properties flagged PropertyFlags_Copy
+	std::vector<u32> copyProperties;
+	// Set if the type or a base overrides Node::Copy, otherwise the plan alone copies a node of the type
+	bool customCopy = false;
+
+	inline bool IsA(NodeTypeID type) const {
+		return type / 64 < ancestors.size() && ((ancestors[type / 64] >> (type % 64)) & 1) != 0;
+	}
+
+	inline const NodeProperty *FindProperty(std::string_view name) const {
+		auto it = propertyIndex.find(name);
+		return it != propertyIndex.end() ? &properties[it->second] : nullptr;
+	}
 };
 
+// Type id the node class was registered with, 0 if it is not registered
+template <typename T>
+inline NodeTypeID &NodeTypeIDOf() {
+	static NodeTypeID id = 0;
+	return id;
+}
+
 class NodeDB {
   public:
 	template <typename T>
@@ -31,24 +66,44 @@ class NodeDB {
 		NodeTypeID id = _nodeTypeIdGen.Next();
 		_allocators[id] = NodeAllocator::Get<T>();
 
-		_types[id] = NodeType{
-			.name = name,
-			.extends = extends,
-			.scriptKey = luabridge::detail::getClassRegistryKey<T>(),
-		};
+		NodeType type;
+		type.name = name;
+		type.extends = extends;
+		type.scriptKey = luabridge::detail::getClassRegistryKey<T>();
+		const NodeType *baseType = nullptr;
+		if (auto base = _types.find(extends); base != _types.end()) {
+			baseType = &base->second;
+			type.ancestors = base->second.ancestors;
+		}
+		type.ancestors.resize(id / 64 + 1, 0);
+		type.ancestors[id / 64] |= u64(1) << (id % 64);
+
+		type.propertyTable = T::Properties;
+		registerProperties(type, id, baseType);
+		// &T::Copy is a member of the class that last declared Copy
+		type.customCopy = !std::is_same_v<decltype(&T::Copy), bool (Node::*)(Node *)>;
+
+		_types[id] = std::move(type);
 		_typeids[name] = id;
+		NodeTypeIDOf<T>() = id;
 
 		return id;
 	}
 
 	Node *Create(NodeTypeID type);
+	// Creates count nodes of the same type from one pool allocation
+	bool Create(NodeTypeID type, size_t count, Node **out);
 	void Destroy(Node *node);
+	void Destroy(const std::vector<Node *> &nodes);
 
 	NodeTypeID GetNodeTypeID(const std::string &typeName);
 	const char *GetNodeTypename(NodeTypeID typeId);
 	const NodeType &GetNodeType(NodeTypeID typeId);
 	const std::unordered_map<NodeTypeID, NodeType> &GetNodeTypes();
 
+  private:
+	void registerProperties(NodeType &type, NodeTypeID id, const NodeType *base);
+
   private:
 	std::unordered_map<NodeTypeID, NodeAllocator> _allocators;
 
@@ -58,4 +113,18 @@ class NodeDB {
 	LinearIDGenerator<NodeTypeID> _nodeTypeIdGen;
 };
 
+// Checked downcast through the registered type hierarchy, without RTTI
+template <typename T>
+inline T *node_cast(Node *node) {
+	if (nullptr == node || nullptr == node->Type())
+		return nullptr;
+
+	return node->Type()->IsA(NodeTypeIDOf<T>()) ? static_cast<T *>(node) : nullptr;
+}
+
+template <typename T>
+inline const T *node_cast(const Node *node) {
+	return node_cast<T>(const_cast<Node *>(node));
+}
+
 #endif // NODE_DB_HPP
\ No newline at end of file
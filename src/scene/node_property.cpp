@@ -0,0 +1,105 @@
+#include "node_property.hpp"
+
+#include "core/serialize/document.hpp"
+#include "scene/node.hpp"
+#include "scene/node_db.hpp"
+
+namespace NodeProperties {
+
+void Write(Document &doc, const NodeProperty &prop, const Node *node) {
+	switch (prop.type) {
+	case PropertyType::Bool:
+		doc.SetBool(prop.name, prop.Ref<bool>(node));
+		break;
+	case PropertyType::Int:
+		doc.SetInt(prop.name, prop.Ref<i32>(node));
+		break;
+	case PropertyType::U64:
+		doc.SetU64(prop.name, prop.Ref<u64>(node));
+		break;
+	case PropertyType::Float:
+		doc.SetFloat(prop.name, prop.Ref<f32>(node));
+		break;
+	case PropertyType::String:
+		doc.SetString(prop.name, prop.Ref<std::string>(node));
+		break;
+	case PropertyType::Vec2:
+		doc.SetVec2(prop.name, prop.Ref<Vector2>(node));
+		break;
+	case PropertyType::Color:
+		doc.SetColor(prop.name, prop.Ref<Color>(node));
+		break;
+	case PropertyType::StringList:
+		doc.SetStringList(prop.name, prop.Ref<std::vector<std::string>>(node));
+		break;
+	}
+}
+
+void Read(const DocumentValue &value, const NodeProperty &prop, Node *node) {
+	switch (prop.type) {
+	case PropertyType::Bool:
+		value.GetBool(prop.Ref<bool>(node));
+		break;
+	case PropertyType::Int: {
+		i64 number = 0;
+		if (value.GetInt(number))
+			prop.Ref<i32>(node) = static_cast<i32>(number);
+		break;
+	}
+	case PropertyType::U64:
+		value.GetU64(prop.Ref<u64>(node));
+		break;
+	case PropertyType::Float:
+		value.GetFloat(prop.Ref<f32>(node));
+		break;
+	case PropertyType::String:
+		value.GetString(prop.Ref<std::string>(node));
+		break;
+	case PropertyType::Vec2:
+		value.GetVec2(prop.Ref<Vector2>(node));
+		break;
+	case PropertyType::Color:
+		value.GetColor(prop.Ref<Color>(node));
+		break;
+	case PropertyType::StringList:
+		value.GetStringList(prop.Ref<std::vector<std::string>>(node));
+		break;
+	}
+}
+
+// Assigns through the member's own type, so properties that stop being trivially copyable stay correct
+template <typename T>
+static void CopyValue(const NodeProperty &prop, const Node *src, Node *dst) {
+	prop.Ref<T>(dst) = prop.Ref<T>(src);
+}
+
+void Copy(const NodeProperty &prop, const Node *src, Node *dst) {
+	switch (prop.type) {
+	case PropertyType::Bool:
+		CopyValue<bool>(prop, src, dst);
+		break;
+	case PropertyType::Int:
+		CopyValue<i32>(prop, src, dst);
+		break;
+	case PropertyType::U64:
+		CopyValue<u64>(prop, src, dst);
+		break;
+	case PropertyType::Float:
+		CopyValue<f32>(prop, src, dst);
+		break;
+	case PropertyType::String:
+		CopyValue<std::string>(prop, src, dst);
+		break;
+	case PropertyType::Vec2:
+		CopyValue<Vector2>(prop, src, dst);
+		break;
+	case PropertyType::Color:
+		CopyValue<Color>(prop, src, dst);
+		break;
+	case PropertyType::StringList:
+		CopyValue<std::vector<std::string>>(prop, src, dst);
+		break;
+	}
+}
+
+} // namespace NodeProperties
\ No newline at end of file
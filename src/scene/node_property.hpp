@@ -0,0 +1,162 @@
+#ifndef NODE_PROPERTY_HPP
+#define NODE_PROPERTY_HPP
+#pragma once
+
+#include <cstddef>
+#include <limits>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "yaml-cpp/yaml.h"
+
+#include "sowa.hpp"
+
+#include "data/color.hpp"
+#include "math/vector2.hpp"
+
+class Node;
+class Document;
+class DocumentValue;
+
+enum class PropertyType : u8 {
+	Bool = 0,
+	Int,
+	U64,
+	Float,
+	String,
+	Vec2,
+	Color,
+	StringList,
+};
+
+enum PropertyFlags : u32 {
+	PropertyFlags_None = 0,
+	PropertyFlags_Serialize = 1 << 0,
+	PropertyFlags_Copy = 1 << 1,
+	PropertyFlags_Editor = 1 << 2,
+	PropertyFlags_Script = 1 << 3,
+	PropertyFlags_Default = PropertyFlags_Serialize | PropertyFlags_Copy | PropertyFlags_Editor | PropertyFlags_Script,
+};
+
+// Picks the inspector widget, None uses the default one for the property type
+enum class PropertyHint : u8 {
+	None = 0,
+	Angle,
+	Slider,
+	Texture,
+	Animation,
+	// Drawn by Node::editProperty
+	Custom,
+};
+
+template <typename T>
+constexpr PropertyType PropertyTypeOf() {
+	if constexpr (std::is_same_v<T, bool>)
+		return PropertyType::Bool;
+	else if constexpr (std::is_same_v<T, i32>)
+		return PropertyType::Int;
+	else if constexpr (std::is_same_v<T, u64>)
+		return PropertyType::U64;
+	else if constexpr (std::is_same_v<T, f32>)
+		return PropertyType::Float;
+	else if constexpr (std::is_same_v<T, std::string>)
+		return PropertyType::String;
+	else if constexpr (std::is_same_v<T, Vector2>)
+		return PropertyType::Vec2;
+	else if constexpr (std::is_same_v<T, Color>)
+		return PropertyType::Color;
+	else if constexpr (std::is_same_v<T, std::vector<std::string>>)
+		return PropertyType::StringList;
+	else
+		static_assert(!std::is_same_v<T, T>, "unsupported node property type");
+}
+
+// Describes one field of a node type. Offsets are from the start of the node, node types use single inheritance so
+// every base shares the node's address
+struct NodeProperty {
+	const char *name = "";
+	const char *scriptName = "";
+	PropertyType type = PropertyType::Bool;
+	u32 offset = 0;
+	u32 flags = PropertyFlags_Default;
+
+	PropertyHint hint = PropertyHint::None;
+	f32 speed = 1.f;
+	f32 min = 0.f;
+	f32 max = 0.f;
+
+	// Type that declared the property, set by NodeDB
+	NodeTypeID owner = 0;
+
+	constexpr NodeProperty(const char *name, const char *scriptName, PropertyType type, size_t offset)
+		: name(name), scriptName(scriptName), type(type), offset(static_cast<u32>(offset)) {}
+
+	constexpr NodeProperty Flags(u32 value) const {
+		NodeProperty prop = *this;
+		prop.flags = value;
+		return prop;
+	}
+	constexpr NodeProperty Hint(PropertyHint value) const {
+		NodeProperty prop = *this;
+		prop.hint = value;
+		return prop;
+	}
+	constexpr NodeProperty Speed(f32 value) const {
+		NodeProperty prop = *this;
+		prop.speed = value;
+		return prop;
+	}
+	// Clamps inspector input, Slider hints use it as the slider range
+	constexpr NodeProperty Range(f32 minValue, f32 maxValue) const {
+		NodeProperty prop = *this;
+		prop.min = minValue;
+		prop.max = maxValue;
+		return prop;
+	}
+	constexpr NodeProperty Min(f32 minValue) const {
+		return Range(minValue, std::numeric_limits<f32>::max());
+	}
+
+	inline bool Has(u32 flag) const { return (flags & flag) == flag; }
+
+	template <typename T>
+	inline T &Ref(Node *node) const { return *reinterpret_cast<T *>(reinterpret_cast<std::byte *>(node) + offset); }
+	template <typename T>
+	inline const T &Ref(const Node *node) const { return *reinterpret_cast<const T *>(reinterpret_cast<const std::byte *>(node) + offset); }
+};
+
+// Declares a property of Class::member, its type is taken from the member. Must be used where member is accessible
+#define SW_PROPERTY(Class, member, name, scriptName) NodeProperty(name, scriptName, PropertyTypeOf<decltype(Class::member)>(), offsetof(Class, member))
+
+// Node classes are polymorphic, so offsetof on them is only conditionally supported. Every compiler we build with
+// supports it, property tables and code comparing offsets go between these to silence the warning for them alone
+#if defined(__GNUC__)
+#define SW_OFFSETOF_BEGIN _Pragma("GCC diagnostic push") _Pragma("GCC diagnostic ignored \"-Winvalid-offsetof\"")
+#define SW_OFFSETOF_END _Pragma("GCC diagnostic pop")
+#else
+#define SW_OFFSETOF_BEGIN
+#define SW_OFFSETOF_END
+#endif
+
+// View over a node type's own property table
+struct NodePropertyTable {
+	const NodeProperty *data = nullptr;
+	size_t size = 0;
+
+	constexpr NodePropertyTable() = default;
+	template <size_t N>
+	constexpr NodePropertyTable(const NodeProperty (&table)[N]) : data(table), size(N) {}
+
+	inline const NodeProperty *begin() const { return data; }
+	inline const NodeProperty *end() const { return data + size; }
+};
+
+namespace NodeProperties {
+void Write(Document &doc, const NodeProperty &prop, const Node *node);
+// Reads a value visited by Document::ForEachValue into the property, a value of another type keeps the current one
+void Read(const DocumentValue &value, const NodeProperty &prop, Node *node);
+void Copy(const NodeProperty &prop, const Node *src, Node *dst);
+} // namespace NodeProperties
+
+#endif // NODE_PROPERTY_HPP
\ No newline at end of file
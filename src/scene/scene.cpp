@@ -1,15 +1,45 @@
 #include "scene.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <cstring>
 #include <fstream>
+#include <unordered_set>
 
 #include "core/debug.hpp"
+#include "core/serialize/binary_scene.hpp"
+#include "core/serialize/yaml_node_builder.hpp"
 #include "yaml-cpp/yaml.h"
 
 #include "core/application.hpp"
+#include "resource/image_texture.hpp"
+#include "resource/prefab.hpp"
 #include "resource/sprite_sheet_animation.hpp"
+#include "resource/texture_atlas.hpp"
 #include "scene/node/camera2d.hpp"
+#include "scene/node_property.hpp"
+
+struct Scene::AsyncLoad {
+	// The file is read through FileSystem::LoadAsync, then parsed on the pool. read is valid once parsing started
+	IOHandle file;
+	std::future<void> read;
+	bool readDone = false;
+	// Written by the reading thread before read becomes ready
+	bool readResult = false;
+	std::atomic<float> readProgress{0.f};
+};
+
+Scene::Scene() = default;
 
 Scene::~Scene() {
+	// A file still being read is dropped, a parse that already started writes into this scene
+	if (_asyncLoad) {
+		_asyncLoad->file.Cancel();
+		if (_asyncLoad->read.valid()) {
+			_asyncLoad->read.wait();
+			uploadResources();
+		}
+	}
 	Clear();
 }
 
@@ -24,10 +54,7 @@ void Scene::Start() {
 }
 
 void Scene::Update() {
-	for (NodeID id : _freeList) {
-		freeNode(id);
-	}
-	_freeList.clear();
+	flushFreeList();
 
 	for (Node *node : _nodeIter) {
 		node->Update();
@@ -40,19 +67,13 @@ void Scene::Shutdown() {
 }
 
 Node *Scene::Create(NodeTypeID type, const std::string &name, NodeID id) {
-	static UUIDGenerator gen;
-
 	Node *node = _nodeDB->Create(type);
 	if (!node)
 		return nullptr;
 	node->_pScene = this;
-
-	NodeID nodeId = (id != 0 && !HasNode(id)) ? id : gen.Next();
-	node->_id = nodeId;
 	node->Rename(name);
 
-	_nodes[nodeId] = node;
-	_nodeIter.insert(node);
+	registerNode(node, id);
 	return node;
 }
 
@@ -60,6 +81,64 @@ Node *Scene::Create(const char *typeName, const std::string &name, NodeID id) {
 	return Create(_nodeDB->GetNodeTypeID(typeName), name, id);
 }
 
+std::vector<Node *> Scene::Instantiate(const Prefab &prefab, size_t count, Node *parent) {
+	std::vector<Node *> roots;
+	const size_t nodeCount = prefab.NodeCount();
+	if (count == 0 || nodeCount == 0)
+		return roots;
+
+	// Instance i owns nodes[i * nodeCount, (i + 1) * nodeCount), laid out in the prefab's entry order
+	std::vector<Node *> nodes(count * nodeCount, nullptr);
+	std::vector<Node *> batch;
+	for (const Prefab::TypeGroup &group : prefab._groups) {
+		batch.resize(group.entries.size() * count);
+		if (!_nodeDB->Create(group.type, batch.size(), batch.data())) {
+			Debug::Error("Failed to instantiate prefab: unknown node type {}", group.type);
+			_nodeDB->Destroy(nodes);
+			return roots;
+		}
+
+		size_t k = 0;
+		for (size_t i = 0; i < count; i++) {
+			for (u32 entry : group.entries) {
+				nodes[i * nodeCount + entry] = batch[k++];
+			}
+		}
+	}
+
+	roots.reserve(count);
+	for (size_t i = 0; i < count; i++) {
+		Node **instance = &nodes[i * nodeCount];
+
+		for (size_t e = 0; e < nodeCount; e++) {
+			const Prefab::Entry &entry = prefab._entries[e];
+			Node *node = instance[e];
+
+			// Only types with state outside their properties need the virtual call
+			if (entry.node->Type()->customCopy)
+				entry.node->Copy(node);
+			else
+				entry.node->copyPlan(node);
+			node->_pScene = this;
+			node->_children.reserve(entry.childCount);
+			if (entry.parent >= 0) {
+				Node *nodeParent = instance[entry.parent];
+				node->_parent = nodeParent;
+				nodeParent->_children.push_back(node);
+			}
+		}
+	}
+
+	registerNodes(nodes);
+	for (size_t i = 0; i < count; i++) {
+		roots.push_back(nodes[i * nodeCount]);
+		if (parent)
+			parent->AddChild(nodes[i * nodeCount]);
+	}
+
+	return roots;
+}
+
 bool Scene::HasNode(NodeID id) {
 	return _nodes.find(id) != _nodes.end();
 }
@@ -90,7 +169,7 @@ glm::mat4 Scene::GetMatrix2D() {
 	if (_currentCamera2D == 0)
 		return Camera2D::GetBlankMatrix();
 
-	Camera2D *camera = dynamic_cast<Camera2D *>(GetNode(_currentCamera2D));
+	Camera2D *camera = node_cast<Camera2D>(GetNode(_currentCamera2D));
 	if (!camera)
 		return Camera2D::GetBlankMatrix();
 
@@ -105,6 +184,20 @@ const std::filesystem::path &Scene::GetFilepath() {
 	return _scenePath;
 }
 
+// Serializes a node's own properties, without its children
+static Document SaveNodeProperties(Node *node, DocumentFormat format) {
+	Document nodeDoc(format);
+	node->Serialize(nodeDoc);
+	return nodeDoc;
+}
+
+static Document SaveResource(Resource *res, DocumentFormat format) {
+	Document resNode(format);
+	resNode.SetString("Type", App().GetResourceRegistry().GetTypeName(res->ResourceType()));
+	res->SaveResource(resNode);
+	return resNode;
+}
+
 bool Scene::SaveToFile(const char *path) {
 	if (path)
 		_scenePath = path;
@@ -116,129 +209,748 @@ bool Scene::SaveToFile(const char *path) {
 		return false;
 	}
 
-	YAML::Node out;
+	SaveableFileServer *fs = dynamic_cast<SaveableFileServer *>(App().FS().GetFileServer("res"));
+	if (fs == nullptr) {
+		Debug::Error("Failed to save scene: folder fs not found");
+		return false;
+	}
 
-	YAML::Node scene;
-	scene["Camera2D"] = GetCurrentCamera2D();
-	scene["Scripts"] = _scripts;
-	out["Scene"] = scene;
+	auto start = std::chrono::steady_clock::now();
+	bool binary = std::filesystem::path(path).extension() == ".sscnb";
+	size_t serialized = 0;
 
-	YAML::Node resources;
-	for (auto &[rid, res] : App().GetResourceRegistry().GetResources()) {
-		if (!res || rid == 0)
-			continue;
+	bool saved = fs->SaveAtomic(path, [&](std::ostream &stream) {
+		return binary ? saveBinary(stream, serialized) : saveYAML(stream, serialized);
+	});
+	pruneSaveCache();
+	if (!saved)
+		return false;
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	Debug::Info("Scene saved to '{}' in {:.2f} ms, {} of {} nodes serialized", path, elapsed.count(), serialized, _nodes.size());
+	return true;
+}
+
+Scene::SavedNode &Scene::savedNode(Node *node) {
+	SavedNode &saved = _saveCache[node->ID()];
+	if (node->_dirty) {
+		saved.yaml.clear();
+		saved.binary.clear();
+	}
+	if (node->_subtreeDirty)
+		saved.subtree.clear();
+
+	// Both formats are invalidated above, so whichever saves first can take the flags
+	node->_dirty = false;
+	node->_subtreeDirty = false;
+	return saved;
+}
+
+void Scene::pruneSaveCache() {
+	if (_saveCache.size() <= _nodes.size())
+		return;
+
+	for (auto it = _saveCache.begin(); it != _saveCache.end();) {
+		if (_nodes.count(it->first) == 0)
+			it = _saveCache.erase(it);
+		else
+			++it;
+	}
+}
+
+// Appends a cached block fragment, first prefixes its first line and rest the others
+static void AppendIndented(std::string &out, const std::string &fragment, const char *first, const char *rest) {
+	size_t pos = 0;
+	const char *prefix = first;
+	while (pos < fragment.size()) {
+		size_t end = fragment.find('\n', pos);
+		if (end == std::string::npos)
+			end = fragment.size();
 
-		// YAML::Node resNode;
-		Document resNode;
-		resNode.Set("Type", App().GetResourceRegistry().GetTypeName(res->ResourceType()));
-		res->SaveResource(resNode);
+		out += prefix;
+		out.append(fragment, pos, end - pos);
+		out += '\n';
 
-		resources[rid] = resNode.GetYAMLNode();
+		prefix = rest;
+		pos = end + 1;
 	}
-	out["Resources"] = resources;
+}
+
+bool Scene::saveYAML(std::ostream &stream, size_t &serialized) {
+	// Scene and resources go through the emitter, nodes are spliced in from their cached fragments
+	YAML::Emitter emitter(stream);
+	emitter << YAML::BeginMap;
+	emitter << YAML::Key << "Scene" << YAML::Value;
+	EmitYAML(emitter, saveSceneProperties(DocumentFormat::YAML).ToYAML());
 
-	std::function<YAML::Node(Node *)> saveNode;
-	saveNode = [&saveNode](Node *node) -> YAML::Node {
-		Document nodeDoc;
-		node->Serialize(nodeDoc);
+	emitter << YAML::Key << "Resources" << YAML::Value << YAML::BeginMap;
+	App().GetResourceRegistry().ForEachResource([&emitter](Resource *res) {
+		emitter << YAML::Key << res->GetRID() << YAML::Value;
+		EmitYAML(emitter, SaveResource(res, DocumentFormat::YAML).ToYAML());
+	});
+	emitter << YAML::EndMap;
+	emitter << YAML::EndMap;
+
+	if (!emitter.good()) {
+		Debug::Error("Failed to save scene: {}", emitter.GetLastError());
+		return false;
+	}
+	stream << '\n';
 
-		YAML::Node children;
-		for (Node *child : node->GetChildren()) {
-			children.push_back(saveNode(child));
+	// Returns the text of node's subtree at indentation 0. Clean subtrees are reused whole without visiting them
+	std::function<const std::string *(Node *)> saveNode;
+	saveNode = [&](Node *node) -> const std::string * {
+		SavedNode &saved = savedNode(node);
+		if (saved.yaml.empty()) {
+			YAML::Emitter props;
+			EmitYAML(props, SaveNodeProperties(node, DocumentFormat::YAML).ToYAML());
+			if (!props.good()) {
+				Debug::Error("Failed to save node {}: {}", node->ID(), props.GetLastError());
+				return nullptr;
+			}
+			AppendIndented(saved.yaml, props.c_str(), "", "");
+			serialized++;
 		}
-		if (children.size() > 0)
-			nodeDoc.SetDocument("Children", children);
 
-		return nodeDoc.GetYAMLNode();
+		if (node->_children.empty())
+			return &saved.yaml;
+
+		if (saved.subtree.empty()) {
+			std::string subtree = saved.yaml;
+			subtree += "Children:\n";
+			for (Node *child : node->_children) {
+				const std::string *text = saveNode(child);
+				if (!text)
+					return nullptr;
+				AppendIndented(subtree, *text, "  - ", "    ");
+			}
+			saved.subtree = std::move(subtree);
+		}
+		return &saved.subtree;
 	};
 
-	out["Root"] = saveNode(GetRoot());
+	if (!GetRoot()) {
+		stream << "Root: ~\n";
+		return stream.good();
+	}
+
+	const std::string *root = saveNode(GetRoot());
+	if (!root)
+		return false;
 
-	YAML::Emitter emitter;
-	emitter << out;
+	std::string text = "Root:\n";
+	AppendIndented(text, *root, "  ", "  ");
+	stream << text;
+	return stream.good();
+}
 
-	SaveableFileServer *fs = dynamic_cast<SaveableFileServer *>(App().FS().GetFileServer("res"));
-	if (fs == nullptr) {
-		Debug::Error("Failed to save scene: folder fs not found");
+bool Scene::saveBinary(std::ostream &stream, size_t &serialized) {
+	// Nodes, resources and the scene are written as binary documents, the typed entries need no YAML step either way
+	BinaryScene::Writer writer;
+	writer.SetSceneProperties(saveSceneProperties(DocumentFormat::Binary).ToBinary());
+
+	ResourceRegistry &registry = App().GetResourceRegistry();
+	registry.ForEachResource([&writer, &registry](Resource *res) {
+		writer.AddResource(res->GetRID(), registry.GetTypeName(res->ResourceType()), SaveResource(res, DocumentFormat::Binary).ToBinary());
+	});
+
+	std::function<void(Node *, u32)> saveNode;
+	saveNode = [&](Node *node, u32 parent) {
+		SavedNode &saved = savedNode(node);
+		if (saved.binary.empty()) {
+			saved.binary = SaveNodeProperties(node, DocumentFormat::Binary).ToBinary();
+			serialized++;
+		}
+
+		u32 index = writer.AddNode(node->ID(), node->Type() ? node->Type()->name : "Node", node->GetName(), parent, saved.binary);
+		for (Node *child : node->_children) {
+			saveNode(child, index);
+		}
+	};
+
+	if (GetRoot())
+		saveNode(GetRoot(), BinaryScene::NoParent);
+
+	std::vector<std::byte> bytes;
+	std::string error;
+	if (!writer.Finish(bytes, error)) {
+		Debug::Error("Failed to encode scene: {}", error);
 		return false;
 	}
 
-	std::ofstream fout;
-	fs->GetSaveStream(path, fout);
+	stream.write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+	return stream.good();
+}
 
-	if (!fout.good()) {
-		Debug::Error("Failed to open file on '{}'", path);
+Document Scene::saveSceneProperties(DocumentFormat format) {
+	Document scene(format);
+	scene.SetU64("Camera2D", GetCurrentCamera2D());
+	scene.SetStringList("Scripts", _scripts);
+	return scene;
+}
+
+bool Scene::LoadFromFile(const char *path) {
+	_scenePath = path;
+
+	bool loaded = readFile(path);
+	uploadResources();
+	return loaded;
+}
+
+bool Scene::LoadFromFileAsync(const char *path) {
+	if (_asyncLoad) {
+		Debug::Error("Scene '{}' is already loading", _scenePath.string());
 		return false;
 	}
-	fout << emitter.c_str();
+	_scenePath = path;
 
-	Debug::Info("Scene saved to '{}'", path);
+	_asyncLoad = std::make_unique<AsyncLoad>();
+	_asyncLoad->file = App().FS().LoadAsync(
+		path,
+		[this](Ref<FileData> data) {
+			if (!data) {
+				Debug::Error("Failed to open file: '{}'", _scenePath.string());
+				_asyncLoad->readDone = true;
+				return;
+			}
+			_asyncLoad->read = App().GetThreadPool().Submit([this, data]() {
+				_asyncLoad->readResult = readData(data);
+			});
+		},
+		IOPriority::High);
 	return true;
 }
 
-bool Scene::LoadFromFile(const char *path) {
-	_scenePath = path;
+float Scene::GetLoadProgress() const {
+	if (!_asyncLoad)
+		return 1.f;
+
+	// Reading the file and uploading resources count as one half each
+	if (!_asyncLoad->readDone)
+		return 0.5f * _asyncLoad->readProgress.load(std::memory_order_relaxed);
+	if (_pendingResources.empty())
+		return 1.f;
+	return 0.5f + 0.5f * static_cast<float>(_uploadedResources) / _pendingResources.size();
+}
+
+bool Scene::updateLoad(std::chrono::microseconds budget, bool &loaded) {
+	if (!_asyncLoad) {
+		loaded = true;
+		return true;
+	}
+
+	if (!_asyncLoad->readDone) {
+		if (!_asyncLoad->read.valid())
+			return false;
+		if (_asyncLoad->read.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+			return false;
+		_asyncLoad->readDone = true;
+	}
+
+	if (!uploadResources(budget))
+		return false;
+
+	loaded = _asyncLoad->readResult;
+	_asyncLoad.reset();
+	return true;
+}
 
-	Ref<FileData> data = App().FS().Load(path);
-	if (!data) {
+void Scene::reportReadProgress(float progress) {
+	if (_asyncLoad)
+		_asyncLoad->readProgress.store(progress, std::memory_order_relaxed);
+}
+
+bool Scene::readFile(const char *path) {
+	std::unique_ptr<std::istream> stream = App().FS().LoadStream(path);
+	if (!stream) {
 		Debug::Error("Failed to open file: '{}'", path);
 		return false;
 	}
-	std::string str{reinterpret_cast<char *>(data->Data()), data->Size()};
-	YAML::Node doc = YAML::Load(str);
 
-	YAML::Node resources = doc["Resources"];
-	for (YAML::const_iterator it = resources.begin(); it != resources.end(); ++it) {
-		RID rid = it->first.as<RID>(0);
-		YAML::Node resData = it->second;
-		std::string resType = resData["Type"].as<std::string>("");
+	std::byte magic[sizeof(BinaryScene::Magic)]{};
+	stream->read(reinterpret_cast<char *>(magic), sizeof(magic));
+	if (stream->gcount() == sizeof(magic) && std::memcmp(magic, BinaryScene::Magic, sizeof(magic)) == 0) {
+		Ref<FileData> data = App().FS().Load(path);
+		if (!data) {
+			Debug::Error("Failed to open file: '{}'", path);
+			return false;
+		}
+		return loadBinary(data->Data(), data->Size());
+	}
 
-		Resource *res = App().GetResourceRegistry().CreateResource(resType.c_str());
-		if (res) {
-			App().GetResourceRegistry().AddResource(res, rid);
-			res->LoadResource(resData);
-		} else {
-			Debug::Error("Failed to load resource: {}", rid);
+	stream->clear();
+	stream->seekg(0);
+	return loadYAML(*stream);
+}
+
+bool Scene::readData(Ref<FileData> data) {
+	if (data->Size() >= sizeof(BinaryScene::Magic) && std::memcmp(data->Data(), BinaryScene::Magic, sizeof(BinaryScene::Magic)) == 0)
+		return loadBinary(data->Data(), data->Size());
+
+	std::unique_ptr<std::istream> stream = FileData::OpenStream(data);
+	return loadYAML(*stream);
+}
+
+// Walks parser events and creates each node as soon as the properties before its Children are read. Only the
+// nodes on the path from the root to the current one are held, so memory follows tree depth instead of file size
+class Scene::StreamLoader : public YAML::EventHandler {
+  public:
+	StreamLoader(Scene *scene, std::streamoff size) : _scene(scene), _size(size) {}
+
+	void OnDocumentStart(const YAML::Mark &mark) override {}
+	void OnDocumentEnd() override {}
+
+	void OnNull(const YAML::Mark &mark, YAML::anchor_t anchor) override {
+		if (!_builder.IsBuilding()) {
+			if (readKey(""))
+				return;
+			_builder.Begin(!keepValue());
+		}
+		_builder.Null(anchor);
+		deliver();
+	}
+
+	void OnAlias(const YAML::Mark &mark, YAML::anchor_t anchor) override {
+		if (!_builder.IsBuilding())
+			_builder.Begin(!keepValue());
+		_builder.Alias(anchor);
+		deliver();
+	}
+
+	void OnScalar(const YAML::Mark &mark, const std::string &tag, YAML::anchor_t anchor, const std::string &value) override {
+		if (!_builder.IsBuilding()) {
+			if (readKey(value))
+				return;
+			_builder.Begin(!keepValue());
+		}
+		_builder.Scalar(tag, anchor, value);
+		deliver();
+	}
+
+	void OnSequenceStart(const YAML::Mark &mark, const std::string &tag, YAML::anchor_t anchor, YAML::EmitterStyle::value style) override {
+		if (!_builder.IsBuilding()) {
+			Frame *top = _stack.empty() ? nullptr : &_stack.back();
+			if (top && top->kind == FrameKind::Node && top->hasKey && top->key == "Children") {
+				Node *node = create(*top);
+				if (node) {
+					Frame &frame = _stack.emplace_back();
+					frame.kind = FrameKind::Children;
+					frame.node = node;
+					return;
+				}
+			}
+			_builder.Begin(!keepValue());
 		}
+		_builder.SequenceStart(tag, anchor, style);
 	}
 
-	std::function<Node *(YAML::Node)> loadNode;
+	void OnSequenceEnd() override {
+		if (_builder.IsBuilding()) {
+			_builder.SequenceEnd();
+			deliver();
+			return;
+		}
+		pop();
+	}
+
+	void OnMapStart(const YAML::Mark &mark, const std::string &tag, YAML::anchor_t anchor, YAML::EmitterStyle::value style) override {
+		if (!_builder.IsBuilding()) {
+			if (_stack.empty() && !_started) {
+				_started = true;
+				_stack.emplace_back().kind = FrameKind::Document;
+				return;
+			}
+
+			Frame *top = _stack.empty() ? nullptr : &_stack.back();
+			FrameKind kind = FrameKind::Document;
+			Node *parent = nullptr;
+			bool structural = false;
+			if (top && top->kind == FrameKind::Document && top->hasKey) {
+				kind = top->key == "Root" ? FrameKind::Node : FrameKind::Resources;
+				structural = top->key == "Root" || top->key == "Resources";
+			} else if (top && top->kind == FrameKind::Children) {
+				kind = FrameKind::Node;
+				parent = top->node;
+				structural = true;
+			}
 
-	loadNode = [this, &loadNode](YAML::Node node) {
-		std::string type = node["Type"].as<std::string>("Node");
-		std::string name = node["Name"].as<std::string>("New Node");
-		NodeID nodeId = node["ID"].as<NodeID>(0);
+			if (structural) {
+				if (kind == FrameKind::Node && _size > 0)
+					_scene->reportReadProgress(static_cast<float>(mark.pos) / _size);
 
-		Node *n = this->Create(type.c_str(), name, nodeId);
-		Document doc(node);
-		n->Deserialize(doc);
+				Frame &frame = _stack.emplace_back();
+				frame.kind = kind;
+				frame.parent = parent;
+				return;
+			}
+			_builder.Begin(!keepValue());
+		}
+		_builder.MapStart(tag, anchor, style);
+	}
 
-		YAML::Node children = node["Children"];
-		for (YAML::const_iterator it = children.begin(); it != children.end(); ++it) {
-			n->AddChild(loadNode(*it));
+	void OnMapEnd() override {
+		if (_builder.IsBuilding()) {
+			_builder.MapEnd();
+			deliver();
+			return;
 		}
+		pop();
+	}
+
+  private:
+	enum class FrameKind {
+		Document,
+		Resources,
+		Node,
+		Children,
+	};
+
+	struct Frame {
+		FrameKind kind = FrameKind::Document;
+		std::string key = "";
+		bool hasKey = false;
 
-		return n;
+		// Node frames collect their properties until the node is created. Children frames keep their parent in node
+		YAML::Node props;
+		Node *parent = nullptr;
+		Node *node = nullptr;
+		bool failed = false;
+		bool dirty = false;
 	};
 
-	YAML::Node root = doc["Root"];
-	SetRoot(loadNode(root));
+	bool isMap(const Frame &frame) {
+		return frame.kind != FrameKind::Children;
+	}
+
+	// Takes a scalar as the next key of the current map, returns false if a value is expected instead
+	bool readKey(const std::string &key) {
+		if (_stack.empty() || !isMap(_stack.back()) || _stack.back().hasKey)
+			return false;
 
-	YAML::Node scene = doc["Scene"];
-	if (scene) {
-		SetCurrentCamera2D(scene["Camera2D"].as<NodeID>(GetCurrentCamera2D()));
-		_scripts = scene["Scripts"].as<std::vector<std::string>>(std::vector<std::string>{});
+		_stack.back().key = key;
+		_stack.back().hasKey = true;
+		return true;
 	}
 
+	// Values the loader does not use are walked without being built
+	bool keepValue() {
+		if (_stack.empty())
+			return false;
+
+		const Frame &top = _stack.back();
+		switch (top.kind) {
+		case FrameKind::Document:
+			return top.hasKey && top.key == "Scene";
+		case FrameKind::Resources:
+			return top.hasKey;
+		case FrameKind::Node:
+			return top.hasKey && top.key != "Children";
+		case FrameKind::Children:
+			return false;
+		}
+		return false;
+	}
+
+	void deliver() {
+		if (!_builder.IsDone())
+			return;
+
+		YAML::Node value = _builder.Take();
+		if (_stack.empty())
+			return;
+
+		Frame &top = _stack.back();
+		if (!isMap(top))
+			return;
+
+		// Complex keys are never used by scenes, their value is read under an empty key
+		if (!top.hasKey) {
+			top.key = "";
+			top.hasKey = true;
+			return;
+		}
+
+		if (top.kind == FrameKind::Document && top.key == "Scene") {
+			_scene->loadSceneProperties(Document(value));
+		} else if (top.kind == FrameKind::Resources) {
+			// A binary copy owns its data, yaml-cpp nodes are not thread safe and async loads read on a worker
+			_scene->loadResource(YAML::Node(top.key).as<RID>(0), Document(value).Convert(DocumentFormat::Binary));
+		} else if (top.kind == FrameKind::Node && top.key != "Children") {
+			top.props[top.key] = value;
+			if (top.node)
+				top.dirty = true;
+		}
+		top.hasKey = false;
+	}
+
+	Node *create(Frame &frame) {
+		if (frame.node || frame.failed)
+			return frame.node;
+
+		std::string type = frame.props["Type"].as<std::string>("Node");
+		std::string name = frame.props["Name"].as<std::string>("New Node");
+		NodeID nodeId = frame.props["ID"].as<NodeID>(0);
+
+		frame.node = _scene->Create(type.c_str(), name, nodeId);
+		if (!frame.node) {
+			Debug::Error("Failed to load node {}: unknown type '{}'", nodeId, type);
+			frame.failed = true;
+			return nullptr;
+		}
+
+		Document doc(frame.props);
+		frame.node->Deserialize(doc);
+		return frame.node;
+	}
+
+	void pop() {
+		if (_stack.empty())
+			return;
+
+		Frame frame = _stack.back();
+		_stack.pop_back();
+
+		if (frame.kind == FrameKind::Node) {
+			Node *node = create(frame);
+			if (node && frame.dirty) {
+				// Properties written after Children are applied once the whole map is read
+				Document doc(frame.props);
+				node->Deserialize(doc);
+			}
+
+			if (node && frame.parent)
+				frame.parent->AddChild(node);
+			else if (node)
+				_scene->SetRoot(node);
+		}
+
+		if (!_stack.empty() && isMap(_stack.back()))
+			_stack.back().hasKey = false;
+	}
+
+  private:
+	Scene *_scene = nullptr;
+	std::streamoff _size = 0;
+	std::vector<Frame> _stack;
+	YAMLNodeBuilder _builder;
+	bool _started = false;
+};
+
+bool Scene::loadYAML(std::istream &stream) {
+	stream.seekg(0, std::ios::end);
+	std::streamoff size = stream.tellg();
+	stream.seekg(0);
+
+	StreamLoader loader(this, size);
+	bool loaded = true;
+	try {
+		YAML::Parser parser(stream);
+		parser.HandleNextDocument(loader);
+	} catch (const YAML::Exception &e) {
+		Debug::Error("Failed to load scene '{}': {}", _scenePath.string(), e.what());
+		loaded = false;
+	}
+
+	return loaded;
+}
+
+bool Scene::loadBinary(const std::byte *data, size_t size) {
+	BinaryScene::Reader reader;
+	if (!reader.Open(data, size)) {
+		Debug::Error("Failed to load scene '{}': {}", _scenePath.string(), reader.GetError());
+		return false;
+	}
+
+	for (u32 i = 0; i < reader.GetResourceCount(); i++) {
+		BinaryScene::ResourceRecord record = reader.GetResource(i);
+
+		Document resData(DocumentFormat::Binary);
+		if (!reader.ReadProperties(record.properties, resData)) {
+			Debug::Error("Failed to load resource {}: {}", record.rid, reader.GetError());
+			continue;
+		}
+		loadResource(record.rid, std::move(resData));
+	}
+
+	// Type names are resolved once per type instead of once per node
+	std::vector<NodeTypeID> types(reader.GetTypeCount());
+	for (u32 i = 0; i < reader.GetTypeCount(); i++) {
+		types[i] = _nodeDB->GetNodeTypeID(std::string(reader.GetTypeName(i)));
+	}
+
+	std::vector<Node *> nodes(reader.GetNodeCount(), nullptr);
+	Document props(DocumentFormat::Binary);
+	for (u32 i = 0; i < reader.GetNodeCount(); i++) {
+		if (i % 256 == 0)
+			reportReadProgress(static_cast<float>(i) / reader.GetNodeCount());
+
+		BinaryScene::NodeRecord record = reader.GetNode(i);
+
+		// Parents always precede their children, a missing parent means its subtree was skipped
+		Node *parent = record.parent != BinaryScene::NoParent ? nodes[record.parent] : nullptr;
+		if (record.parent != BinaryScene::NoParent && !parent)
+			continue;
+
+		Node *node = Create(types[record.type], std::string(reader.GetString(record.name)), record.id);
+		if (!node) {
+			Debug::Error("Failed to load node {}: unknown type '{}'", record.id, std::string(reader.GetTypeName(record.type)));
+			continue;
+		}
+
+		// The node is kept with its defaults, like YAML loading keeps them for bad values
+		if (reader.ReadProperties(record.properties, props))
+			node->Deserialize(props);
+		else
+			Debug::Error("Failed to load node {} properties: {}", record.id, reader.GetError());
+
+		if (parent)
+			parent->AddChild(node);
+		nodes[i] = node;
+	}
+
+	if (!nodes.empty() && nodes[0])
+		SetRoot(nodes[0]);
+
+	Document scene(DocumentFormat::Binary);
+	if (reader.ReadProperties(reader.GetSceneProperties(), scene))
+		loadSceneProperties(scene);
+
 	return true;
 }
 
+void Scene::loadResource(RID rid, Document doc) {
+	// Resources another scene uses or released recently are shared instead of loaded again
+	ResourceRef loaded = App().GetResourceRegistry().Acquire(rid);
+	if (loaded) {
+		_pendingResources.emplace_back().loaded = std::move(loaded);
+		return;
+	}
+
+	std::string resType = doc.GetString("Type", "");
+
+	Resource *res = App().GetResourceRegistry().CreateResource(resType.c_str());
+	if (!res) {
+		Debug::Error("Failed to load resource: {}", rid);
+		return;
+	}
+
+	PendingResource &pending = _pendingResources.emplace_back();
+	pending.resource = res;
+	pending.rid = rid;
+	// Resources without a decode phase may touch GL or AL while loading, they load in uploadResources
+	if (!res->HasDecodePhase()) {
+		pending.doc = std::move(doc);
+		return;
+	}
+
+	// Decoding overlaps with reading the nodes
+	pending.decoded = App().GetThreadPool().Submit([res, doc = std::move(doc)]() {
+		res->DecodeResource(doc);
+	});
+}
+
+bool Scene::uploadResources(std::chrono::microseconds budget) {
+	auto start = std::chrono::steady_clock::now();
+	bool timed = budget.count() > 0;
+
+	// Before the first upload, packed textures never get a texture of their own
+	if (!_texturesPacked) {
+		if (!packTextures(timed))
+			return false;
+		_texturesPacked = true;
+	}
+
+	while (_uploadedResources < _pendingResources.size()) {
+		PendingResource &pending = _pendingResources[_uploadedResources];
+		if (pending.loaded) {
+			_resources.push_back(std::move(pending.loaded));
+			_uploadedResources++;
+			continue;
+		}
+
+		if (pending.decoded.valid()) {
+			if (timed && pending.decoded.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+				return false;
+
+			pending.decoded.wait();
+			pending.resource->UploadResource();
+		} else {
+			pending.resource->LoadResource(pending.doc);
+		}
+		_resources.push_back(App().GetResourceRegistry().Register(pending.resource, pending.rid));
+		_uploadedResources++;
+
+		if (timed && std::chrono::steady_clock::now() - start >= budget)
+			return false;
+	}
+
+	_pendingResources.clear();
+	_uploadedResources = 0;
+	_texturesPacked = false;
+	return true;
+}
+
+bool Scene::packTextures(bool timed) {
+	const auto &settings = App().GetProjectSettings().rendering.atlas;
+	if (!settings.enabled)
+		return true;
+
+	std::vector<ImageTexture *> textures;
+	for (size_t i = _uploadedResources; i < _pendingResources.size(); i++) {
+		PendingResource &pending = _pendingResources[i];
+		if (!pending.resource || pending.resource->ResourceType() != typeid(ImageTexture).hash_code())
+			continue;
+		ImageTexture *texture = static_cast<ImageTexture *>(pending.resource);
+
+		if (pending.decoded.valid()) {
+			if (timed && pending.decoded.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+				return false;
+			pending.decoded.wait();
+		}
+		textures.push_back(texture);
+	}
+
+	AtlasSettings atlas;
+	atlas.pageSize = settings.pageSize;
+	atlas.maxTextureSize = settings.maxTextureSize;
+	atlas.gutter = settings.gutter;
+
+	AtlasReport report = TextureAtlas::Pack(textures, atlas);
+	if (report.pages > 0) {
+		Debug::Info("Packed {} textures of '{}' into {} atlas pages, {:.0f}% used. They need at least {} 2D batches instead of {}",
+					report.textures, _scenePath.string(), report.pages, report.occupancy * 100.f, report.batchesAfter, report.batchesBefore);
+	}
+	return true;
+}
+
+void Scene::loadSceneProperties(const Document &scene) {
+	SetCurrentCamera2D(scene.GetU64("Camera2D", GetCurrentCamera2D()));
+	_scripts = scene.GetStringList("Scripts", {});
+}
+
 void Scene::Clear() {
-	if (GetRoot())
-		freeNode(GetRoot()->ID());
+	_freeList.clear();
+
+	// Every node goes, including the ones that were never attached to the tree
+	if (_nodeDB)
+		_nodeDB->Destroy(std::vector<Node *>(_nodeIter.begin(), _nodeIter.end()));
+	_root = nullptr;
 
 	_nodes.clear();
 	_nodeIter.clear();
+	_spatialIndex.Clear();
+	_saveCache.clear();
+
+	// After the nodes, which may still look their resources up while being destroyed
+	_resources.clear();
+}
+
+bool Scene::HoldResource(const ResourceRef &ref) {
+	if (!ref || std::find(_resources.begin(), _resources.end(), ref) != _resources.end())
+		return false;
+
+	_resources.push_back(ref);
+	return true;
 }
 
 // static
@@ -249,29 +961,112 @@ void Scene::Copy(Scene *src, Scene *dst) {
 	dst->SetCurrentCamera2D(src->GetCurrentCamera2D());
 	dst->_scripts = src->_scripts;
 	dst->_scenePath = src->_scenePath;
+	dst->_resources = src->_resources;
 }
 
-void Scene::freeNode(NodeID id) {
-	Node *node = GetNode(id);
-	if (!node)
+void Scene::registerNode(Node *node, NodeID id) {
+	assignID(node, id);
+	_nodeIter.insert(node);
+}
+
+void Scene::registerNodes(const std::vector<Node *> &nodes) {
+	_nodes.reserve(_nodes.size() + nodes.size());
+	for (Node *node : nodes)
+		assignID(node, 0);
+
+	// Batches come from pool allocations, so in address order they mostly sit next to each other in _nodeIter and
+	// inserting at the hint takes constant time
+	std::vector<Node *> sorted(nodes);
+	std::sort(sorted.begin(), sorted.end());
+	auto hint = _nodeIter.end();
+	for (Node *node : sorted)
+		hint = std::next(_nodeIter.emplace_hint(hint, node));
+}
+
+void Scene::assignID(Node *node, NodeID id) {
+	if (id == 0 || !_nodes.try_emplace(id, node).second) {
+		if (_nextID == 0)
+			_nextID = UUIDGenerator().Next();
+
+		// Skip 0 and any id an earlier load or copy already claimed
+		do {
+			id = _nextID++;
+		} while (id == 0 || !_nodes.try_emplace(id, node).second);
+	}
+
+	node->_id = id;
+}
+
+void Scene::flushFreeList() {
+	if (_freeList.empty())
 		return;
 
-	if (node == _root) {
-		_root = nullptr;
+	std::unordered_set<Node *> pending;
+	pending.reserve(_freeList.size());
+	for (NodeID id : _freeList) {
+		if (Node *node = GetNode(id); nullptr != node)
+			pending.insert(node);
+	}
+	_freeList.clear();
+
+	std::vector<Node *> roots;
+	roots.reserve(pending.size());
+	for (Node *node : pending) {
+		bool covered = false;
+		for (Node *parent = node->_parent; nullptr != parent && !covered; parent = parent->_parent) {
+			covered = pending.find(parent) != pending.end();
+		}
+
+		if (!covered)
+			roots.push_back(node);
 	}
 
-	if (Node *parent = node->GetParent(); nullptr != parent) {
-		parent->RemoveChild(node);
+	destroySubtrees(roots);
+}
+
+void Scene::destroySubtrees(const std::vector<Node *> &roots) {
+	std::vector<Node *> nodes;
+	for (Node *root : roots) {
+		if (Node *parent = root->_parent; nullptr != parent) {
+			parent->RemoveChild(root);
+		}
+
+		// Breadth first walk, the batch itself is the queue
+		size_t begin = nodes.size();
+		nodes.push_back(root);
+		for (size_t i = begin; i < nodes.size(); i++) {
+			const std::vector<Node *> &children = nodes[i]->_children;
+			nodes.insert(nodes.end(), children.begin(), children.end());
+		}
 	}
-	for (Node *child : node->GetChildren()) {
-		child->_parent = nullptr;
+
+	if (nodes.empty())
+		return;
+
+	for (Node *node : nodes) {
+		if (node == _root)
+			_root = nullptr;
+
+		_nodes.erase(node->_id);
+		_spatialIndex.Remove(node->_id);
 	}
 
-	for (size_t i = 0; i < node->GetChildren().size(); i++) {
-		freeNode(node->GetChildren()[i]->ID());
+	// _nodeIter is ordered by address, so a sorted batch can be removed in a single walk
+	std::sort(nodes.begin(), nodes.end());
+	if (nodes.size() * 16 < _nodeIter.size()) {
+		for (Node *node : nodes) {
+			_nodeIter.erase(node);
+		}
+	} else {
+		auto it = _nodeIter.begin();
+		for (Node *node : nodes) {
+			while (it != _nodeIter.end() && *it < node)
+				++it;
+
+			if (it != _nodeIter.end() && *it == node)
+				it = _nodeIter.erase(it);
+		}
 	}
 
-	_nodeDB->Destroy(node);
-	_nodes.erase(id);
-	_nodeIter.erase(node);
+	_nodeDB->Destroy(nodes);
 }
\ No newline at end of file
@@ -2,7 +2,10 @@
 #define SCENE_HPP
 #pragma once
 
+#include <chrono>
 #include <filesystem>
+#include <future>
+#include <memory>
 #include <set>
 #include <sowa.hpp>
 #include <string>
@@ -11,11 +14,18 @@
 
 #include "node.hpp"
 #include "node_db.hpp"
+#include "spatial_index.hpp"
 
 #include "data/id_generator.hpp"
+#include "resource/resource_registry.hpp"
+
+class Prefab;
+class Resource;
+struct FileData;
 
 class Scene {
   public:
+	Scene();
 	~Scene();
 
 	void Start();
@@ -25,6 +35,9 @@ class Scene {
 	Node *Create(NodeTypeID type, const std::string &name = "Object", NodeID id = 0);
 	Node *Create(const char *typeName, const std::string &name = "Object", NodeID id = 0);
 
+	// Creates count copies of the prefab and returns their roots. Roots are attached to parent if given
+	std::vector<Node *> Instantiate(const Prefab &prefab, size_t count = 1, Node *parent = nullptr);
+
 	bool HasNode(NodeID id);
 	Node *GetNode(NodeID id);
 
@@ -38,16 +51,93 @@ class Scene {
 
 	void FreeNode(NodeID id);
 
+	// World bounds of drawn Sprite2D, AnimatedSprite2D, Text2D and ProgressBar nodes, refreshed as they update
+	inline SpatialIndex &GetSpatialIndex() { return _spatialIndex; }
+
 	const std::filesystem::path &GetFilepath();
 
 	bool SaveToFile(const char *path = nullptr);
 	bool LoadFromFile(const char *path);
+	// Reads the file, creates the nodes and decodes resources on worker threads. The scene must not be used while
+	// IsLoading, see Application::LoadSceneAsync which finishes the load over the following frames
+	bool LoadFromFileAsync(const char *path);
+	inline bool IsLoading() const { return _asyncLoad != nullptr; }
+	// Fraction of an async load that is done, from 0 to 1
+	float GetLoadProgress() const;
 
 	void Clear();
 	static void Copy(Scene *src, Scene *dst);
 
+	// Keeps the resource loaded while the scene exists. Returns false if the scene already holds it
+	bool HoldResource(const ResourceRef &ref);
+
   private:
-	void freeNode(NodeID id);
+	class StreamLoader;
+	struct AsyncLoad;
+
+	// Last saved form of a node, reused until the node is marked dirty
+	struct SavedNode {
+		// Block style at indentation 0, filled by the first YAML save
+		std::string yaml = "";
+		// yaml followed by the children, kept while no node below changes. Each level holds a copy of its
+		// descendants' text, so the cache grows with the depth of the tree
+		std::string subtree = "";
+		// Encoded binary Document, filled by the first binary save
+		std::vector<std::byte> binary;
+	};
+
+	// Returns node's cache entry, dropping what the node's dirty flags made stale and clearing the flags
+	SavedNode &savedNode(Node *node);
+	// Drops entries of nodes that no longer exist
+	void pruneSaveCache();
+
+	bool saveYAML(std::ostream &stream, size_t &serialized);
+	bool saveBinary(std::ostream &stream, size_t &serialized);
+	Document saveSceneProperties(DocumentFormat format);
+
+	// Reads the scene file. Resources are created but not registered or uploaded until uploadResources
+	bool readFile(const char *path);
+	// readFile for a file already in memory
+	bool readData(Ref<FileData> data);
+	bool loadYAML(std::istream &stream);
+	// Loads a .sscnb scene, data only needs to stay alive during the call
+	bool loadBinary(const std::byte *data, size_t size);
+	// Starts loading a resource from its saved data. doc must be binary, so it can be handed to a worker
+	void loadResource(RID rid, Document doc);
+	// Registers the resources read by loadResource and uploads them in load order. With a budget, returns false once it
+	// runs out or reaches a resource still decoding. Without one, waits for every decode
+	bool uploadResources(std::chrono::microseconds budget = std::chrono::microseconds::zero());
+	// Packs the pending textures into atlas pages once all of them decoded. Returns false while one is still decoding
+	// and timed is set
+	bool packTextures(bool timed);
+	void loadSceneProperties(const Document &scene);
+	// Called from the reading thread, progress is from 0 to 1
+	void reportReadProgress(float progress);
+	// Main thread part of an async load, returns true once the load is finished and sets loaded to its result
+	bool updateLoad(std::chrono::microseconds budget, bool &loaded);
+
+	// Registers node under id, or under the next free id of the sequence if id is 0 or taken
+	void registerNode(Node *node, NodeID id);
+	// Registers new nodes under fresh ids
+	void registerNodes(const std::vector<Node *> &nodes);
+	// The _nodes half of registerNode
+	void assignID(Node *node, NodeID id);
+
+	// Resolves pending frees, dropping duplicates and nodes whose ancestor is also being freed
+	void flushFreeList();
+	// Unlinks each root from its parent and destroys the roots with all of their descendants
+	void destroySubtrees(const std::vector<Node *> &roots);
+
+	struct PendingResource {
+		// Set instead of resource when the registry still had the resource loaded or cached
+		ResourceRef loaded;
+		Resource *resource = nullptr;
+		RID rid = 0;
+		// Saved data of the resource, resources without a decode phase load from it on the main thread
+		Document doc;
+		// Only valid for resources with a decode phase
+		std::future<void> decoded;
+	};
 
   private:
 	friend class Application;
@@ -57,11 +147,26 @@ class Scene {
 
 	std::vector<NodeID> _freeList;
 
+	// New ids continue a sequence from a random start instead of drawing a random id each
+	NodeID _nextID = 0;
+
 	Node *_root = nullptr;
 	NodeID _currentCamera2D = 0;
 	std::vector<std::string> _scripts;
 
+	// Resources read from the scene file, decoding on the thread pool until they are uploaded
+	std::vector<PendingResource> _pendingResources;
+	size_t _uploadedResources = 0;
+	bool _texturesPacked = false;
+	// References to every resource the scene loaded or holds
+	std::vector<ResourceRef> _resources;
+
+	std::unique_ptr<AsyncLoad> _asyncLoad;
+
+	std::unordered_map<NodeID, SavedNode> _saveCache;
+
 	NodeDB *_nodeDB = nullptr;
+	SpatialIndex _spatialIndex;
 
 	std::filesystem::path _scenePath = "";
 };
@@ -0,0 +1,247 @@
+#include "spatial_index.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+static constexpr i64 s_maxCellsPerEntry = 64;
+
+SpatialIndex::SpatialIndex(float cellSize) {
+	SetCellSize(cellSize);
+}
+
+void SpatialIndex::Update(NodeID id, const Rect &bounds) {
+	i32 minX, minY, maxX, maxY;
+	cellRange(bounds, minX, minY, maxX, maxY);
+
+	auto it = _lookup.find(id);
+	if (it == _lookup.end()) {
+		u32 index = static_cast<u32>(_entries.size());
+		Entry &entry = _entries.emplace_back();
+		entry.id = id;
+		entry.bounds = bounds;
+		entry.minX = minX;
+		entry.minY = minY;
+		entry.maxX = maxX;
+		entry.maxY = maxY;
+		_lookup[id] = index;
+
+		insertCells(index);
+		return;
+	}
+
+	u32 index = it->second;
+	Entry &entry = _entries[index];
+	entry.bounds = bounds;
+	if (entry.minX == minX && entry.minY == minY && entry.maxX == maxX && entry.maxY == maxY)
+		return;
+
+	removeCells(index);
+	entry.minX = minX;
+	entry.minY = minY;
+	entry.maxX = maxX;
+	entry.maxY = maxY;
+	insertCells(index);
+}
+
+void SpatialIndex::Remove(NodeID id) {
+	auto it = _lookup.find(id);
+	if (it == _lookup.end())
+		return;
+
+	u32 index = it->second;
+	u32 last = static_cast<u32>(_entries.size() - 1);
+	removeCells(index);
+	_lookup.erase(it);
+
+	if (index != last) {
+		// Move the last entry into the hole and repoint its cell references
+		removeCells(last);
+		_entries[index] = _entries[last];
+		_lookup[_entries[index].id] = index;
+		insertCells(index);
+	}
+	_entries.pop_back();
+}
+
+void SpatialIndex::Clear() {
+	_entries.clear();
+	_lookup.clear();
+	_cells.clear();
+	_large.clear();
+}
+
+bool SpatialIndex::Has(NodeID id) const {
+	return _lookup.find(id) != _lookup.end();
+}
+
+size_t SpatialIndex::Size() const {
+	return _entries.size();
+}
+
+void SpatialIndex::QueryRect(const Rect &rect, std::vector<NodeID> &result) {
+	visit(
+		rect, [&rect](const Rect &bounds) { return bounds.Intersects(rect); }, result);
+}
+
+void SpatialIndex::QueryPoint(const Vector2 &point, std::vector<NodeID> &result) {
+	visit(
+		Rect(point.x, point.y), [&point](const Rect &bounds) { return bounds.Contains(point.x, point.y); }, result);
+}
+
+void SpatialIndex::QueryRadius(const Vector2 &center, float radius, std::vector<NodeID> &result) {
+	float radiusSq = radius * radius;
+	visit(
+		Rect(center.x - radius, center.y - radius, radius * 2.f, radius * 2.f), [&center, radiusSq](const Rect &bounds) {
+			float dx = std::max(std::max(bounds.x - center.x, 0.f), center.x - (bounds.x + bounds.w));
+			float dy = std::max(std::max(bounds.y - center.y, 0.f), center.y - (bounds.y + bounds.h));
+			return dx * dx + dy * dy <= radiusSq;
+		},
+		result);
+}
+
+float SpatialIndex::GetCellSize() const {
+	return _cellSize;
+}
+
+void SpatialIndex::SetCellSize(float cellSize) {
+	_cellSize = std::max(cellSize, 1.f);
+	_invCellSize = 1.f / _cellSize;
+
+	if (_entries.empty())
+		return;
+
+	_cells.clear();
+	_large.clear();
+	for (u32 i = 0; i < _entries.size(); i++) {
+		Entry &entry = _entries[i];
+		cellRange(entry.bounds, entry.minX, entry.minY, entry.maxX, entry.maxY);
+		insertCells(i);
+	}
+}
+
+Rect SpatialIndex::TransformBounds(const glm::mat4 &transform, const Rect &local) {
+	glm::vec4 points[4] = {
+		transform * glm::vec4(local.x, local.y, 0.f, 1.f),
+		transform * glm::vec4(local.x + local.w, local.y, 0.f, 1.f),
+		transform * glm::vec4(local.x, local.y + local.h, 0.f, 1.f),
+		transform * glm::vec4(local.x + local.w, local.y + local.h, 0.f, 1.f)};
+
+	float minX = points[0].x, maxX = points[0].x;
+	float minY = points[0].y, maxY = points[0].y;
+	for (int i = 1; i < 4; i++) {
+		minX = std::min(minX, points[i].x);
+		maxX = std::max(maxX, points[i].x);
+		minY = std::min(minY, points[i].y);
+		maxY = std::max(maxY, points[i].y);
+	}
+
+	return Rect(minX, minY, maxX - minX, maxY - minY);
+}
+
+void SpatialIndex::insertCells(u32 index) {
+	Entry &entry = _entries[index];
+
+	i64 cellCount = (static_cast<i64>(entry.maxX) - entry.minX + 1) * (static_cast<i64>(entry.maxY) - entry.minY + 1);
+	entry.large = cellCount > s_maxCellsPerEntry;
+	if (entry.large) {
+		_large.push_back(index);
+		return;
+	}
+
+	for (i32 y = entry.minY; y <= entry.maxY; y++) {
+		for (i32 x = entry.minX; x <= entry.maxX; x++) {
+			_cells[cellKey(x, y)].push_back(index);
+		}
+	}
+}
+
+void SpatialIndex::removeCells(u32 index) {
+	const Entry &entry = _entries[index];
+
+	if (entry.large) {
+		auto it = std::find(_large.begin(), _large.end(), index);
+		if (it != _large.end()) {
+			*it = _large.back();
+			_large.pop_back();
+		}
+		return;
+	}
+
+	for (i32 y = entry.minY; y <= entry.maxY; y++) {
+		for (i32 x = entry.minX; x <= entry.maxX; x++) {
+			auto cell = _cells.find(cellKey(x, y));
+			if (cell == _cells.end())
+				continue;
+
+			std::vector<u32> &items = cell->second;
+			auto it = std::find(items.begin(), items.end(), index);
+			if (it != items.end()) {
+				*it = items.back();
+				items.pop_back();
+			}
+			if (items.empty())
+				_cells.erase(cell);
+		}
+	}
+}
+
+void SpatialIndex::cellRange(const Rect &rect, i32 &minX, i32 &minY, i32 &maxX, i32 &maxY) const {
+	minX = static_cast<i32>(std::floor(rect.x * _invCellSize));
+	minY = static_cast<i32>(std::floor(rect.y * _invCellSize));
+	maxX = static_cast<i32>(std::floor((rect.x + rect.w) * _invCellSize));
+	maxY = static_cast<i32>(std::floor((rect.y + rect.h) * _invCellSize));
+}
+
+template <typename F>
+void SpatialIndex::visit(const Rect &rect, F &&test, std::vector<NodeID> &result) {
+	if (_entries.empty())
+		return;
+
+	if (++_mark == 0) {
+		for (Entry &entry : _entries)
+			entry.mark = 0;
+		_mark = 1;
+	}
+
+	auto check = [&](u32 index) {
+		Entry &entry = _entries[index];
+		if (entry.mark == _mark)
+			return;
+		entry.mark = _mark;
+
+		if (test(entry.bounds))
+			result.push_back(entry.id);
+	};
+
+	for (u32 index : _large)
+		check(index);
+
+	i32 minX, minY, maxX, maxY;
+	cellRange(rect, minX, minY, maxX, maxY);
+
+	// Huge query areas are cheaper as a linear scan than as a walk over mostly empty cells
+	i64 cellCount = (static_cast<i64>(maxX) - minX + 1) * (static_cast<i64>(maxY) - minY + 1);
+	if (cellCount > static_cast<i64>(_cells.size())) {
+		for (auto &[key, items] : _cells) {
+			i32 x = static_cast<i32>(key >> 32);
+			i32 y = static_cast<i32>(key & 0xFFFFFFFF);
+			if (x < minX || x > maxX || y < minY || y > maxY)
+				continue;
+
+			for (u32 index : items)
+				check(index);
+		}
+		return;
+	}
+
+	for (i32 y = minY; y <= maxY; y++) {
+		for (i32 x = minX; x <= maxX; x++) {
+			auto cell = _cells.find(cellKey(x, y));
+			if (cell == _cells.end())
+				continue;
+
+			for (u32 index : cell->second)
+				check(index);
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,71 @@
+#ifndef SPATIAL_INDEX_HPP
+#define SPATIAL_INDEX_HPP
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+#include "glm/glm.hpp"
+
+#include "math/rect.hpp"
+#include "math/vector2.hpp"
+#include "sowa.hpp"
+
+// Hashed uniform grid of world space bounding boxes, keyed by node id
+class SpatialIndex {
+  public:
+	SpatialIndex(float cellSize = 256.f);
+
+	// Inserts or moves an entry. Cells are only touched when the covered cell range changes
+	void Update(NodeID id, const Rect &bounds);
+	void Remove(NodeID id);
+	void Clear();
+
+	bool Has(NodeID id) const;
+	size_t Size() const;
+
+	// Results are appended to result, each id at most once per query
+	void QueryRect(const Rect &rect, std::vector<NodeID> &result);
+	void QueryPoint(const Vector2 &point, std::vector<NodeID> &result);
+	void QueryRadius(const Vector2 &center, float radius, std::vector<NodeID> &result);
+
+	float GetCellSize() const;
+	void SetCellSize(float cellSize);
+
+	// Axis aligned bounds of local rect after transform
+	static Rect TransformBounds(const glm::mat4 &transform, const Rect &local);
+
+  private:
+	struct Entry {
+		NodeID id = 0;
+		Rect bounds;
+		i32 minX = 0, minY = 0, maxX = 0, maxY = 0;
+		bool large = false;
+		u32 mark = 0;
+	};
+
+	void insertCells(u32 index);
+	void removeCells(u32 index);
+	void cellRange(const Rect &rect, i32 &minX, i32 &minY, i32 &maxX, i32 &maxY) const;
+
+	template <typename F>
+	void visit(const Rect &rect, F &&test, std::vector<NodeID> &result);
+
+	static inline u64 cellKey(i32 x, i32 y) {
+		return (static_cast<u64>(static_cast<u32>(x)) << 32) | static_cast<u32>(y);
+	}
+
+	float _cellSize;
+	float _invCellSize;
+
+	std::vector<Entry> _entries;
+	std::unordered_map<NodeID, u32> _lookup;
+	std::unordered_map<u64, std::vector<u32>> _cells;
+
+	// Entries covering too many cells are kept out of the grid and tested directly
+	std::vector<u32> _large;
+
+	u32 _mark = 0;
+};
+
+#endif // SPATIAL_INDEX_HPP
\ No newline at end of file
@@ -1,9 +1,12 @@
 #include "audio_server.hpp"
 
+#include <algorithm>
+
 #include "AL/al.h"
 #include "AL/alc.h"
 
 #include "core/debug.hpp"
+#include "resource/audio_stream.hpp"
 
 AudioServer::AudioServer() {
 	_pDevice = alcOpenDevice(NULL);
@@ -27,4 +30,21 @@ AudioServer::AudioServer() {
 AudioServer::~AudioServer() {
 	alcDestroyContext(_pContext);
 	alcCloseDevice(_pDevice);
+}
+
+void AudioServer::Update() {
+	// Finished playbacks drop out, they join again when played
+	_playbacks.erase(std::remove_if(_playbacks.begin(), _playbacks.end(), [](AudioStreamPlayback *playback) {
+						 return !playback->update();
+					 }),
+					 _playbacks.end());
+}
+
+void AudioServer::addPlayback(AudioStreamPlayback *playback) {
+	if (std::find(_playbacks.begin(), _playbacks.end(), playback) == _playbacks.end())
+		_playbacks.push_back(playback);
+}
+
+void AudioServer::removePlayback(AudioStreamPlayback *playback) {
+	_playbacks.erase(std::remove(_playbacks.begin(), _playbacks.end(), playback), _playbacks.end());
 }
\ No newline at end of file
@@ -2,19 +2,31 @@
 #define AUDIO_SERVER_HPP
 #pragma once
 
+#include <vector>
+
 class ALCdevice;
 class ALCcontext;
+class AudioStreamPlayback;
 
 class AudioServer {
   public:
+	// Keeps streamed playbacks fed, Application::Update calls it once a frame
+	void Update();
+
   private:
 	friend class Application;
+	friend class AudioStreamPlayback;
 
 	AudioServer();
 	~AudioServer();
 
+	void addPlayback(AudioStreamPlayback *playback);
+	void removePlayback(AudioStreamPlayback *playback);
+
 	ALCdevice *_pDevice = nullptr;
 	ALCcontext *_pContext = nullptr;
+
+	std::vector<AudioStreamPlayback *> _playbacks;
 };
 
 #endif // AUDIO_SERVER_HPP
\ No newline at end of file
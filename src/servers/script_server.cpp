@@ -7,11 +7,13 @@
 #include "core/debug.hpp"
 #include "core/timer.hpp"
 #include "math/math.hpp"
+#include "resource/prefab.hpp"
 #include "utils/store.hpp"
 
 #include "scene/node.hpp"
 #include "scene/node/animatedsprite2d.hpp"
 #include "scene/node/audiostreamplayer.hpp"
+#include "scene/node/camera2d.hpp"
 #include "scene/node/node2d.hpp"
 #include "scene/node/progress_bar.hpp"
 #include "scene/node/sprite2d.hpp"
@@ -78,6 +80,111 @@ static luabridge::LuaRef Lua_GetChild(Node *node, size_t index, lua_State *L) {
 	return ref;
 }
 
+static luabridge::LuaRef Lua_NodeList(Scene *scene, const std::vector<NodeID> &ids, lua_State *L) {
+	luabridge::LuaRef list = luabridge::newTable(L);
+
+	int index = 1;
+	for (NodeID id : ids) {
+		Node *node = scene->GetNode(id);
+		if (!node)
+			continue;
+
+		auto ref = luabridge::LuaRef(L, node);
+		ref.push(L);
+		AssignNodeMetatable(L, node);
+		lua_pop(L, 1);
+
+		list[index++] = ref;
+	}
+
+	return list;
+}
+
+static luabridge::LuaRef Lua_QueryRect(Scene *scene, const Rect &rect, lua_State *L) {
+	std::vector<NodeID> ids;
+	scene->GetSpatialIndex().QueryRect(rect, ids);
+	return Lua_NodeList(scene, ids, L);
+}
+
+static luabridge::LuaRef Lua_QueryPoint(Scene *scene, const Vector2 &point, lua_State *L) {
+	std::vector<NodeID> ids;
+	scene->GetSpatialIndex().QueryPoint(point, ids);
+	return Lua_NodeList(scene, ids, L);
+}
+
+static luabridge::LuaRef Lua_QueryRadius(Scene *scene, const Vector2 &center, float radius, lua_State *L) {
+	std::vector<NodeID> ids;
+	scene->GetSpatialIndex().QueryRadius(center, radius, ids);
+	return Lua_NodeList(scene, ids, L);
+}
+
+static luabridge::LuaRef Lua_Instantiate(Scene *scene, RID rid, size_t count, Node *parent, lua_State *L) {
+	Prefab *prefab = App().GetResourceRegistry().GetResource<Prefab>(rid);
+	if (!prefab) {
+		Debug::Error("Instantiate: resource {} is not a prefab", rid);
+		return luabridge::newTable(L);
+	}
+
+	std::vector<Node *> roots = scene->Instantiate(*prefab, count, parent);
+
+	luabridge::LuaRef list = luabridge::newTable(L);
+	for (size_t i = 0; i < roots.size(); i++) {
+		auto ref = luabridge::LuaRef(L, roots[i]);
+		ref.push(L);
+		AssignNodeMetatable(L, roots[i]);
+		lua_pop(L, 1);
+
+		list[i + 1] = ref;
+	}
+	return list;
+}
+
+template <typename T, typename V>
+static void Lua_AddNodeProperty(luabridge::Namespace::Class<T> &cls, const NodeProperty *prop) {
+	cls.addProperty(
+		prop->scriptName,
+		[prop](const T *node) -> V { return prop->Ref<V>(node); },
+		[prop](T *node, V value) {
+			prop->Ref<V>(node) = value;
+			node->MarkDirty();
+		});
+}
+
+// Binds the properties a node class declares in its table, bases register their own. Takes the class being opened and
+// returns it for endClass
+template <typename T>
+static luabridge::Namespace::Class<T> &Lua_AddNodeProperties(luabridge::Namespace::Class<T> &&cls) {
+	for (const NodeProperty &prop : T::Properties) {
+		if (!prop.Has(PropertyFlags_Script))
+			continue;
+
+		switch (prop.type) {
+		case PropertyType::Bool:
+			Lua_AddNodeProperty<T, bool>(cls, &prop);
+			break;
+		case PropertyType::Int:
+			Lua_AddNodeProperty<T, i32>(cls, &prop);
+			break;
+		case PropertyType::Float:
+			Lua_AddNodeProperty<T, f32>(cls, &prop);
+			break;
+		case PropertyType::String:
+			Lua_AddNodeProperty<T, std::string>(cls, &prop);
+			break;
+		case PropertyType::Vec2:
+			Lua_AddNodeProperty<T, Vector2>(cls, &prop);
+			break;
+		case PropertyType::Color:
+			Lua_AddNodeProperty<T, Color>(cls, &prop);
+			break;
+		case PropertyType::U64:
+		case PropertyType::StringList:
+			break;
+		}
+	}
+	return cls;
+}
+
 static int Lua_DebugPrint(lua_State *L, Debug::LogSeverity severity) {
 	int count = lua_gettop(L);
 
@@ -133,9 +240,14 @@ int ScriptServer::PushModule(const char *path) {
 		return 1;
 	}
 
-	std::string mod{reinterpret_cast<char *>(file->Buffer().data()), file->Buffer().size()};
+	if (_modules.insert(path).second) {
+		std::string modulePath = path;
+		if (u32 watch = App().GetHotReload().Watch(modulePath, "Module", [this, modulePath]() { return reloadModule(modulePath); }))
+			_watches.push_back(watch);
+	}
 
-	if (luaL_loadbuffer(state, mod.c_str(), mod.size(), path)) {
+	std::string_view mod = file->View();
+	if (luaL_loadbuffer(state, mod.data(), mod.size(), path)) {
 		Debug::Error("Failed to run module: {}", path);
 		lua_pop(state, 1);
 
@@ -153,6 +265,12 @@ void ScriptServer::Init() {
 	_startFuncs.clear();
 	_updateFuncs.clear();
 
+	for (u32 watch : _watches)
+		App().GetHotReload().Unwatch(watch);
+	_watches.clear();
+	_scripts.clear();
+	_modules.clear();
+
 	luaL_openlibs(state);
 
 	lua_register(state, "module_loader", ModuleLoader);
@@ -211,6 +329,17 @@ void ScriptServer::Init() {
 		.addFunction("Randomize", Utils::Randomize)
 		.addFunction("RandRange", Utils::RandRange)
 		.addFunction("RandRangeFloat", Utils::RandRangeFloat)
+		.addFunction("Seed", +[](i64 seed) { Utils::Seed(static_cast<u64>(seed)); })
+		.addFunction("GetSeed", +[]() { return static_cast<i64>(Utils::GetSeed()); })
+		.addFunction("GetRandomStream", +[](const std::string &name) { return &Utils::GetRandomStream(name); })
+		.beginClass<RandomNumberGenerator>("RandomStream")
+		.addFunction("Rand", +[](RandomNumberGenerator *rng) { return static_cast<i32>(rng->U32() >> 1); })
+		.addFunction("RandRange", &RandomNumberGenerator::Range)
+		.addFunction("RandFloat", &RandomNumberGenerator::Float)
+		.addFunction("RandRangeFloat", &RandomNumberGenerator::RangeFloat)
+		.addFunction("Seed", +[](RandomNumberGenerator *rng, i64 seed) { rng->Seed(static_cast<u64>(seed)); })
+		.addFunction("GetSeed", +[](RandomNumberGenerator *rng) { return static_cast<i64>(rng->GetSeed()); })
+		.endClass()
 		.endNamespace();
 
 	getGlobalNamespace(state)
@@ -227,6 +356,7 @@ void ScriptServer::Init() {
 
 	getGlobalNamespace(state)
 		.addFunction("GetScene", +[]() { return App().GetCurrentScene().get(); })
+		.addFunction("ChangeScene", +[](const std::string &path) { return App().LoadSceneAsync(path.c_str()).get(); })
 		.addFunction("GlobalStore", +[]() { return App().GetGlobalStore(); })
 
 		.beginClass<StringStore>("StringStore")
@@ -283,32 +413,18 @@ void ScriptServer::Init() {
 
 		.deriveClass<Node2D, Node>("Node2D")
 		.addFunction("GetGlobalPosition", &Node2D::GetGlobalPosition)
-		.addProperty("position", &Node2D::_position)
-		.addProperty("rotation", &Node2D::_rotation)
-		.addProperty("scale", &Node2D::_scale)
-		.addProperty("z_index", &Node2D::_zIndex)
-		.addProperty("visible", &Node2D::_visible)
 		.endClass()
 
 		.deriveClass<Sprite2D, Node2D>("Sprite2D")
-		.addProperty("texture", &Sprite2D::_texture)
-		.addProperty("modulate", &Sprite2D::_modulate)
 		.endClass()
 
 		.deriveClass<Text2D, Node2D>("Text2D")
-		.addProperty("text", &Text2D::_text)
-		.addProperty("modulate", &Text2D::_modulate)
-		.addProperty("font", &Text2D::_font)
 		.endClass()
 
 		.deriveClass<Camera2D, Node2D>("Camera2D")
-		.addProperty("offset", &Camera2D::_offset)
-		.addProperty("rotatable", &Camera2D::_rotatable)
 		.endClass()
 
 		.deriveClass<AnimatedSprite2D, Node2D>("AnimatedSprite2D")
-		.addProperty("animation_scale", &AnimatedSprite2D::_animationScale)
-		.addProperty("playing", &AnimatedSprite2D::_playing)
 		.addFunction("SetCurrentAnimation", &AnimatedSprite2D::SetCurrentAnimation, +[](AnimatedSprite2D *node, const std::string &name) { node->SetCurrentAnimation(name, true); })
 		.addFunction("GetCurrentAnimation", &AnimatedSprite2D::GetCurrentAnimation)
 		.addFunction("RestartAnimation", &AnimatedSprite2D::RestartAnimation)
@@ -320,26 +436,29 @@ void ScriptServer::Init() {
 		.addFunction("Stop", &AudioStreamPlayer::Stop)
 		.addFunction("IsPlaying", &AudioStreamPlayer::IsPlaying)
 		.addFunction("IsPaused", &AudioStreamPlayer::IsPaused)
-		.addProperty("stream", &AudioStreamPlayer::_stream)
-		.addProperty("autoplay", &AudioStreamPlayer::_autoplay)
-		.addProperty("loop", &AudioStreamPlayer::_loop)
-		.addProperty("pitch", &AudioStreamPlayer::_pitch)
-		.addProperty("gain", &AudioStreamPlayer::_gain)
 		.endClass()
 
 		.deriveClass<ProgressBar, Node2D>("ProgressBar")
-		.addProperty("min_value", &ProgressBar::_minValue)
-		.addProperty("max_value", &ProgressBar::_maxValue)
-		.addProperty("value", &ProgressBar::_value)
-		.addProperty("size", &ProgressBar::_size)
-		.addProperty("padding", &ProgressBar::_padding)
-		.addProperty("foreground_color", &ProgressBar::_foregroundColor)
-		.addProperty("background_color", &ProgressBar::_backgroundColor)
 		.endClass()
 
 		.beginClass<Scene>("Scene")
 		.addFunction("GetRoot", Lua_GetRoot)
+		.addFunction("QueryRect", Lua_QueryRect)
+		.addFunction("QueryPoint", Lua_QueryPoint)
+		.addFunction("QueryRadius", Lua_QueryRadius)
+		.addFunction("Instantiate", Lua_Instantiate, +[](Scene *scene, RID rid, size_t count, lua_State *L) { return Lua_Instantiate(scene, rid, count, nullptr, L); })
+		.addFunction("IsLoading", &Scene::IsLoading)
+		.addFunction("GetLoadProgress", &Scene::GetLoadProgress)
 		.endClass();
+
+	// Node properties come from the tables registered with NodeDB
+	Lua_AddNodeProperties(getGlobalNamespace(state).beginClass<Node2D>("Node2D")).endClass();
+	Lua_AddNodeProperties(getGlobalNamespace(state).beginClass<Sprite2D>("Sprite2D")).endClass();
+	Lua_AddNodeProperties(getGlobalNamespace(state).beginClass<Text2D>("Text2D")).endClass();
+	Lua_AddNodeProperties(getGlobalNamespace(state).beginClass<Camera2D>("Camera2D")).endClass();
+	Lua_AddNodeProperties(getGlobalNamespace(state).beginClass<AnimatedSprite2D>("AnimatedSprite2D")).endClass();
+	Lua_AddNodeProperties(getGlobalNamespace(state).beginClass<AudioStreamPlayer>("AudioStreamPlayer")).endClass();
+	Lua_AddNodeProperties(getGlobalNamespace(state).beginClass<ProgressBar>("ProgressBar")).endClass();
 }
 
 void ScriptServer::CallStart() {
@@ -361,30 +480,94 @@ void ScriptServer::CallUpdate() {
 }
 
 void ScriptServer::LoadScript(const char *path) {
-	auto file = App().FS().Load(path);
-	if (!file) {
-		Debug::Error("Failed to load script file at '{}'", path);
+	// Reload callbacks keep the index, _scripts only shrinks when Init unwatches them all
+	size_t index = _scripts.size();
+	_scripts.push_back(LoadedScript{path});
+	runScript(_scripts.back());
+
+	if (u32 watch = App().GetHotReload().Watch(path, "Script", [this, index]() { return runScript(_scripts[index]); }))
+		_watches.push_back(watch);
+}
+
+// Functions are taken out of the globals so the next script can define its own, running the script again replaces
+// the ones it defined before
+static void TakeFunction(lua_State *state, const char *name, std::vector<int> &funcs, i32 &index) {
+	lua_getglobal(state, name);
+	if (!lua_isfunction(state, -1)) {
+		lua_pop(state, 1);
 		return;
 	}
 
-	std::string str{reinterpret_cast<char *>(file->Data()), file->Size()};
-	if (luaL_dostring(state, str.c_str()) != LUA_OK) {
+	int ref = luaL_ref(state, LUA_REGISTRYINDEX);
+	if (index < 0) {
+		index = static_cast<i32>(funcs.size());
+		funcs.push_back(ref);
+	} else {
+		luaL_unref(state, LUA_REGISTRYINDEX, funcs[index]);
+		funcs[index] = ref;
+	}
+
+	lua_pushnil(state);
+	lua_setglobal(state, name);
+}
+
+bool ScriptServer::runScript(LoadedScript &script) {
+	auto file = App().FS().Load(script.path);
+	if (!file) {
+		Debug::Error("Failed to load script file at '{}'", script.path);
+		return false;
+	}
+
+	std::string_view source = file->View();
+	if (luaL_loadbuffer(state, source.data(), source.size(), script.path.c_str()) != LUA_OK || lua_pcall(state, 0, 0, 0) != LUA_OK) {
 		Debug::Error("Lua load error: {}", lua_tostring(state, -1));
+		lua_pop(state, 1);
+		return false;
 	}
 
-	lua_getglobal(state, "Start");
-	if (lua_isfunction(state, -1)) {
-		_startFuncs.push_back(luaL_ref(state, LUA_REGISTRYINDEX));
+	TakeFunction(state, "Start", _startFuncs, script.start);
+	TakeFunction(state, "Update", _updateFuncs, script.update);
+	return true;
+}
 
-		lua_pushnil(state);
-		lua_setglobal(state, "Start");
+bool ScriptServer::reloadModule(const std::string &path) {
+	Ref<FileData> file = App().FS().Load(path);
+	if (!file)
+		return false;
+
+	std::string_view source = file->View();
+	// require passes the module name to the chunk
+	if (luaL_loadbuffer(state, source.data(), source.size(), path.c_str()) != LUA_OK) {
+		Debug::Error("Failed to run module: {}", path);
+		lua_pop(state, 1);
+		return false;
+	}
+	lua_pushstring(state, path.c_str());
+	if (lua_pcall(state, 1, 1, 0) != LUA_OK) {
+		Debug::Error("Lua module error: {}", lua_tostring(state, -1));
+		lua_pop(state, 1);
+		return false;
 	}
 
-	lua_getglobal(state, "Update");
-	if (lua_isfunction(state, -1)) {
-		_updateFuncs.push_back(luaL_ref(state, LUA_REGISTRYINDEX));
+	int module = lua_gettop(state);
+	lua_getglobal(state, "package");
+	lua_getfield(state, -1, "loaded");
+	int loaded = lua_gettop(state);
+	lua_getfield(state, loaded, path.c_str());
+	int old = lua_gettop(state);
 
+	if (lua_istable(state, old) && lua_istable(state, module)) {
 		lua_pushnil(state);
-		lua_setglobal(state, "Update");
+		while (lua_next(state, module) != 0) {
+			lua_pushvalue(state, -2);
+			lua_insert(state, -2);
+			lua_settable(state, old);
+		}
+	} else if (!lua_isnil(state, module)) {
+		lua_pushvalue(state, module);
+		lua_setfield(state, loaded, path.c_str());
 	}
+
+	lua_settop(state, module - 1);
+	return true;
 }
\ No newline at end of file
@@ -2,8 +2,12 @@
 #define SCRIPT_SERVER_HPP
 #pragma once
 
+#include <string>
+#include <unordered_set>
 #include <vector>
 
+#include "sowa.hpp"
+
 extern "C" {
 #include <lauxlib.h>
 #include <lua.h>
@@ -17,16 +21,33 @@ class ScriptServer {
 	void CallStart();
 	void CallUpdate();
 
+	// Scripts and modules are executed again when they change on disk, keeping the rest of the Lua state
 	void LoadScript(const char *path);
 
 	int PushModule(const char* path);
 
   private:
+	struct LoadedScript {
+		std::string path;
+		// Index in _startFuncs and _updateFuncs, -1 if the script has none
+		i32 start = -1;
+		i32 update = -1;
+	};
+
+	bool runScript(LoadedScript &script);
+	// Copies the fields of the module's new table into the one require already returned
+	bool reloadModule(const std::string &path);
+
 	lua_State *state = nullptr;
 
 	// reference in LUA_REGISTRYINDEX
 	std::vector<int> _startFuncs;
 	std::vector<int> _updateFuncs;
+
+	std::vector<LoadedScript> _scripts;
+	std::unordered_set<std::string> _modules;
+	// Hot reload ids of the scripts and modules of this state
+	std::vector<u32> _watches;
 };
 
 #endif // SCRIPT_SERVER_HPP
\ No newline at end of file
@@ -1,33 +1,71 @@
 #include "random.hpp"
 
-#include <ctime>
+#include <memory>
 #include <random>
+#include <unordered_map>
+
+static u64 s_seed = 0;
+
+static u64 StreamSeed(const std::string &name) {
+	// FNV-1a of the name, mixed with the global seed
+	u64 hash = 0xcbf29ce484222325;
+	for (char c : name) {
+		hash ^= static_cast<u8>(c);
+		hash *= 0x100000001b3;
+	}
+	return hash ^ (s_seed * 0x9e3779b97f4a7c15);
+}
+
+static std::unordered_map<std::string, std::unique_ptr<RandomNumberGenerator>> &Streams() {
+	static std::unordered_map<std::string, std::unique_ptr<RandomNumberGenerator>> streams;
+	return streams;
+}
+
+static RandomNumberGenerator &DefaultStream() {
+	static RandomNumberGenerator &stream = Utils::GetRandomStream("default");
+	return stream;
+}
+
+void Utils::Seed(u64 seed) {
+	s_seed = seed;
+	for (auto &[name, stream] : Streams()) {
+		stream->Seed(StreamSeed(name));
+	}
+}
+
+u64 Utils::GetSeed() {
+	return s_seed;
+}
 
 void Utils::Randomize() {
-	srand(static_cast<unsigned>(time(NULL)));
+	std::random_device device;
+	Seed((static_cast<u64>(device()) << 32) | device());
+}
+
+RandomNumberGenerator &Utils::GetRandomStream(const std::string &name) {
+	auto &streams = Streams();
+	if (auto it = streams.find(name); it != streams.end())
+		return *it->second;
+
+	return *streams.emplace(name, std::make_unique<RandomNumberGenerator>(StreamSeed(name))).first->second;
 }
 
 int Utils::Rand() {
-	return rand();
+	return static_cast<int>(DefaultStream().U32() >> 1);
 }
 
 int Utils::RandRange(int min, int max) {
-	if (min == max)
-		return max;
-
-	if (max < min)
-		std::swap(min, max);
-
-	return min + (Rand() % (max - min));
+	return DefaultStream().Range(min, max);
 }
 
 float Utils::RandFloat() {
-	return static_cast<float>(Rand()) / static_cast<float>(RAND_MAX);
+	return DefaultStream().Float();
 }
 
 float Utils::RandRangeFloat(float min, float max) {
-	if (max < min)
-		std::swap(min, max);
+	return DefaultStream().RangeFloat(min, max);
+}
 
-	return min + (RandFloat() * (max - min));
+void Utils::RandFill(float *out, size_t count, float min, float max) {
+	DefaultStream().FillFloat(out, count, min, max);
 }
\ No newline at end of file
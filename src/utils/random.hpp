@@ -2,14 +2,28 @@
 #define RANDOM_HPP
 #pragma once
 
+#include <string>
+
+#include "data/random_number_generator.hpp"
+#include "sowa.hpp"
+
 namespace Utils {
+// Reseeds every stream from a single seed. Same seed gives the same sequences on every system
+void Seed(u64 seed);
+u64 GetSeed();
 void Randomize();
+
+// Independent stream for a subsystem, seeded from the global seed and its name
+RandomNumberGenerator &GetRandomStream(const std::string &name);
+
 int Rand();
 
 int RandRange(int min, int max);
 float RandFloat();
 float RandRangeFloat(float min, float max);
 
+void RandFill(float *out, size_t count, float min = 0.f, float max = 1.f);
+
 } // namespace Utils
 
 #endif // RANDOM_HPP
\ No newline at end of file
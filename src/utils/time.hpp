@@ -12,7 +12,8 @@ namespace Utils {
 inline std::string GetTime(const std::string &format = "%Y-%m-%d") {
 	std::stringstream date;
 	std::time_t t = std::time(nullptr);
-	std::tm tp = *std::localtime(&t);
+	std::tm tp{};
+	localtime_r(&t, &tp);
 	date << std::put_time(&tp, format.c_str());
 	return date.str();
 }
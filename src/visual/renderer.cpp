@@ -44,7 +44,7 @@ Renderer2D &Renderer::GetRenderer2D(const char *name) {
 
 void Renderer::BeginDraw() {
 	for (auto &[name, renderer] : _renderer2ds) {
-		renderer.Reset();
+		renderer.BeginFrame();
 	}
 }
 
@@ -15,7 +15,6 @@
 
 #define BATCH2D_MAX_RECT (1000)
 #define BATCH2D_MAX_VERTEX (BATCH2D_MAX_RECT * 6)
-#define BATCH2D_MAX_TEXTURE 16
 
 void Renderer2D::Init(const char *vertexPath, const char *fragmentPath) {
 	_projection = glm::ortho(0.f, 1280.f, 0.f, 720.f, -128.f, 128.f);
@@ -44,6 +43,12 @@ void Renderer2D::Init(const char *vertexPath, const char *fragmentPath) {
 	_blankTexture->LoadFromData(pixel, 1, 1);
 }
 
+void Renderer2D::BeginFrame() {
+	_lastFrameBatches = _batches;
+	_batches = 0;
+	Reset();
+}
+
 void Renderer2D::Reset() {
 	_vertices.clear();
 	_textures.clear();
@@ -206,6 +211,7 @@ void Renderer2D::End() {
 	glEnable(GL_DEPTH_TEST);
 	_vao.Bind();
 	glDrawArrays(GL_TRIANGLES, 0, _vertices.size());
+	_batches++;
 	_vao.Unbind();
 	glDisable(GL_DEPTH_TEST);
 
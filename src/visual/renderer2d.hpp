@@ -17,6 +17,9 @@
 
 #include "resource/font.hpp"
 
+// Textures one batch can bind, a batch is drawn once it uses this many
+#define BATCH2D_MAX_TEXTURE 16
+
 struct DefaultVertex2D {
 	float x = 0.f;
 	float y = 0.f;
@@ -49,9 +52,14 @@ class Renderer2D {
   public:
 	void Init(const char *vertexPath, const char *fragmentPath);
 
+	// Starts counting the batches of a new frame, then Reset
+	void BeginFrame();
 	void Reset();
 	void End();
 
+	// Draw calls of the previous frame
+	inline u32 GetBatchCount() const { return _lastFrameBatches; }
+
 	void PushQuad(DefaultVertex2D vertices[4]);
 	void PushQuad(float x, float y, float z, float w, float h, float r, float g, float b, float a, float drawID, float textureID);
 	void PushQuad(glm::mat4 transform, float textureID, glm::vec2 textureScale, float z = 0.f, Color color = Color{}, float drawID = 1.f);
@@ -74,6 +82,9 @@ class Renderer2D {
 	std::map<uint32_t, uint32_t> _textures;
 	uint32_t _textureCounter = 0;
 
+	u32 _batches = 0;
+	u32 _lastFrameBatches = 0;
+
 	std::unique_ptr<ImageTexture> _blankTexture;
 };
 
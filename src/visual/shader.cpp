@@ -37,56 +37,100 @@ static bool HandleLinkError(uint32_t id) {
 }
 
 Shader::~Shader() {
+	unwatch();
 	Delete();
 }
 
 void Shader::Load(const char *vertexPath, const char *fragmentPath) {
 	Delete();
+	unwatch();
+
+	_vertexPath = vertexPath;
+	_fragmentPath = fragmentPath;
+	_id = compile();
+
+	// Watched even when compiling failed, so fixing the source picks it up
+	_vertexWatch = App().GetHotReload().Watch(_vertexPath, "Shader", [this]() { return Reload(); });
+	_fragmentWatch = App().GetHotReload().Watch(_fragmentPath, "Shader", [this]() { return Reload(); });
+}
+
+bool Shader::Reload() {
+	uint32_t program = compile();
+	if (program == 0)
+		return false;
+
+	Delete();
+	_id = program;
+	return true;
+}
+
+uint32_t Shader::compile() {
+	const char *vertexPath = _vertexPath.c_str();
+	const char *fragmentPath = _fragmentPath.c_str();
 
 	Ref<FileData> vertexFile = App().FS().Load(vertexPath);
 	if (!vertexFile) {
 		Debug::Error("Failed to load vertex shader at {}", vertexPath);
-		return;
+		return 0;
 	}
 
 	Ref<FileData> fragmentFile = App().FS().Load(fragmentPath);
 	if (!fragmentFile) {
 		Debug::Error("Failed to load fragment shader at {}", fragmentPath);
-		return;
+		return 0;
 	}
 
-	std::string vertexSource{reinterpret_cast<char *>(vertexFile->Data()), vertexFile->Size()};
-	std::string fragmentSource{reinterpret_cast<char *>(fragmentFile->Data()), fragmentFile->Size()};
+	// Sources are passed with their lengths, straight from the file data
+	std::string_view vertexSource = vertexFile->View();
+	std::string_view fragmentSource = fragmentFile->View();
 
 	uint32_t vertexShader = glCreateShader(GL_VERTEX_SHADER);
-	const char *vertexSrc = vertexSource.c_str();
-	glShaderSource(vertexShader, 1, &vertexSrc, nullptr);
+	const char *vertexSrc = vertexSource.data();
+	GLint vertexLength = static_cast<GLint>(vertexSource.size());
+	glShaderSource(vertexShader, 1, &vertexSrc, &vertexLength);
 	glCompileShader(vertexShader);
 	if (!HandleCompileError(vertexShader, "vertex")) {
 		Debug::Error("Failed to load shader: {}", vertexPath);
-		return;
+		glDeleteShader(vertexShader);
+		return 0;
 	}
 
 	uint32_t fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-	const char *fragmentSrc = fragmentSource.c_str();
-	glShaderSource(fragmentShader, 1, &fragmentSrc, nullptr);
+	const char *fragmentSrc = fragmentSource.data();
+	GLint fragmentLength = static_cast<GLint>(fragmentSource.size());
+	glShaderSource(fragmentShader, 1, &fragmentSrc, &fragmentLength);
 	glCompileShader(fragmentShader);
 	if (!HandleCompileError(fragmentShader, "fragment")) {
 		Debug::Error("Failed to load shader: {}", fragmentPath);
-		return;
+		glDeleteShader(vertexShader);
+		glDeleteShader(fragmentShader);
+		return 0;
 	}
 
-	_id = glCreateProgram();
-	glAttachShader(_id, vertexShader);
-	glAttachShader(_id, fragmentShader);
+	uint32_t program = glCreateProgram();
+	glAttachShader(program, vertexShader);
+	glAttachShader(program, fragmentShader);
 
-	glLinkProgram(_id);
-	if (!HandleLinkError(_id)) {
+	glLinkProgram(program);
+	// The program keeps what it linked, the shader objects are only needed until then
+	glDeleteShader(vertexShader);
+	glDeleteShader(fragmentShader);
+	if (!HandleLinkError(program)) {
 		Debug::Error("Failed to link shader: {}, {}", vertexPath, fragmentPath);
-		return;
+		glDeleteProgram(program);
+		return 0;
 	}
 
-	return;
+	return program;
+}
+
+void Shader::unwatch() {
+	if (_vertexWatch != 0)
+		App().GetHotReload().Unwatch(_vertexWatch);
+	if (_fragmentWatch != 0)
+		App().GetHotReload().Unwatch(_fragmentWatch);
+	_vertexWatch = 0;
+	_fragmentWatch = 0;
 }
 
 void Shader::Delete() {
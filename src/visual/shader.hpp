@@ -12,7 +12,10 @@ class Shader {
 	Shader() = default;
 	~Shader();
 
+	// Sources under a folder are recompiled whenever they change on disk
 	void Load(const char *vertexPath, const char* fragmentPath);
+	// Compiles the sources again, the current program stays in use if they fail to compile or link
+	bool Reload();
 
 	void Delete();
 
@@ -26,9 +29,17 @@ class Shader {
 	inline uint32_t ID() { return _id; }
 
   private:
+	// Returns the linked program, or 0
+	uint32_t compile();
+	void unwatch();
+
 	uint32_t _id = 0;
-	std::string _vertexSource = "";
-	std::string _fragmentSource = "";
+	std::string _vertexPath = "";
+	std::string _fragmentPath = "";
+
+	// Hot reload ids, 0 when not watched
+	uint32_t _vertexWatch = 0;
+	uint32_t _fragmentWatch = 0;
 };
 
 #endif // SHADER_HPP
\ No newline at end of file
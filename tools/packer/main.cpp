@@ -0,0 +1,108 @@
+// Packs a folder into a .spak archive that the engine serves under its res:// scheme
+//
+//   sowa-packer [--compress] <folder> <output>
+//
+// With --compress, entries are LZ4 compressed unless the format is already compressed or compressing does not shrink
+// them. Uncompressed entries are read straight from the mapped pack at runtime
+
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "core/filesystem/pack.hpp"
+
+static bool ReadFile(const std::filesystem::path &path, std::vector<std::byte> &out) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file.good())
+		return false;
+
+	std::vector<char> chars{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+	out.resize(chars.size());
+	std::memcpy(out.data(), chars.data(), chars.size());
+	return true;
+}
+
+static bool WriteFile(const char *path, const void *data, size_t size) {
+	std::ofstream file(path, std::ios::binary);
+	if (!file.good())
+		return false;
+
+	file.write(reinterpret_cast<const char *>(data), size);
+	return file.good();
+}
+
+// Formats that gain nothing from another compression pass
+static bool IsCompressedFormat(const std::filesystem::path &path) {
+	static const char *const extensions[] = {".png", ".jpg", ".jpeg", ".ogg", ".mp3", ".flac", ".spak"};
+	std::string extension = path.extension().string();
+	for (const char *compressed : extensions) {
+		if (extension == compressed)
+			return true;
+	}
+	return false;
+}
+
+static int PackFolder(const char *folder, const char *output, bool compress) {
+	auto start = std::chrono::steady_clock::now();
+
+	std::error_code ec;
+	if (!std::filesystem::is_directory(folder, ec)) {
+		std::cerr << "'" << folder << "' is not a folder" << std::endl;
+		return 1;
+	}
+
+	std::vector<Pack::Input> inputs;
+	size_t totalSize = 0;
+	for (const auto &entry : std::filesystem::recursive_directory_iterator(folder)) {
+		if (!entry.is_regular_file())
+			continue;
+
+		Pack::Input &input = inputs.emplace_back();
+		input.path = std::filesystem::relative(entry.path(), folder).generic_string();
+		input.compression = compress && !IsCompressedFormat(entry.path()) ? Pack::Compression::LZ4 : Pack::Compression::None;
+		if (!ReadFile(entry.path(), input.data)) {
+			std::cerr << "Failed to read '" << entry.path().string() << "'" << std::endl;
+			return 1;
+		}
+		totalSize += input.data.size();
+	}
+
+	std::vector<std::byte> pack;
+	std::string error;
+	if (!Pack::Build(inputs, pack, error)) {
+		std::cerr << "Failed to pack '" << folder << "': " << error << std::endl;
+		return 1;
+	}
+
+	if (!WriteFile(output, pack.data(), pack.size())) {
+		std::cerr << "Failed to write '" << output << "'" << std::endl;
+		return 1;
+	}
+
+	size_t compressed = 0;
+	for (const Pack::Input &input : inputs) {
+		if (input.compression != Pack::Compression::None)
+			compressed++;
+	}
+
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	std::cout << folder << " -> " << output << ": " << inputs.size() << " files (" << compressed << " compressed), "
+			  << totalSize << " -> " << pack.size() << " bytes in " << elapsed.count() << " ms" << std::endl;
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	if (argc == 4 && std::strcmp(argv[1], "--compress") == 0)
+		return PackFolder(argv[2], argv[3], true);
+
+	if (argc == 3)
+		return PackFolder(argv[1], argv[2], false);
+
+	std::cerr << "Usage: " << argv[0] << " [--compress] <folder> <output>" << std::endl;
+	return 1;
+}
\ No newline at end of file
@@ -0,0 +1,232 @@
+// Converts scenes between YAML (.sscn) and binary (.sscnb), measures how long each takes to load and times the spatial
+// index scenes keep their 2D nodes in
+//
+//   sowa-scene-converter <input> <output>
+//   sowa-scene-converter --bench <scene> [iterations]
+//   sowa-scene-converter --bench-index [nodes] [frames]
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "core/serialize/binary_scene.hpp"
+#include "core/serialize/document.hpp"
+#include "scene/spatial_index.hpp"
+#include "yaml-cpp/yaml.h"
+
+static bool ReadFile(const char *path, std::vector<std::byte> &out) {
+	std::ifstream file(path, std::ios::binary);
+	if (!file.good())
+		return false;
+
+	std::vector<char> chars{std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+	out.resize(chars.size());
+	std::memcpy(out.data(), chars.data(), chars.size());
+	return true;
+}
+
+static bool WriteFile(const char *path, const void *data, size_t size) {
+	std::ofstream file(path, std::ios::binary);
+	if (!file.good())
+		return false;
+
+	file.write(reinterpret_cast<const char *>(data), size);
+	return file.good();
+}
+
+static bool LoadDocument(const std::vector<std::byte> &data, YAML::Node &doc, std::string &error) {
+	if (BinaryScene::IsBinaryScene(data.data(), data.size()))
+		return BinaryScene::Decode(data.data(), data.size(), doc, error);
+
+	try {
+		doc = YAML::Load(std::string(reinterpret_cast<const char *>(data.data()), data.size()));
+	} catch (const YAML::Exception &e) {
+		error = e.what();
+		return false;
+	}
+	return true;
+}
+
+static int Convert(const char *input, const char *output) {
+	std::vector<std::byte> data;
+	if (!ReadFile(input, data)) {
+		std::cerr << "Failed to read '" << input << "'" << std::endl;
+		return 1;
+	}
+
+	YAML::Node doc;
+	std::string error;
+	if (!LoadDocument(data, doc, error)) {
+		std::cerr << "Failed to load '" << input << "': " << error << std::endl;
+		return 1;
+	}
+
+	bool binary = std::strlen(output) > 6 && std::strcmp(output + std::strlen(output) - 6, ".sscnb") == 0;
+	if (binary) {
+		std::vector<std::byte> bytes;
+		if (!BinaryScene::Encode(doc, bytes, error)) {
+			std::cerr << "Failed to encode '" << input << "': " << error << std::endl;
+			return 1;
+		}
+		if (!WriteFile(output, bytes.data(), bytes.size())) {
+			std::cerr << "Failed to write '" << output << "'" << std::endl;
+			return 1;
+		}
+	} else {
+		YAML::Emitter emitter;
+		EmitYAML(emitter, doc);
+		if (!WriteFile(output, emitter.c_str(), emitter.size())) {
+			std::cerr << "Failed to write '" << output << "'" << std::endl;
+			return 1;
+		}
+	}
+
+	std::cout << input << " -> " << output << std::endl;
+	return 0;
+}
+
+template <typename F>
+static double Measure(int iterations, F &&fn) {
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < iterations; i++)
+		fn();
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+	return elapsed.count() / iterations;
+}
+
+// Times parsing the same scene as YAML and as binary. Binary is timed both reading the tables alone and loading every property document
+static int Bench(const char *input, int iterations) {
+	std::vector<std::byte> data;
+	if (!ReadFile(input, data)) {
+		std::cerr << "Failed to read '" << input << "'" << std::endl;
+		return 1;
+	}
+
+	YAML::Node doc;
+	std::string error;
+	if (!LoadDocument(data, doc, error)) {
+		std::cerr << "Failed to load '" << input << "': " << error << std::endl;
+		return 1;
+	}
+
+	YAML::Emitter emitter;
+	emitter << doc;
+	std::string yaml = emitter.c_str();
+
+	std::vector<std::byte> binary;
+	if (!BinaryScene::Encode(doc, binary, error)) {
+		std::cerr << "Failed to encode '" << input << "': " << error << std::endl;
+		return 1;
+	}
+
+	BinaryScene::Reader reader;
+	if (!reader.Open(binary.data(), binary.size())) {
+		std::cerr << "Failed to open encoded scene: " << reader.GetError() << std::endl;
+		return 1;
+	}
+
+	double yamlTime = Measure(iterations, [&]() {
+		YAML::Node node = YAML::Load(yaml);
+	});
+
+	double tableTime = Measure(iterations, [&]() {
+		BinaryScene::Reader r;
+		r.Open(binary.data(), binary.size());
+	});
+
+	double binaryTime = Measure(iterations, [&]() {
+		BinaryScene::Reader r;
+		r.Open(binary.data(), binary.size());
+		Document props;
+		for (u32 i = 0; i < r.GetNodeCount(); i++) {
+			r.ReadProperties(r.GetNode(i).properties, props);
+		}
+		for (u32 i = 0; i < r.GetResourceCount(); i++) {
+			r.ReadProperties(r.GetResource(i).properties, props);
+		}
+	});
+
+	std::cout << "Scene: " << input << " (" << reader.GetNodeCount() << " nodes, " << reader.GetResourceCount() << " resources)" << std::endl;
+	std::cout << "YAML:   " << yaml.size() << " bytes, " << yamlTime << " ms" << std::endl;
+	std::cout << "Binary: " << binary.size() << " bytes, " << tableTime << " ms tables, " << binaryTime << " ms with properties" << std::endl;
+	return 0;
+}
+
+// Times the scene spatial index with nodes spread over a large world. A frame either moves every node a little, the
+// worst case, or leaves them where they are, then queries a screen sized rect around each of a few cameras
+static int BenchIndex(int nodes, int frames) {
+	std::mt19937 rng(1234);
+	std::uniform_real_distribution<float> world(-50000.f, 50000.f);
+	std::uniform_real_distribution<float> extent(16.f, 256.f);
+	std::uniform_real_distribution<float> step(-4.f, 4.f);
+
+	std::vector<Rect> bounds(nodes);
+	for (Rect &rect : bounds)
+		rect = Rect(world(rng), world(rng), extent(rng), extent(rng));
+
+	SpatialIndex index;
+	double insertTime = Measure(1, [&]() {
+		for (int i = 0; i < nodes; i++)
+			index.Update(static_cast<NodeID>(i + 1), bounds[i]);
+	});
+
+	double staticTime = Measure(frames, [&]() {
+		for (int i = 0; i < nodes; i++)
+			index.Update(static_cast<NodeID>(i + 1), bounds[i]);
+	});
+
+	double moveTime = Measure(frames, [&]() {
+		for (int i = 0; i < nodes; i++) {
+			bounds[i].x += step(rng);
+			bounds[i].y += step(rng);
+			index.Update(static_cast<NodeID>(i + 1), bounds[i]);
+		}
+	});
+
+	std::vector<Vector2> cameras(16);
+	for (Vector2 &camera : cameras)
+		camera = Vector2(world(rng), world(rng));
+
+	std::vector<NodeID> result;
+	size_t found = 0;
+	double queryTime = Measure(frames, [&]() {
+		for (const Vector2 &camera : cameras) {
+			result.clear();
+			index.QueryRect(Rect(camera.x - 960.f, camera.y - 540.f, 1920.f, 1080.f), result);
+			found += result.size();
+		}
+	});
+
+	std::cout << "Spatial index: " << index.Size() << " nodes, " << frames << " frames" << std::endl;
+	std::cout << "Insert: " << insertTime << " ms" << std::endl;
+	std::cout << "Frame:  " << staticTime << " ms unchanged, " << moveTime << " ms all moving" << std::endl;
+	std::cout << "Query:  " << queryTime / cameras.size() << " ms per 1920x1080 rect, " << found / (static_cast<size_t>(frames) * cameras.size()) << " nodes on average" << std::endl;
+	return 0;
+}
+
+int main(int argc, char **argv) {
+	if (argc >= 2 && std::strcmp(argv[1], "--bench-index") == 0) {
+		int nodes = argc >= 3 ? std::atoi(argv[2]) : 100000;
+		int frames = argc >= 4 ? std::atoi(argv[3]) : 100;
+		return BenchIndex(nodes > 0 ? nodes : 1, frames > 0 ? frames : 1);
+	}
+
+	if (argc >= 3 && std::strcmp(argv[1], "--bench") == 0) {
+		int iterations = argc >= 4 ? std::atoi(argv[3]) : 100;
+		return Bench(argv[2], iterations > 0 ? iterations : 1);
+	}
+
+	if (argc == 3)
+		return Convert(argv[1], argv[2]);
+
+	std::cerr << "Usage: " << argv[0] << " <input> <output>" << std::endl;
+	std::cerr << "       " << argv[0] << " --bench <scene> [iterations]" << std::endl;
+	std::cerr << "       " << argv[0] << " --bench-index [nodes] [frames]" << std::endl;
+	return 1;
+}
\ No newline at end of file